@@ -61,7 +61,7 @@ bool Application::OnInit()
     });
 
     //tentatively set program language to OS default until GlobalSettings.xml is read later
-    try { fff::localizationInit(appendPath(fff::getResourceDirPath(), Zstr("Languages.zip"))); } //throw FileError
+    try { fff::localizationInit(appendPath(fff::getResourceDirPath(), Zstr("Languages.zip")), appendPath(fff::getConfigDirPath(), Zstr("Languages.dat"))); } //throw FileError
     catch (const FileError& e) { logExtraError(e.toString()); }
 
     GlobalConfig globalCfg;
@@ -13,7 +13,13 @@
 //#include "../library/lock_holder.h" //LOCK_FILE_ENDING
 //TEMP_FILE_ENDING
 
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/timerfd.h>
+    #include <unistd.h> //close, read, write
+
 using namespace zen;
+using namespace rts;
 
 
 namespace
@@ -21,9 +27,85 @@ namespace
 constexpr std::chrono::seconds FOLDER_EXISTENCE_CHECK_INTERVAL(1);
 
 
+using WatchList = std::vector<std::pair<Zstring, std::unique_ptr<DirWatcher>>>;
+
+//block on change notifications, timer and wakeup event at the same time: no polling => idle CPU is zero
+class EventWaiter
+{
+public:
+    EventWaiter(WakeupEvent& wakeup, const std::function<void()>& onWakeup /*throw X*/) : //throw SysError
+        timerDescr_(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)), //std::chrono::steady_clock uses CLOCK_MONOTONIC
+        wakeup_(wakeup),
+        onWakeup_(onWakeup)
+    {
+        if (timerDescr_ == -1)
+            THROW_LAST_SYS_ERROR("timerfd_create");
+    }
+
+    ~EventWaiter() { ::close(timerDescr_); }
+
+    //return if 1. changes are pending 2. "deadline" is reached or 3. wakeup was notified (=> spurious wakeups possible)
+    void wait(const WatchList& watches, std::chrono::steady_clock::time_point deadline) //throw SysError, X
+    {
+        itimerspec timerVal = {}; //all zero: disarm timer
+        if (deadline != std::chrono::steady_clock::time_point::max())
+        {
+            const auto nanoSec = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            timerVal.it_value.tv_sec  = nanoSec / 1000'000'000;
+            timerVal.it_value.tv_nsec = nanoSec % 1000'000'000;
+
+            if (timerVal.it_value.tv_sec == 0 && timerVal.it_value.tv_nsec == 0)
+                timerVal.it_value.tv_nsec = 1; //don't disarm
+        }
+        //re-arming also resets the "readable" state of the previous expiration
+        if (::timerfd_settime(timerDescr_, TFD_TIMER_ABSTIME, &timerVal, nullptr) != 0)
+            THROW_LAST_SYS_ERROR("timerfd_settime");
+
+        std::vector<pollfd> fds{{timerDescr_, POLLIN}, {wakeup_.getDescriptor(), POLLIN}};
+        for (const auto& [folderPath, watcher] : watches)
+            fds.push_back({watcher->getNotifyDescriptor(), POLLIN});
+
+        while (::poll(fds.data(), fds.size(), -1 /*timeout*/) < 0)
+            if (errno != EINTR)
+                THROW_LAST_SYS_ERROR("poll");
+
+        if (fds[1].revents != 0)
+        {
+            wakeup_.reset();
+            onWakeup_(); //throw X
+        }
+    }
+
+    void waitUntil(std::chrono::steady_clock::time_point deadline) //throw SysError, X
+    {
+        while (std::chrono::steady_clock::now() < deadline)
+            wait({}, deadline); //throw SysError, X
+    }
+
+private:
+    EventWaiter           (const EventWaiter&) = delete;
+    EventWaiter& operator=(const EventWaiter&) = delete;
+
+    const int timerDescr_;
+    WakeupEvent& wakeup_;
+    const std::function<void()> onWakeup_;
+};
+
+
+//folder checks may block (e.g. non-existent network path): stay responsive to wakeup meanwhile
+bool waitForFolderCheck(std::future<bool>& folderAvailable, EventWaiter& waiter, std::chrono::milliseconds cbInterval) //throw SysError, X
+{
+    while (folderAvailable.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
+        waiter.wait({}, std::chrono::steady_clock::now() + cbInterval); //throw SysError, X
+
+    return folderAvailable.get();
+}
+
+
 //wait until all directories become available (again) + logs in network share
-std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>& folderPathPhrases, //throw FileError
-                                                     const std::function<void(const Zstring& folderPath)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>& folderPathPhrases, //throw FileError, SysError, X
+                                                     const std::function<void(const Zstring* missingFolderPath)>& reportStatus,
+                                                     EventWaiter& waiter, std::chrono::milliseconds cbInterval)
 {
     //early failure! check for unsupported folder paths:
     for (const char* protoName : {"ftp", "sftp", "mtp", "gdrive"})
@@ -63,12 +145,7 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
         std::set<Zstring, LessNativePath> missingPathPhrases;
         for (auto& [folderPath, folderInfo] : folderInfos)
         {
-            std::future<bool>& folderAvailable = folderInfo.folderAvailable;
-
-            while (folderAvailable.wait_for(cbInterval) == std::future_status::timeout)
-                requestUiUpdate(folderPath); //throw X
-
-            if (folderAvailable.get())
+            if (waitForFolderCheck(folderInfo.folderAvailable, waiter, cbInterval)) //throw SysError, X
                 availablePaths.insert(folderPath);
             else
                 missingPathPhrases.insert(folderInfo.folderPathPhrase);
@@ -84,13 +161,10 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
             {
                 //support specifying volume by name => call getResolvedFilePath() repeatedly
                 const Zstring folderPath = getResolvedFilePath(folderPathPhrase);
+                reportStatus(&folderPath);
 
                 //wait some time...
-                for (auto now = std::chrono::steady_clock::now(); now < delayUntil; now = std::chrono::steady_clock::now())
-                {
-                    requestUiUpdate(folderPath); //throw X
-                    std::this_thread::sleep_for(cbInterval);
-                }
+                waiter.waitUntil(delayUntil); //throw SysError, X
 
                 std::future<bool> folderAvailable = runAsync([folderPath]
                 {
@@ -102,10 +176,7 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
                     catch (FileError&) { return false; }
                 });
 
-                while (folderAvailable.wait_for(cbInterval) == std::future_status::timeout)
-                    requestUiUpdate(folderPath); //throw X
-
-                if (folderAvailable.get())
+                if (waitForFolderCheck(folderAvailable, waiter, cbInterval)) //throw SysError, X
                     break;
                 //else: wait until folder is available: do not needlessly poll existing folders again!
                 delayUntil = std::chrono::steady_clock::now() + FOLDER_EXISTENCE_CHECK_INTERVAL;
@@ -114,89 +185,155 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
 }
 
 
-//wait until changes are detected or if a directory is not available (anymore)
-DirWatcher::Change waitForChanges(const std::set<Zstring, LessNativePath>& folderPaths, //throw FileError
-                                  const std::function<void(bool readyForSync)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+//returns change of type "baseFolderUnavailable" if a directory is not available (anymore)
+std::optional<DirWatcher::Change> createWatches(const std::set<Zstring, LessNativePath>& folderPaths, WatchList& watches) //throw FileError
 {
-    if (folderPaths.empty()) //pathological case, but we have to check or this function waits forever
+    if (folderPaths.empty()) //pathological case, but we have to check or waitForChanges() waits forever
         throw FileError(_("A folder input field is empty.")); //should have been checked by caller!
 
-    std::vector<std::pair<Zstring, std::unique_ptr<DirWatcher>>> watches;
+    WatchList watchesNew;
 
     for (const Zstring& folderPath : folderPaths)
         try
         {
-            watches.emplace_back(folderPath, std::make_unique<DirWatcher>(folderPath)); //throw FileError
+            watchesNew.emplace_back(folderPath, std::make_unique<DirWatcher>(folderPath)); //throw FileError
         }
         catch (FileError&)
         {
             try { getItemType(folderPath); } //throw FileError
-            catch (FileError&)
-            {
-                assert(false); //why "unavailable"!? violating waitForChanges() precondition!
-                return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-            }
+            catch (FileError&) { return DirWatcher::Change{DirWatcher::ChangeType::baseFolderUnavailable, folderPath}; }
 
             throw;
         }
 
-    auto lastCheckTime = std::chrono::steady_clock::now();
-    for (;;)
+    watches = std::move(watchesNew);
+    return std::nullopt;
+}
+
+
+//extract changes accumulated since last call: non-blocking
+std::vector<DirWatcher::Change> fetchChanges(const WatchList& watches, bool checkDirExistence, std::chrono::milliseconds cbInterval) //throw FileError
+{
+    std::vector<DirWatcher::Change> output;
+
+    for (const auto& [folderPath, watcher] : watches)
     {
-        const bool checkDirNow = [&] //checking once per sec should suffice
-        {
-            const auto now = std::chrono::steady_clock::now();
-            if (now > lastCheckTime + FOLDER_EXISTENCE_CHECK_INTERVAL)
+        //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
+        if (checkDirExistence)
+            try //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
             {
-                lastCheckTime = now;
-                return true;
+                getItemType(folderPath); //throw FileError
             }
-            return false;
-        }();
+            catch (FileError&) { return {{DirWatcher::ChangeType::baseFolderUnavailable, folderPath}}; }
 
-        for (const auto& [folderPath, watcher] : watches)
+        try
         {
-            //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
-            if (checkDirNow)
-                try //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
-                {
-                    getItemType(folderPath); //throw FileError
-                }
-                catch (FileError&) { return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath}; }
+            std::vector<DirWatcher::Change> changes = watcher->fetchChanges(nullptr /*requestUiUpdate*/, cbInterval); //throw FileError
 
-            try
+            //give precedence to ChangeType::baseFolderUnavailable
+            for (const DirWatcher::Change& change : changes)
+                if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
+                    return {change};
+
+            std::erase_if(changes, [](const DirWatcher::Change& e)
             {
-                std::vector<DirWatcher::Change> changes = watcher->fetchChanges([&] { requestUiUpdate(false /*readyForSync*/); /*throw X*/ },
-                                                                                cbInterval); //throw FileError
+                return
+                    endsWith(e.itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
+                    endsWith(e.itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
+                    endsWith(e.itemPath, Zstr(".ffs_db"));     //sync.ffs_db
+                //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
+            });
+
+            append(output, changes);
+        }
+        catch (FileError&)
+        {
+            try { getItemType(folderPath); } //throw FileError
+            catch (FileError&) { return {{DirWatcher::ChangeType::baseFolderUnavailable, folderPath}}; }
 
-                //give precedence to ChangeType::baseFolderUnavailable
-                for (const DirWatcher::Change& change : changes)
-                    if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
-                        return change;
+            throw;
+        }
+    }
+    return output;
+}
 
-                std::erase_if(changes, [](const DirWatcher::Change& e)
-                {
-                    return
-                        endsWith(e.itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
-                        endsWith(e.itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
-                        endsWith(e.itemPath, Zstr(".ffs_db"));     //sync.ffs_db
-                    //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
-                });
 
-                if (!changes.empty())
-                    return changes[0];
-            }
-            catch (FileError&)
-            {
-                try { getItemType(folderPath); } //throw FileError
-                catch (FileError&) { return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath}; }
+struct ExecCommandNowException {};
 
-                throw;
-            }
+
+/* changed items as a trie of path components: a changed folder covers its whole subtree
+   => prefix-deduplicated: constant memory for bursts of changes, e.g. untar of 100.000 files into a new folder  */
+class ChangeAccumulator
+{
+public:
+    void insert(const Zstring& itemPath)
+    {
+        Node* node = &root_;
+        for (const ZstringView itemName : splitCpy(ZstringView(itemPath), FILE_NAME_SEPARATOR, SplitOnEmpty::skip))
+        {
+            if (node->changed) //already covered by parent folder
+                return;
+            node = &node->children[Zstring(itemName)];
         }
+        node->changed = true;
+        node->children.clear(); //subsumed
+    }
 
-        std::this_thread::sleep_for(cbInterval);
-        requestUiUpdate(true /*readyForSync*/); //throw X: may start sync at this presumably idle time
+    void insert(const std::set<Zstring, LessNativePath>& itemPaths)
+    {
+        for (const Zstring& itemPath : itemPaths)
+            insert(itemPath);
+    }
+
+    std::set<Zstring, LessNativePath> getItems() const
+    {
+        std::set<Zstring, LessNativePath> output;
+        getItems(root_, Zstring(), output);
+        return output;
+    }
+
+    void clear() { root_ = {}; }
+
+private:
+    struct Node
+    {
+        bool changed = false;
+        std::map<Zstring, Node> children;
+    };
+
+    static void getItems(const Node& node, const Zstring& nodePath, std::set<Zstring, LessNativePath>& output)
+    {
+        if (node.changed)
+            output.insert(nodePath.empty() ? Zstring() + FILE_NAME_SEPARATOR : nodePath);
+        else
+            for (const auto& [itemName, child] : node.children)
+                getItems(child, nodePath + FILE_NAME_SEPARATOR + itemName, output);
+    }
+
+    Node root_;
+};
+
+//wait until changes are detected or if a directory is not available (anymore)
+std::vector<DirWatcher::Change> waitForChanges(const WatchList& watches, EventWaiter& waiter, //throw FileError, SysError, ExecCommandNowException, X
+                                               std::chrono::steady_clock::time_point execTime, std::chrono::milliseconds cbInterval)
+{
+    auto nextCheckTime = std::chrono::steady_clock::now() + FOLDER_EXISTENCE_CHECK_INTERVAL;
+    for (;;)
+    {
+        waiter.wait(watches, std::min(execTime, nextCheckTime)); //throw SysError, X
+
+        const auto now = std::chrono::steady_clock::now();
+
+        const bool checkDirNow = now >= nextCheckTime; //checking once per sec should suffice
+        if (checkDirNow)
+            nextCheckTime = now + FOLDER_EXISTENCE_CHECK_INTERVAL;
+
+        std::vector<DirWatcher::Change> changes = fetchChanges(watches, checkDirNow, cbInterval); //throw FileError
+        if (!changes.empty())
+            return changes;
+
+        if (now >= execTime)
+            throw ExecCommandNowException(); //no changes since "delay" => start sync
     }
 }
 
@@ -217,25 +354,111 @@ std::wstring getChangeTypeName(DirWatcher::ChangeType type)
     assert(false);
     return L"Error";
 }
+}
 
-struct ExecCommandNowException {};
+
+rts::WakeupEvent::WakeupEvent() : //throw SysError
+    eventDescr_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (eventDescr_ == -1)
+        THROW_LAST_SYS_ERROR("eventfd");
+}
+
+
+rts::WakeupEvent::~WakeupEvent() { ::close(eventDescr_); }
+
+
+void rts::WakeupEvent::notify() //noexcept
+{
+    const uint64_t val = 1;
+    [[maybe_unused]] const ssize_t bytesWritten = ::write(eventDescr_, &val, sizeof(val)); //EAGAIN: counter overflow => still readable
+}
+
+
+void rts::WakeupEvent::reset() //noexcept
+{
+    uint64_t val = 0;
+    [[maybe_unused]] const ssize_t bytesRead = ::read(eventDescr_, &val, sizeof(val)); //EAGAIN: not notified
+}
+
+
+bool rts::WakeupEvent::waitFor(std::chrono::milliseconds timeout) //noexcept
+{
+    pollfd fds[] = {{eventDescr_, POLLIN}};
+
+    int rv = 0;
+    do
+    {
+        rv = ::poll(fds, std::size(fds), static_cast<int>(timeout.count())); //int timeout
+    }
+    while (rv < 0 && errno == EINTR); //no need to adapt "timeout": a bit of extra waiting is fine
+
+    if (rv <= 0) //time-out or error
+        return false;
+
+    reset();
+    return true;
 }
 
 
 void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std::chrono::seconds delay,
-                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName)>& executeExternalCommand /*throw FileError*/,
-                             const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate,
+                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName, const fff::ChangeJournal& changes)>& executeExternalCommand /*throw FileError*/,
+                             const std::function<void(const Zstring* missingFolderPath)>& reportStatus,
                              const std::function<void(const std::wstring& msg         )>& reportError,
+                             WakeupEvent& wakeup,
+                             const std::function<void()>& onWakeup,
                              std::chrono::milliseconds cbInterval)
 {
     assert(!folderPathPhrases.empty());
     if (folderPathPhrases.empty())
         return;
 
+    //changes not yet processed by a successful run of the external command: passed on for incremental comparison
+    ChangeAccumulator changedItems;
+    auto changesSince = std::chrono::system_clock::now(); //earlier changes are unknown: startWatching() reports base folders as changed
+
     for (;;)
         try
         {
-            std::set<Zstring, LessNativePath> folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
+            EventWaiter waiter(wakeup, onWakeup); //throw SysError
+
+            std::set<Zstring, LessNativePath> folderPaths;
+            WatchList watches;
+
+            auto startWatching = [&] //throw FileError, SysError, X
+            {
+                for (;;)
+                {
+                    watches.clear();
+                    folderPaths = waitForMissingDirs(folderPathPhrases, reportStatus, waiter, cbInterval); //throw FileError, SysError, X
+
+                    //changes before watching started are unknown:
+                    changedItems.insert(folderPaths);
+
+                    if (!createWatches(folderPaths, watches)) //throw FileError
+                        return reportStatus(nullptr);
+                }
+            };
+
+            //new subfolders are watched incrementally by DirWatcher: no need to recreate watches
+            auto processChanges = [&](const std::vector<DirWatcher::Change>& changes) //throw FileError, SysError, X
+            {
+                for (const DirWatcher::Change& change : changes)
+                    switch (change.type)
+                    {
+                        case DirWatcher::ChangeType::baseFolderUnavailable:
+                            //don't execute the command before all directories are available!
+                            return startWatching(); //throw FileError, SysError, X
+
+                        case DirWatcher::ChangeType::create:
+                        case DirWatcher::ChangeType::update:
+                        case DirWatcher::ChangeType::remove:
+                            changedItems.insert(change.itemPath);
+                            break;
+                    }
+            };
+
+            startWatching(); //throw FileError, SysError, X
 
             //schedule initial execution (*after* all directories have arrived)
             auto nextExecTime = std::chrono::steady_clock::now() + delay;
@@ -247,28 +470,32 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
                 {
                     for (;;) //detected changes
                     {
-                        lastChangeDetected = waitForChanges(folderPaths, [&](bool readyForSync) //throw FileError, ExecCommandNowException
-                        {
-                            requestUiUpdate(nullptr);
+                        std::vector<DirWatcher::Change> changes = waitForChanges(watches, waiter, nextExecTime, cbInterval); //throw FileError, SysError, ExecCommandNowException, X
 
-                            if (readyForSync && std::chrono::steady_clock::now() >= nextExecTime)
-                                throw ExecCommandNowException(); //abort wait and start sync
-                        }, cbInterval);
-
-                        if (lastChangeDetected.type == DirWatcher::ChangeType::baseFolderUnavailable)
-                            //don't execute the command before all directories are available!
-                            folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
+                        lastChangeDetected = changes.back();
+                        processChanges(changes); //throw FileError, SysError, X
 
                         nextExecTime = std::chrono::steady_clock::now() + delay;
                     }
                 }
                 catch (ExecCommandNowException&) {}
 
+                const std::set<Zstring, LessNativePath> changedItemsExec = changedItems.getItems();
+                const auto execStartTime = std::chrono::system_clock::now();
+                changedItems.clear();
                 try
                 {
-                    executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type)); //throw FileError
+                    executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type), {folderPaths, changedItemsExec, changesSince}); //throw FileError
+                    changesSince = execStartTime;
+                }
+                catch (const FileError& e)
+                {
+                    changedItems.insert(changedItemsExec); //not yet synchronized => retry next time
+                    reportError(e.toString());
                 }
-                catch (const FileError& e) { reportError(e.toString()); }
+
+                //record changes during command execution (e.g. caused by the synchronization itself), but don't schedule another run
+                processChanges(fetchChanges(watches, true /*checkDirExistence*/, cbInterval)); //throw FileError, SysError, X
 
                 nextExecTime = std::chrono::steady_clock::time_point::max();
             }
@@ -277,4 +504,8 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
         {
             reportError(e.toString());
         }
+        catch (const SysError& e) //timerfd, poll
+        {
+            reportError(e.toString());
+        }
 }
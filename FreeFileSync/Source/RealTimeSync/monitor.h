@@ -10,16 +10,43 @@
 #include <chrono>
 #include <functional>
 #include <zen/zstring.h>
+#include "../base/change_journal.h"
 
 
 namespace rts
 {
+//wake up monitorDirectories() blocking on a worker thread: thread-safe
+class WakeupEvent
+{
+public:
+    WakeupEvent(); //throw SysError
+    ~WakeupEvent();
+
+    void notify(); //noexcept
+
+    //block until notify() or time out: return false on time-out
+    bool waitFor(std::chrono::milliseconds timeout); //noexcept
+
+    int getDescriptor() const { return eventDescr_; } //readable after notify()
+    void reset(); //noexcept
+
+private:
+    WakeupEvent           (const WakeupEvent&) = delete;
+    WakeupEvent& operator=(const WakeupEvent&) = delete;
+
+    const int eventDescr_;
+};
+
+
+//blocks until changes, timers or the wakeup event are due => no CPU usage while idle
 void monitorDirectories(const std::vector<Zstring>& folderPathPhrases,
                         //non-formatted paths that yet require call to getFormattedDirectoryName(); empty directories must be checked by caller!
                         std::chrono::seconds delay,
-                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName)>& executeExternalCommand,
-                        const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate, //either waiting for change notifications or at least one folder is missing
+                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName, const fff::ChangeJournal& changes)>& executeExternalCommand,
+                        const std::function<void(const Zstring* missingFolderPath)>& reportStatus, //either waiting for change notifications or at least one folder is missing
                         const std::function<void(const std::wstring& msg         )>& reportError, //automatically retries after return!
+                        WakeupEvent& wakeup,
+                        const std::function<void()>& onWakeup, //called after wakeup.notify(): throw X to stop monitoring
                         std::chrono::milliseconds cbInterval);
 }
 
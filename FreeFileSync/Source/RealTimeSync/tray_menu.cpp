@@ -6,19 +6,25 @@
 
 #include "tray_menu.h"
 #include <chrono>
+#include <atomic>
 #include <zen/resolve_path.h>
 #include <wx/taskbar.h>
 #include <wx/icon.h> //Linux needs this
 #include <wx/app.h>
 #include <wx/menu.h>
 #include <wx/timer.h>
+#include <wx/evtloop.h>
 #include <wx+/dc.h>
 #include <wx+/image_tools.h>
 #include <zen/process_exec.h>
+#include <zen/file_access.h>
+#include <zen/thread.h>
 #include <wx+/popup_dlg.h>
 #include <wx+/image_resources.h>
 #include "monitor.h"
 
+    #include <unistd.h> //getpid
+
 using namespace zen;
 using namespace rts;
 
@@ -29,22 +35,6 @@ constexpr std::chrono::seconds RETRY_AFTER_ERROR_INTERVAL(15);
 constexpr std::chrono::milliseconds UI_UPDATE_INTERVAL(100); //perform ui updates not more often than necessary, 100 seems to be a good value with only a minimal performance loss
 
 
-std::chrono::steady_clock::time_point lastExec;
-
-
-bool uiUpdateDue()
-{
-    const auto now = std::chrono::steady_clock::now();
-
-    if (now > lastExec + UI_UPDATE_INTERVAL)
-    {
-        lastExec = now;
-        return true;
-    }
-    return false;
-}
-
-
 enum TrayMode
 {
     active,
@@ -53,10 +43,19 @@ enum TrayMode
 };
 
 
+enum class TrayRequest
+{
+    resume,
+    exit,
+    showError,
+};
+
+
 class TrayIcon : public wxTaskBarIcon
 {
 public:
-    explicit TrayIcon(const wxString& jobname) :
+    TrayIcon(const wxString& jobname, const std::function<void(TrayRequest request)>& onRequest) :
+        onRequest_(onRequest),
         jobName_(jobname)
     {
         Bind(wxEVT_TASKBAR_LEFT_UP, [this](wxTaskBarIconEvent& event) { onMouseClick(event); });
@@ -67,14 +66,6 @@ public:
         timer_.Bind(wxEVT_TIMER, [this](wxTimerEvent& event) { onErrorFlashIcon(event); });
     }
 
-    //require polling:
-    bool resumeIsRequested() const { return resumeRequested_; }
-    bool abortIsRequested () const { return exitRequested_; }
-
-    //during TrayMode::error those two functions are available:
-    void clearShowErrorRequested()     { assert(mode_ == TrayMode::error); showErrorMsgRequested_ = false; }
-    bool getShowErrorRequested() const { assert(mode_ == TrayMode::error); return showErrorMsgRequested_; }
-
     void setMode(TrayMode m, const Zstring& missingFolderPath)
     {
         if (mode_ == m && missingFolderPath_ == missingFolderPath)
@@ -129,12 +120,12 @@ private:
             case TrayMode::active:
             case TrayMode::waiting:
                 defaultItem = new wxMenuItem(contextMenu, wxID_ANY, _("&Configure")); //better than "Restore"? https://freefilesync.org/forum/viewtopic.php?t=2044&p=20391#p20391
-                contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { resumeRequested_ = true; }, defaultItem->GetId());
+                contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { onRequest_(TrayRequest::resume); }, defaultItem->GetId());
                 break;
 
             case TrayMode::error:
                 defaultItem = new wxMenuItem(contextMenu, wxID_ANY, _("&Show error message"));
-                contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { showErrorMsgRequested_ = true; }, defaultItem->GetId());
+                contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { onRequest_(TrayRequest::showError); }, defaultItem->GetId());
                 break;
         }
         contextMenu->Append(defaultItem);
@@ -142,7 +133,7 @@ private:
         contextMenu->AppendSeparator();
 
         wxMenuItem* itemAbort = contextMenu->Append(wxID_ANY, _("&Quit"));
-        contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { exitRequested_ = true; }, itemAbort->GetId());
+        contextMenu->Bind(wxEVT_COMMAND_MENU_SELECTED, [this](wxCommandEvent& event) { onRequest_(TrayRequest::exit); }, itemAbort->GetId());
 
         return contextMenu; //ownership transferred to caller
     }
@@ -153,17 +144,15 @@ private:
         {
             case TrayMode::active:
             case TrayMode::waiting:
-                resumeRequested_ = true; //never throw exceptions through a C-Layer call stack (GUI)!
+                onRequest_(TrayRequest::resume); //never throw exceptions through a C-Layer call stack (GUI)!
                 break;
             case TrayMode::error:
-                showErrorMsgRequested_ = true;
+                onRequest_(TrayRequest::showError);
                 break;
         }
     }
 
-    bool resumeRequested_       = false;
-    bool exitRequested_         = false;
-    bool showErrorMsgRequested_ = false;
+    const std::function<void(TrayRequest request)> onRequest_; //called on UI thread
 
     TrayMode mode_ = TrayMode::waiting;
     Zstring missingFolderPath_;
@@ -177,19 +166,15 @@ private:
 };
 
 
-struct AbortMonitoring //exception class
-{
-    AbortMonitoring(CancelReason reasonCode) : reasonCode_(reasonCode) {}
-    CancelReason reasonCode_;
-};
+struct AbortMonitoring {}; //exception class
 
 
 //=> don't derive from wxEvtHandler or any other wxWidgets object unless instance is safely deleted (deferred) during idle event!!tray_icon.h
 class TrayIconHolder
 {
 public:
-    explicit TrayIconHolder(const wxString& jobname) :
-        trayIcon_(new TrayIcon(jobname)) {}
+    TrayIconHolder(const wxString& jobname, const std::function<void(TrayRequest request)>& onRequest) :
+        trayIcon_(new TrayIcon(jobname, onRequest)) {}
 
     ~TrayIconHolder()
     {
@@ -199,23 +184,8 @@ public:
         trayIcon_->Destroy(); //uses wxPendingDelete
     }
 
-    void doUiRefreshNow() //throw AbortMonitoring
-    {
-        wxTheApp->Yield(); //yield is UI-layer which is represented by this tray icon
-
-        //advantage of polling vs callbacks: we can throw exceptions!
-        if (trayIcon_->resumeIsRequested())
-            throw AbortMonitoring(CancelReason::requestGui);
-
-        if (trayIcon_->abortIsRequested())
-            throw AbortMonitoring(CancelReason::requestExit);
-    }
-
     void setMode(TrayMode m, const Zstring& missingFolderPath) { trayIcon_->setMode(m, missingFolderPath); }
 
-    bool getShowErrorRequested() const { return trayIcon_->getShowErrorRequested(); }
-    void clearShowErrorRequested() { trayIcon_->clearShowErrorRequested(); }
-
 private:
     TrayIcon* const trayIcon_;
 };
@@ -244,71 +214,161 @@ rts::CancelReason rts::runFolderMonitor(const FfsRealConfig& config, const wxStr
     }
 
 
-    TrayIconHolder trayIcon(jobname);
+    std::optional<WakeupEvent> wakeup;
+    try
+    {
+        wakeup.emplace(); //throw SysError
+    }
+    catch (const SysError& e)
+    {
+        showNotificationDialog(nullptr, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(e.toString()));
+        return CancelReason::requestGui;
+    }
+
+    /* monitoring runs on a worker thread blocking on change notifications, the UI thread sleeps in its event loop => no polling while idle
+         UI thread => worker: stopRequested + wakeup
+         worker => UI thread: wxTheApp->CallAfter()                                                                  */
+    wxGUIEventLoop eventLoop;
+    std::optional<CancelReason> cancelReason; //accessed by UI thread only
+    std::atomic<bool> stopRequested = false;
+    std::optional<std::wstring> errorMsg; //accessed by UI thread only: set during TrayMode::error
+
+    auto stopMonitoring = [&](CancelReason reason) //UI thread
+    {
+        if (cancelReason)
+            return;
+        cancelReason = reason;
+        stopRequested = true;
+        wakeup->notify();
+        eventLoop.Exit();
+    };
+
+    TrayIconHolder trayIcon(jobname, [&](TrayRequest request) //UI thread
+    {
+        switch (request)
+        {
+            case TrayRequest::resume:
+                return stopMonitoring(CancelReason::requestGui);
+
+            case TrayRequest::exit:
+                return stopMonitoring(CancelReason::requestExit);
+
+            case TrayRequest::showError:
+                if (errorMsg)
+                {
+                    const std::wstring msg = *std::exchange(errorMsg, std::nullopt); //don't show twice
+                    switch (showConfirmationDialog(nullptr, DialogInfoType::error, PopupDialogCfg().
+                                                   setDetailInstructions(msg), _("&Retry")))
+                    {
+                        case ConfirmationButton::accept: //retry
+                            trayIcon.setMode(TrayMode::active, Zstring());
+                            wakeup->notify();
+                            break;
+
+                        case ConfirmationButton::cancel:
+                            stopMonitoring(CancelReason::requestGui);
+                            break;
+                    }
+                }
+                break;
+        }
+    });
 
-    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName) //throw FileError
+    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName, const fff::ChangeJournal& changes) //throw FileError
     {
-        ::wxSetEnv(L"change_path", utfTo<wxString>(changedItemPath)); //crude way to report changed file
-        ::wxSetEnv(L"change_action", actionName);                     //
-        auto cmdLineExp = expandMacros(cmdLine);
+        //report all changes since last successful run: allow FreeFileSync to compare changed folders only
+        const Zstring journalFilePath = appendPath(getTempFolderPath(), //throw FileError
+                                                   Zstr("RealTimeSync_") + numberTo<Zstring>(::getpid()) + Zstr(".ffs_journal"));
+        fff::saveChangeJournal(changes, journalFilePath); //throw FileError
+        ZEN_ON_SCOPE_EXIT(try { removeFilePlain(journalFilePath); /*throw FileError*/ }
+                          catch (const FileError& e) { logExtraError(e.toString()); });
+
+        //worker thread: don't ::setenv() while the main thread may call ::getenv() => set for the child process only
+        const std::vector<std::pair<Zstring, Zstring>> envVars
+        {
+            {Zstr("change_path"), changedItemPath}, //crude way to report changed file
+            {Zstr("change_action"), utfTo<Zstring>(actionName)}, //
+            {Zstring(fff::CHANGE_JOURNAL_ENV_VAR), journalFilePath},
+        };
+
+        Zstring cmdLineExp = expandMacros(cmdLine); //unresolved macros are kept as is
+        for (const auto& [name, value] : envVars)
+            replace(cmdLineExp, Zstr('%') + name + Zstr('%'), value);
 
         try
         {
-            if (const auto& [exitCode, output] = consoleExecute(cmdLineExp, std::nullopt /*timeoutMs*/); //throw SysError, (SysErrorTimeOut)
+            if (const auto& [exitCode, output] = consoleExecute(cmdLineExp, std::nullopt /*timeoutMs*/, envVars); //throw SysError, (SysErrorTimeOut)
                 exitCode != 0)
                 throw SysError(formatSystemError("", replaceCpy(_("Exit code %x"), L"%x", numberTo<std::wstring>(exitCode)), utfTo<std::wstring>(output)));
         }
         catch (const SysError& e) { throw FileError(replaceCpy(_("Command %x failed."), L"%x", fmtPath(cmdLineExp)), e.toString()); }
     };
 
-    auto requestUiUpdate = [&](const Zstring* missingFolderPath)
+    auto reportStatus = [&](const Zstring* missingFolderPath) //worker thread
     {
-        if (missingFolderPath)
-            trayIcon.setMode(TrayMode::waiting, *missingFolderPath);
-        else
-            trayIcon.setMode(TrayMode::active, Zstring());
-
-        if (uiUpdateDue())
-            trayIcon.doUiRefreshNow(); //throw AbortMonitoring
+        wxTheApp->CallAfter([&, missingFolderPath = missingFolderPath ? *missingFolderPath : Zstring()]
+        {
+            if (!missingFolderPath.empty())
+                trayIcon.setMode(TrayMode::waiting, missingFolderPath);
+            else
+                trayIcon.setMode(TrayMode::active, Zstring());
+        });
     };
 
-    auto reportError = [&](const std::wstring& msg)
+    auto checkStop = [&] //worker thread
     {
-        trayIcon.setMode(TrayMode::error, Zstring());
-        trayIcon.clearShowErrorRequested();
+        if (stopRequested)
+            throw AbortMonitoring();
+    };
 
-        //wait for some time, then return to retry
-        const auto delayUntil = std::chrono::steady_clock::now() + RETRY_AFTER_ERROR_INTERVAL;
-        for (auto now = std::chrono::steady_clock::now(); now < delayUntil; now = std::chrono::steady_clock::now())
+    auto reportError = [&](const std::wstring& msg) //worker thread
+    {
+        wxTheApp->CallAfter([&, msg]
         {
-            trayIcon.doUiRefreshNow(); //throw AbortMonitoring
+            errorMsg = msg;
+            trayIcon.setMode(TrayMode::error, Zstring());
+        });
 
-            if (trayIcon.getShowErrorRequested())
-                switch (showConfirmationDialog(nullptr, DialogInfoType::error, PopupDialogCfg().
-                                               setDetailInstructions(msg), _("&Retry")))
-                {
-                    case ConfirmationButton::accept: //retry
-                        return;
+        wakeup->reset(); //discard outdated "retry" requests
+        checkStop(); //throw AbortMonitoring
 
-                    case ConfirmationButton::cancel:
-                        throw AbortMonitoring(CancelReason::requestGui);
-                }
-            std::this_thread::sleep_for(UI_UPDATE_INTERVAL);
-        }
+        //wait for some time, then return to retry
+        wakeup->waitFor(RETRY_AFTER_ERROR_INTERVAL); //returns early for "retry" or "stop"
+        checkStop(); //throw AbortMonitoring
+
+        wxTheApp->CallAfter([&] { errorMsg.reset(); });
     };
 
-    try
+    InterruptibleThread worker([&]
     {
-        monitorDirectories(dirNamesNonFmt, std::chrono::seconds(config.delay),
-                           executeExternalCommand /*throw FileError*/,
-                           requestUiUpdate, //throw AbortMonitoring
-                           reportError,     //
-                           UI_UPDATE_INTERVAL / 2);
-        assert(false);
-        return CancelReason::requestGui;
-    }
-    catch (const AbortMonitoring& ab)
-    {
-        return ab.reasonCode_;
-    }
+        setCurrentThreadName(Zstr("Folder Monitor"));
+        try
+        {
+            monitorDirectories(dirNamesNonFmt, std::chrono::seconds(config.delay),
+                               executeExternalCommand /*throw FileError*/,
+                               reportStatus,
+                               reportError, //throw AbortMonitoring
+                               *wakeup,
+                               checkStop,   //
+                               UI_UPDATE_INTERVAL / 2);
+            assert(false);
+        }
+        catch (AbortMonitoring&) {}
+        catch (const std::exception& e) //e.g. std::bad_alloc: don't let the thread call std::terminate()
+        {
+            wxTheApp->CallAfter([&, msg = utfTo<std::wstring>(e.what())]
+            {
+                showNotificationDialog(nullptr, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(msg));
+                stopMonitoring(CancelReason::requestGui);
+            });
+        }
+    });
+
+    eventLoop.Run(); //until stopMonitoring()
+
+    worker.join(); //caveat: waits for a running external command to finish
+    wxTheApp->ProcessPendingEvents(); //CallAfter() lambdas reference local variables
+
+    assert(cancelReason);
+    return cancelReason ? *cancelReason : CancelReason::requestGui;
 }
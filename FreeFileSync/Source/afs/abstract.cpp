@@ -8,7 +8,11 @@
 #include <zen/serialize.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/xxhash.h>
 #include <zen/ring_buffer.h>
+#include <zen/stream_buffer.h>
+#include <zen/thread.h>
+#include <zen/globals.h>
 #include <typeindex>
 
 using namespace zen;
@@ -54,6 +58,180 @@ std::optional<AfsPath> AFS::getParentPath(const AfsPath& itemPath)
     return {};
 }
 
+//==============================================================================================================
+
+namespace
+{
+struct DeviceItemTypes
+{
+    //ordered by AfsPath => child items of a folder are a contiguous range
+    std::map<Zstring, std::optional<AFS::ItemType>> itemTypes; //nullopt: not existing
+    std::map<Zstring, AbstractPath> resolvedLinks;
+};
+using ItemTypeBuffer = std::map<AfsDevice, DeviceItemTypes>;
+
+constinit Global<Protected<ItemTypeBuffer>> globalItemTypeBuffer;
+GLOBAL_RUN_ONCE(globalItemTypeBuffer.set(std::make_unique<Protected<ItemTypeBuffer>>()));
+
+
+template <class Function> inline
+void accessItemTypeBuffer(const AfsDevice& afsDevice, Function fun /*void(DeviceItemTypes& devBuf)*/)
+{
+    if (AFS::hasSlowItemAccess(afsDevice))
+        if (const std::shared_ptr<Protected<ItemTypeBuffer>> itemBuf = globalItemTypeBuffer.get())
+            itemBuf->access([&](ItemTypeBuffer& buf) { fun(buf[afsDevice]); });
+}
+
+
+template <class Map>
+auto getChildItemRange(Map& itemMap, const AfsPath& folderPath) //recursive, excluding folderPath
+{
+    if (folderPath.value.empty()) //device root
+        return std::pair(itemMap.upper_bound(Zstring()), itemMap.end());
+
+    return std::pair(itemMap.lower_bound(folderPath.value + FILE_NAME_SEPARATOR),
+                     itemMap.lower_bound(folderPath.value + static_cast<Zchar>(FILE_NAME_SEPARATOR + 1)));
+}
+
+
+void eraseItemAndChildren(DeviceItemTypes& devBuf, const AfsPath& itemPath)
+{
+    auto eraseImpl = [&](auto& itemMap)
+    {
+        const auto [itFirst, itLast] = getChildItemRange(itemMap, itemPath);
+        itemMap.erase(itFirst, itLast);
+        itemMap.erase(itemPath.value);
+    };
+    eraseImpl(devBuf.itemTypes);
+    eraseImpl(devBuf.resolvedLinks);
+}
+}
+
+
+AFS::ItemType AFS::getItemTypeBuffered(const AbstractPath& itemPath) //throw FileError
+{
+    std::optional<ItemType> type;
+    accessItemTypeBuffer(itemPath.afsDevice, [&](DeviceItemTypes& devBuf)
+    {
+        if (auto it = devBuf.itemTypes.find(itemPath.afsPath.value);
+            it != devBuf.itemTypes.end())
+            type = it->second;
+    });
+    if (type)
+        return *type;
+
+    return getItemType(itemPath); //throw FileError
+}
+
+
+std::optional<AFS::ItemType> AFS::getItemTypeIfExistsBuffered(const AbstractPath& itemPath) //throw FileError
+{
+    std::optional<std::optional<ItemType>> type;
+    accessItemTypeBuffer(itemPath.afsDevice, [&](DeviceItemTypes& devBuf)
+    {
+        if (auto it = devBuf.itemTypes.find(itemPath.afsPath.value);
+            it != devBuf.itemTypes.end())
+            type = it->second;
+    });
+    if (type)
+        return *type;
+
+    return getItemTypeIfExists(itemPath); //throw FileError
+}
+
+
+AbstractPath AFS::getSymlinkResolvedPathBuffered(const AbstractPath& linkPath) //throw FileError
+{
+    std::optional<AbstractPath> resolvedPath;
+    accessItemTypeBuffer(linkPath.afsDevice, [&](DeviceItemTypes& devBuf)
+    {
+        if (auto it = devBuf.resolvedLinks.find(linkPath.afsPath.value);
+            it != devBuf.resolvedLinks.end())
+            resolvedPath = it->second;
+    });
+    if (resolvedPath)
+        return *resolvedPath;
+
+    const AbstractPath resolvedPathNew = getSymlinkResolvedPath(linkPath); //throw FileError
+
+    accessItemTypeBuffer(linkPath.afsDevice, [&](DeviceItemTypes& devBuf)
+    { devBuf.resolvedLinks.insert_or_assign(linkPath.afsPath.value, resolvedPathNew); });
+    return resolvedPathNew;
+}
+
+
+void AFS::bufferItemType(const AbstractPath& itemPath, ItemType type)
+{
+    accessItemTypeBuffer(itemPath.afsDevice, [&](DeviceItemTypes& devBuf) { devBuf.itemTypes.insert_or_assign(itemPath.afsPath.value, type); });
+}
+
+
+void AFS::clearItemTypeBuffer(const AfsDevice& afsDevice)
+{
+    if (const std::shared_ptr<Protected<ItemTypeBuffer>> itemBuf = globalItemTypeBuffer.get())
+        itemBuf->access([&](ItemTypeBuffer& buf) { buf.erase(afsDevice); });
+}
+
+
+void AFS::clearItemTypeBuffer()
+{
+    if (const std::shared_ptr<Protected<ItemTypeBuffer>> itemBuf = globalItemTypeBuffer.get())
+        itemBuf->access([](ItemTypeBuffer& buf) { buf.clear(); });
+}
+
+
+void AFS::setBufferedItemType(const AbstractPath& itemPath, std::optional<ItemType> type)
+{
+    accessItemTypeBuffer(itemPath.afsDevice, [&](DeviceItemTypes& devBuf)
+    {
+        eraseItemAndChildren(devBuf, itemPath.afsPath); //child items: unknown
+        devBuf.itemTypes.emplace(itemPath.afsPath.value, type);
+    });
+}
+
+
+void AFS::invalidateBufferedItem(const AbstractPath& itemPath)
+{
+    accessItemTypeBuffer(itemPath.afsDevice, [&](DeviceItemTypes& devBuf) { eraseItemAndChildren(devBuf, itemPath.afsPath); });
+}
+
+
+void AFS::moveBufferedItem(const AbstractPath& pathFrom, const AbstractPath& pathTo)
+{
+    if (pathFrom.afsDevice != pathTo.afsDevice)
+    {
+        invalidateBufferedItem(pathFrom);
+        invalidateBufferedItem(pathTo);
+        return;
+    }
+
+    accessItemTypeBuffer(pathFrom.afsDevice, [&](DeviceItemTypes& devBuf)
+    {
+        //moving folder: keep child items (e.g. renaming folder on FTP)
+        std::vector<std::pair<Zstring, std::optional<ItemType>>> movedItems;
+        {
+            const auto [itFirst, itLast] = getChildItemRange(devBuf.itemTypes, pathFrom.afsPath);
+            for (auto it = itFirst; it != itLast; ++it)
+                movedItems.emplace_back(pathTo.afsPath.value + Zstring(ZstringView(it->first).substr(pathFrom.afsPath.value.size())), it->second);
+        }
+        std::optional<ItemType> type;
+        if (auto it = devBuf.itemTypes.find(pathFrom.afsPath.value);
+            it != devBuf.itemTypes.end())
+            type = it->second;
+
+        eraseItemAndChildren(devBuf, pathFrom.afsPath);
+        devBuf.itemTypes.emplace(pathFrom.afsPath.value, std::nullopt);
+
+        eraseItemAndChildren(devBuf, pathTo.afsPath);
+        if (type)
+        {
+            devBuf.itemTypes.emplace(pathTo.afsPath.value, type);
+            for (auto& [itemPath, itemType] : movedItems)
+                devBuf.itemTypes.emplace(std::move(itemPath), itemType);
+        }
+    });
+}
+
 
 namespace
 {
@@ -91,12 +269,254 @@ void AFS::traverseFolder(const AfsPath& folderPath, //throw FileError
 }
 
 
+namespace
+{
+/* hill-climbing over block size factors:
+    - throughput is measured per factor over windows of several files (a single file is too noisy)
+    - stick with the best factor, but first probe unmeasured neighbors, then re-probe from time to time: conditions change, e.g. WAN load   */
+constexpr size_t BLOCK_SIZE_FACTORS[] = {1, 2, 4, 8, 16, 32}; //buffer: <= 32 * 256 KB for local files, <= 32 * 480 KB for SFTP
+constexpr size_t BLOCK_SIZE_FACTOR_COUNT = std::size(BLOCK_SIZE_FACTORS);
+
+const uint64_t TUNING_WINDOW_SIZE   = 32 * 1024 * 1024; //unit: [byte]
+const uint64_t TUNING_FILE_SIZE_MIN =      1024 * 1024; //smaller files are dominated by per-file overhead (create, set modTime, close)
+const size_t   TUNING_REPROBE_INTERVAL = 8; //unit: [window]
+const double   TUNING_SWITCH_GAIN = 1.05; //hysteresis: don't flip-flop on measurement noise
+
+struct DeviceTuning
+{
+    size_t bestIdx = 0;
+    std::optional<size_t> probeIdx;
+
+    std::array<double, BLOCK_SIZE_FACTOR_COUNT> throughput{}; //unit: [byte/s]; moving average; 0 if not yet measured
+
+    std::array<uint64_t,                 BLOCK_SIZE_FACTOR_COUNT> windowBytes{};
+    std::array<std::chrono::nanoseconds, BLOCK_SIZE_FACTOR_COUNT> windowTime{};
+    size_t windowsCompleted = 0;
+};
+using DeviceTuningBuffer = std::map<Zstring /*device key: see getBlockSizeTuningKey()*/, DeviceTuning>;
+
+constinit Global<Protected<DeviceTuningBuffer>> globalBlockSizeTuning;
+GLOBAL_RUN_ONCE(globalBlockSizeTuning.set(std::make_unique<Protected<DeviceTuningBuffer>>()));
+
+
+template <class Function> inline
+void accessDeviceTuning(const Zstring& deviceKey, Function fun /*void(DeviceTuning& tuning)*/)
+{
+    if (const std::shared_ptr<Protected<DeviceTuningBuffer>> tuningBuf = globalBlockSizeTuning.get())
+        tuningBuf->access([&](DeviceTuningBuffer& buf) { fun(buf[deviceKey]); });
+}
+
+
+size_t getFactorIdx(size_t factor)
+{
+    size_t idx = 0;
+    while (idx + 1 < BLOCK_SIZE_FACTOR_COUNT && BLOCK_SIZE_FACTORS[idx + 1] <= factor)
+        ++idx;
+    return idx;
+}
+
+
+void completeTuningWindow(DeviceTuning& tuning, size_t idx)
+{
+    const double throughputWindow = static_cast<double>(tuning.windowBytes[idx]) / std::chrono::duration<double>(tuning.windowTime[idx]).count();
+    tuning.windowBytes[idx] = 0;
+    tuning.windowTime [idx] = {};
+
+    double& throughput = tuning.throughput[idx];
+    throughput = throughput == 0 ? throughputWindow : 0.7 * throughput + 0.3 * throughputWindow;
+    ++tuning.windowsCompleted;
+
+    if (tuning.probeIdx && *tuning.probeIdx == idx)
+    {
+        if (tuning.throughput[tuning.bestIdx] > 0 && //best factor may be unmeasured after setBlockSizeFactors()
+            throughput > TUNING_SWITCH_GAIN * tuning.throughput[tuning.bestIdx])
+            tuning.bestIdx = idx;
+        tuning.probeIdx = std::nullopt;
+    }
+
+    if (!tuning.probeIdx && tuning.throughput[tuning.bestIdx] > 0)
+    {
+        std::vector<size_t> neighbors;
+        if (tuning.bestIdx + 1 < BLOCK_SIZE_FACTOR_COUNT) neighbors.push_back(tuning.bestIdx + 1);
+        if (tuning.bestIdx > 0)                           neighbors.push_back(tuning.bestIdx - 1);
+
+        for (const size_t neighborIdx : neighbors)
+            if (tuning.throughput[neighborIdx] == 0)
+            {
+                tuning.probeIdx = neighborIdx;
+                return;
+            }
+
+        if (tuning.windowsCompleted % TUNING_REPROBE_INTERVAL == 0)
+            tuning.probeIdx = neighbors[(tuning.windowsCompleted / TUNING_REPROBE_INTERVAL) % neighbors.size()]; //alternate up/down
+    }
+}
+
+
+size_t getBlockSizeFactorImpl(const Zstring& deviceKey)
+{
+    size_t factor = 1;
+    accessDeviceTuning(deviceKey, [&](DeviceTuning& tuning) { factor = BLOCK_SIZE_FACTORS[tuning.probeIdx ? *tuning.probeIdx : tuning.bestIdx]; });
+    return factor;
+}
+}
+
+
+AFS::TunedBlockSize AFS::getTunedBlockSize(const AbstractPath& itemPath, std::optional<uint64_t> fileSize)
+{
+    return itemPath.afsDevice.ref().getTunedBlockSize(itemPath.afsPath, fileSize);
+}
+
+
+AFS::TunedBlockSize AFS::getTunedBlockSize(const AfsPath& itemPath, std::optional<uint64_t> fileSize) const
+{
+    if (fileSize && *fileSize < TUNING_FILE_SIZE_MIN) //per-file overhead dominates: neither worth measuring nor tuning
+        return {};
+
+    const Zstring deviceKey = getBlockSizeTuningKey(itemPath);
+    return {deviceKey, getBlockSizeFactorImpl(deviceKey)};
+}
+
+
+void AFS::reportThroughput(const TunedBlockSize& tbs, uint64_t bytes, std::chrono::nanoseconds duration)
+{
+    if (tbs.deviceKey.empty() || bytes < TUNING_FILE_SIZE_MIN || duration <= std::chrono::nanoseconds(0))
+        return;
+
+    accessDeviceTuning(tbs.deviceKey, [&](DeviceTuning& tuning)
+    {
+        const size_t idx = getFactorIdx(tbs.factor);
+        tuning.windowBytes[idx] += bytes;
+        tuning.windowTime [idx] += duration;
+
+        if (tuning.windowBytes[idx] >= TUNING_WINDOW_SIZE)
+            completeTuningWindow(tuning, idx);
+    });
+}
+
+
+std::map<Zstring, size_t> AFS::getBlockSizeFactors()
+{
+    std::map<Zstring, size_t> factors;
+    if (const std::shared_ptr<Protected<DeviceTuningBuffer>> tuningBuf = globalBlockSizeTuning.get())
+        tuningBuf->access([&](const DeviceTuningBuffer& buf)
+        {
+            for (const auto& [deviceKey, tuning] : buf)
+                factors.emplace(deviceKey, BLOCK_SIZE_FACTORS[tuning.bestIdx]);
+        });
+    return factors;
+}
+
+
+void AFS::setBlockSizeFactors(const std::map<Zstring, size_t>& factors)
+{
+    if (const std::shared_ptr<Protected<DeviceTuningBuffer>> tuningBuf = globalBlockSizeTuning.get())
+        tuningBuf->access([&](DeviceTuningBuffer& buf)
+        {
+            buf.clear();
+            for (const auto& [deviceKey, factor] : factors)
+                buf[deviceKey].bestIdx = getFactorIdx(factor);
+        });
+}
+
+
+namespace
+{
+const size_t READ_AHEAD_BUFFER_SIZE = 4 * 1024 * 1024; //unit: [byte]
+
+
+struct InputStreamReadAhead : public AFS::InputStream
+{
+    InputStreamReadAhead(std::unique_ptr<AFS::InputStream>&& streamIn, size_t bufferSize) :
+        streamIn_(std::move(streamIn)),
+        asyncStreamIn_(std::make_shared<AsyncStreamBuffer>(bufferSize)) { assert(streamIn_); }
+
+    ~InputStreamReadAhead()
+    {
+        asyncStreamIn_->setReadError(std::make_exception_ptr(ThreadStopRequest()));
+    }
+
+    size_t getBlockSize() override //throw FileError
+    {
+        if (blockSize_ == 0)
+            blockSize_ = streamIn_->getBlockSize(); //throw FileError
+        return blockSize_;
+    }
+
+    //may return short; only 0 means EOF! CONTRACT: bytesToRead > 0!
+    size_t tryRead(void* buffer, size_t bytesToRead, const IoCallback& notifyUnbufferedIO /*throw X*/) override //throw FileError, ErrorFileLocked, X
+    {
+        if (!worker_.joinable()) //start lazily: streamIn_ must not be accessed from main thread anymore hereafter
+            startWorker(getBlockSize()); //throw FileError
+
+        const size_t bytesRead = asyncStreamIn_->tryRead(buffer, bytesToRead); //throw FileError, ErrorFileLocked
+        reportBytesProcessed(notifyUnbufferedIO); //throw X
+        return bytesRead;
+    }
+
+    std::optional<AFS::StreamAttributes> tryGetAttributesFast() override //throw FileError
+    {
+        assert(!worker_.joinable());
+        return streamIn_->tryGetAttributesFast(); //throw FileError
+    }
+
+    bool hasReadAhead() const override { return true; }
+
+private:
+    void startWorker(size_t blockSize)
+    {
+        worker_ = InterruptibleThread([asyncStreamOut = asyncStreamIn_, &streamIn = *streamIn_, blockSize]
+        {
+            setCurrentThreadName(Zstr("Istream read-ahead"));
+            try
+            {
+                std::vector<std::byte> buf(blockSize); //caveat: SFTP expects multiples of block size
+                for (;;)
+                {
+                    const size_t bytesRead = streamIn.tryRead(buf.data(), buf.size(), nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+                    if (bytesRead == 0) //end of file
+                        break;
+                    asyncStreamOut->write(buf.data(), bytesRead); //throw ThreadStopRequest
+                }
+                asyncStreamOut->closeStream();
+            }
+            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
+        });
+    }
+
+    //I/O is reported when data arrives in the buffer (like FTP/Google Drive) => in context of caller thread
+    void reportBytesProcessed(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw X
+    {
+        const int64_t bytesDelta = makeSigned(asyncStreamIn_->getTotalBytesWritten()) - totalBytesReported_;
+        totalBytesReported_ += bytesDelta;
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDelta); //throw X
+    }
+
+    const std::unique_ptr<AFS::InputStream> streamIn_; //accessed by worker thread => must outlive it!
+    size_t blockSize_ = 0;
+    int64_t totalBytesReported_ = 0;
+    const std::shared_ptr<AsyncStreamBuffer> asyncStreamIn_;
+    InterruptibleThread worker_;
+};
+}
+
+
+std::unique_ptr<AFS::InputStream> AFS::makeReadAheadStream(std::unique_ptr<InputStream>&& streamIn, size_t bufferSize)
+{
+    return std::make_unique<InputStreamReadAhead>(std::move(streamIn), bufferSize);
+}
+
+
 //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
 AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const StreamAttributes& sourceAttr, //throw FileError, ErrorFileLocked, X
                                           const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) const
 {
     auto streamIn = getInputStream(sourcePath); //throw FileError, ErrorFileLocked
 
+    //cross-device copy: keep both ends busy, e.g. read from SFTP while writing to local disk
+    if (!streamIn->hasReadAhead() && compareDevice(*this, targetPath.afsDevice.ref()) != std::weak_ordering::equivalent)
+        streamIn = makeReadAheadStream(std::move(streamIn), READ_AHEAD_BUFFER_SIZE);
+
 #warning("maybe only call tryGetAttributesFast() if deviating from sourceAttr!? support file append in progress")
     //=> better: check modTime after size mismatch: if different => consider "success" (newer modTime will be seen by next sync)
 
@@ -114,17 +534,42 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const Strea
     int64_t totalBytesNotified = 0;
     IOCallbackDivider notifyIoDiv(notifyUnbufferedIO, totalBytesNotified);
 
+    XXHash64 contentHash; //hash inline: no extra I/O
+
+    const TunedBlockSize blockSizeIn  = getTunedBlockSize(sourcePath, sourceAttrNew.fileSize); //use multiples of the native block sizes
+    const TunedBlockSize blockSizeOut = AFS::getTunedBlockSize(targetPath, sourceAttrNew.fileSize);
+    const size_t streamBlockSizeOut = streamOut->getBlockSize(); //throw FileError
+
+    //measure separately: the slower device must not drag down the throughput of the other
+    std::chrono::nanoseconds readTime{};
+    std::chrono::nanoseconds writeTime{};
+
     const uint64_t streamSize = unbufferedStreamCopy([&](void* buffer, size_t bytesToRead)
     {
-        return streamIn->tryRead(buffer, bytesToRead, notifyIoDiv); //throw FileError, ErrorFileLocked, X
+        const auto startTime = std::chrono::steady_clock::now();
+        const size_t bytesRead = streamIn->tryRead(buffer, bytesToRead, notifyIoDiv); //throw FileError, ErrorFileLocked, X
+        readTime += std::chrono::steady_clock::now() - startTime;
+
+        contentHash.add(buffer, bytesRead);
+        return bytesRead;
     },
-    streamIn->getBlockSize() /*throw FileError*/,
+    streamIn->getBlockSize() /*throw FileError*/ * blockSizeIn.factor,
 
     [&](const void* buffer, size_t bytesToWrite)
     {
-        return streamOut->tryWrite(buffer, bytesToWrite, notifyIoDiv); //throw FileError, X
+        //after a short write, the remaining data at end of stream need not be a block size multiple anymore: write full blocks first
+        if (bytesToWrite > streamBlockSizeOut)
+            bytesToWrite -= bytesToWrite % streamBlockSizeOut;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        const size_t bytesWritten = streamOut->tryWrite(buffer, bytesToWrite, notifyIoDiv); //throw FileError, X
+        writeTime += std::chrono::steady_clock::now() - startTime;
+        return bytesWritten;
     },
-    streamOut->getBlockSize() /*throw FileError*/); //throw FileError, ErrorFileLocked, X
+    streamBlockSizeOut * blockSizeOut.factor); //throw FileError, ErrorFileLocked, X
+
+    reportThroughput(blockSizeIn,  streamSize, readTime);
+    reportThroughput(blockSizeOut, streamSize, writeTime);
 
     //check incomplete input *before* failing with (slightly) misleading error message in OutputStream::finalize()
     if (streamSize != sourceAttrNew.fileSize)
@@ -149,6 +594,7 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& sourcePath, const Strea
         .modTime         = sourceAttrNew.modTime,
         .sourceFilePrint = sourceAttrNew.filePrint,
         .targetFilePrint = finResult.filePrint,
+        .contentHash     = contentHash.get(),
         .errorModTime    = finResult.errorModTime,
         /* Failing to set modification time is not a fatal error from synchronization perspective (treat like external update)
                 => Support additional scenarios:
@@ -168,7 +614,7 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& sourcePath, c
                                                const std::function<void()>& onDeleteTargetFile,
                                                const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
-    auto copyFilePlain = [&](const AbstractPath& targetPathTmp)
+    auto copyFilePlainImpl = [&](const AbstractPath& targetPathTmp)
     {
         //caveat: typeid returns static type for pointers, dynamic type for references!!!
         if (typeid(sourcePath.afsDevice.ref()) == typeid(targetPathTmp.afsDevice.ref()))
@@ -185,6 +631,16 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& sourcePath, c
         return sourcePath.afsDevice.ref().copyFileAsStream(sourcePath.afsPath, sourceAttr, targetPathTmp, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
     };
 
+    auto copyFilePlain = [&](const AbstractPath& targetPathTmp)
+    {
+        ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(targetPathTmp));
+
+        FileCopyResult result = copyFilePlainImpl(targetPathTmp); //throw FileError, ErrorFileLocked, X
+
+        setBufferedItemType(targetPathTmp, ItemType::file);
+        return result;
+    };
+
     if (transactionalCopy && !hasNativeTransactionalCopy(targetPath))
     {
         const std::optional<AbstractPath> parentPath = getParentPath(targetPath);
@@ -242,12 +698,22 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& sourcePath, c
 }
 
 
+void AFS::createFolderPlain(const AbstractPath& folderPath) //throw FileError
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(folderPath));
+
+    folderPath.afsDevice.ref().createFolderPlain(folderPath.afsPath); //throw FileError
+
+    setBufferedItemType(folderPath, ItemType::folder);
+}
+
+
 void AFS::createFolderIfMissingRecursion(const AbstractPath& folderPath) //throw FileError
 {
-    auto getItemType2 = [&](const AbstractPath& itemPath) //throw FileError
+    auto getItemType2 = [&](const AbstractPath& itemPath, bool buffered) //throw FileError
     {
         try
-        { return getItemType(itemPath); } //throw FileError
+        { return buffered ? getItemTypeBuffered(itemPath) : getItemType(itemPath); } //throw FileError
         catch (const FileError& e) //need to add context!
         {
             throw FileError(replaceCpy(_("Cannot create directory %x."), L"%x", fmtPath(getDisplayPath(folderPath))),
@@ -265,7 +731,7 @@ void AFS::createFolderIfMissingRecursion(const AbstractPath& folderPath) //throw
         for (;;)
             try
             {
-                if (getItemType2(folderPathEx) == ItemType::file /*obscure, but possible*/) //throw FileError
+                if (getItemType2(folderPathEx, true /*buffered*/) == ItemType::file /*obscure, but possible*/) //throw FileError
                     throw SysError(replaceCpy(_("The name %x is already used by another item."), L"%x", fmtPath(getItemName(folderPathEx))));
                 break;
             }
@@ -291,7 +757,7 @@ void AFS::createFolderIfMissingRecursion(const AbstractPath& folderPath) //throw
             {
                 try
                 {
-                    if (getItemType2(folderPathNew) == ItemType::file /*obscure, but possible*/) //throw FileError
+                    if (getItemType2(folderPathNew, false /*buffered*/) == ItemType::file /*obscure, but possible*/) //throw FileError
                         throw SysError(replaceCpy(_("The name %x is already used by another item."), L"%x", fmtPath(getItemName(folderPathNew))));
                     else
                         continue; //already existing => possible, if createDirectoryIfMissingRecursion() is run in parallel
@@ -395,6 +861,43 @@ void AFS::removeFolderIfExistsRecursion(const AfsPath& folderPath, //throw FileE
 }
 
 
+void AFS::removeFolderIfExistsRecursion(const AbstractPath& folderPath, //throw FileError
+                                        const std::function<void(const std::wstring& displayPath)>& onBeforeFileDeletion    /*throw X*/,
+                                        const std::function<void(const std::wstring& displayPath)>& onBeforeSymlinkDeletion /*throw X*/,
+                                        const std::function<void(const std::wstring& displayPath)>& onBeforeFolderDeletion  /*throw X*/)
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(folderPath));
+
+    folderPath.afsDevice.ref().removeFolderIfExistsRecursion(folderPath.afsPath, onBeforeFileDeletion, onBeforeSymlinkDeletion, onBeforeFolderDeletion); //throw FileError, X
+
+    setBufferedItemType(folderPath, std::nullopt);
+}
+
+
+void AFS::removeFilePlain(const AbstractPath& filePath) //throw FileError
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(filePath));
+    filePath.afsDevice.ref().removeFilePlain(filePath.afsPath); //throw FileError
+    setBufferedItemType(filePath, std::nullopt);
+}
+
+
+void AFS::removeSymlinkPlain(const AbstractPath& linkPath) //throw FileError
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(linkPath));
+    linkPath.afsDevice.ref().removeSymlinkPlain(linkPath.afsPath); //throw FileError
+    setBufferedItemType(linkPath, std::nullopt);
+}
+
+
+void AFS::removeFolderPlain(const AbstractPath& folderPath) //throw FileError
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(folderPath));
+    folderPath.afsDevice.ref().removeFolderPlain(folderPath.afsPath); //throw FileError
+    setBufferedItemType(folderPath, std::nullopt);
+}
+
+
 void AFS::removeFileIfExists(const AbstractPath& filePath) //throw FileError
 {
     try
@@ -460,6 +963,7 @@ void AFS::removeEmptyFolderIfExists(const AbstractPath& folderPath) //throw File
 
 void AFS::RecycleSession::moveToRecycleBinIfExists(const AbstractPath& itemPath, const Zstring& logicalRelPath) //throw FileError, RecycleBinUnavailable
 {
+    invalidateBufferedItem(itemPath);
     try
     {
         moveToRecycleBin(itemPath, logicalRelPath); //throw FileError, RecycleBinUnavailable
@@ -500,3 +1004,11 @@ void AFS::moveToRecycleBinIfExists(const AbstractPath& itemPath) //throw FileErr
         throw;
     }
 }
+
+
+void AFS::moveToRecycleBin(const AbstractPath& itemPath) //throw FileError, RecycleBinUnavailable
+{
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(itemPath));
+    itemPath.afsDevice.ref().moveToRecycleBin(itemPath.afsPath); //throw FileError, RecycleBinUnavailable
+    setBufferedItemType(itemPath, std::nullopt);
+}
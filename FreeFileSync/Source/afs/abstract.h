@@ -7,11 +7,13 @@
 #ifndef ABSTRACT_H_873450978453042524534234
 #define ABSTRACT_H_873450978453042524534234
 
+#include <map>
 #include <functional>
 #include <chrono>
 #include <zen/file_error.h>
 #include <zen/file_path.h>
 #include <zen/serialize.h> //InputStream/OutputStream support buffered stream concept
+#include <zen/scope_guard.h>
 #include <wx+/image_holder.h> //NOT a wxWidgets dependency!
 
 
@@ -100,11 +102,23 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     { return itemPath.afsDevice.ref().getItemTypeIfExists(itemPath.afsPath); } //throw FileError
 
     static bool itemExists(const AbstractPath& itemPath) { return static_cast<bool>(getItemTypeIfExists(itemPath)); } //throw FileError
+
+    //process-wide item type buffer for devices with slow metadata access (FTP/SFTP/Google Drive):
+    //- filled from folder traversal (parallelFolderScan()), kept up to date by AFS write operations below
+    //- returns *expected* state => don't use for error analysis (e.g. "source item deleted in the meantime?")
+    static ItemType                getItemTypeBuffered        (const AbstractPath& itemPath); //throw FileError
+    static std::optional<ItemType> getItemTypeIfExistsBuffered(const AbstractPath& itemPath); //throw FileError
+    static bool                    itemExistsBuffered         (const AbstractPath& itemPath) { return static_cast<bool>(getItemTypeIfExistsBuffered(itemPath)); } //throw FileError
+
+    static bool hasSlowItemAccess(const AfsDevice& afsDevice) { return afsDevice.ref().hasSlowItemAccess(); }
+    static void bufferItemType(const AbstractPath& itemPath, ItemType type); //no-op if !hasSlowItemAccess()
+    static void clearItemTypeBuffer(const AfsDevice& afsDevice);
+    static void clearItemTypeBuffer(); //all devices
     //----------------------------------------------------------------------------------------------------------------
 
     //already existing: fail
     //does NOT create parent directories recursively if not existing
-    static void createFolderPlain(const AbstractPath& folderPath) { folderPath.afsDevice.ref().createFolderPlain(folderPath.afsPath); } //throw FileError
+    static void createFolderPlain(const AbstractPath& folderPath); //throw FileError
 
     //creates directories recursively if not existing
     //returns false if folder already exists
@@ -113,20 +127,20 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static void removeFolderIfExistsRecursion(const AbstractPath& folderPath, //throw FileError
                                               const std::function<void(const std::wstring& displayPath)>& onBeforeFileDeletion    /*throw X*/, //
                                               const std::function<void(const std::wstring& displayPath)>& onBeforeSymlinkDeletion /*throw X*/, //optional; one call for each object!
-                                              const std::function<void(const std::wstring& displayPath)>& onBeforeFolderDeletion  /*throw X*/) //
-    { return folderPath.afsDevice.ref().removeFolderIfExistsRecursion(folderPath.afsPath, onBeforeFileDeletion, onBeforeSymlinkDeletion, onBeforeFolderDeletion); }
+                                              const std::function<void(const std::wstring& displayPath)>& onBeforeFolderDeletion  /*throw X*/); //
 
     static void removeFileIfExists       (const AbstractPath& filePath);   //
     static void removeSymlinkIfExists    (const AbstractPath& linkPath);   //throw FileError
     static void removeEmptyFolderIfExists(const AbstractPath& folderPath); //
 
-    static void removeFilePlain   (const AbstractPath& filePath  ) { filePath  .afsDevice.ref().removeFilePlain   (filePath  .afsPath); } //
-    static void removeSymlinkPlain(const AbstractPath& linkPath  ) { linkPath  .afsDevice.ref().removeSymlinkPlain(linkPath  .afsPath); } //throw FileError
-    static void removeFolderPlain (const AbstractPath& folderPath) { folderPath.afsDevice.ref().removeFolderPlain (folderPath.afsPath); } //
+    static void removeFilePlain   (const AbstractPath& filePath  ); //
+    static void removeSymlinkPlain(const AbstractPath& linkPath  ); //throw FileError
+    static void removeFolderPlain (const AbstractPath& folderPath); //
     //----------------------------------------------------------------------------------------------------------------
     //static void setModTime(const AbstractPath& itemPath, time_t modTime) { itemPath.afsDevice.ref().setModTime(itemPath.afsPath, modTime); } //throw FileError, follows symlinks
 
     static AbstractPath getSymlinkResolvedPath(const AbstractPath& linkPath) { return linkPath.afsDevice.ref().getSymlinkResolvedPath(linkPath.afsPath); } //throw FileError
+    static AbstractPath getSymlinkResolvedPathBuffered(const AbstractPath& linkPath); //throw FileError; see getItemTypeBuffered()
     static bool equalSymlinkContent(const AbstractPath& linkPathL, const AbstractPath& linkPathR); //throw FileError
     //----------------------------------------------------------------------------------------------------------------
     static zen::FileIconHolder getFileIcon      (const AbstractPath& filePath, int pixelSize) { return filePath.afsDevice.ref().getFileIcon      (filePath.afsPath, pixelSize); } //throw FileError; optional return value
@@ -150,10 +164,17 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
         //only returns attributes if they are already buffered within stream handle and determination would be otherwise expensive (e.g. FTP/SFTP):
         virtual std::optional<StreamAttributes> tryGetAttributesFast() = 0; //throw FileError
+
+        //stream is already read asynchronously (e.g. FTP/Google Drive) => no need for makeReadAheadStream()
+        virtual bool hasReadAhead() const { return false; }
     };
     //return value always bound:
     static std::unique_ptr<InputStream> getInputStream(const AbstractPath& filePath) { return filePath.afsDevice.ref().getInputStream(filePath.afsPath); } //throw FileError, ErrorFileLocked
 
+    //read ahead (up to "bufferSize" bytes) on worker thread => overlap source reads with target writes
+    //CONTRACT: call tryGetAttributesFast() before first tryRead()
+    static std::unique_ptr<InputStream> makeReadAheadStream(std::unique_ptr<InputStream>&& streamIn, size_t bufferSize);
+
     //----------------------------------------------------------------------------------------------------------------
 
     struct FinalizeResult
@@ -189,7 +210,10 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static std::unique_ptr<OutputStream> getOutputStream(const AbstractPath& filePath, //throw FileError
                                                          std::optional<uint64_t> streamSize,
                                                          std::optional<time_t> modTime)
-    { return std::make_unique<OutputStream>(filePath.afsDevice.ref().getOutputStream(filePath.afsPath, streamSize, modTime), filePath, streamSize); }
+    {
+        invalidateBufferedItem(filePath);
+        return std::make_unique<OutputStream>(filePath.afsDevice.ref().getOutputStream(filePath.afsPath, streamSize, modTime), filePath, streamSize);
+    }
     //----------------------------------------------------------------------------------------------------------------
 
     struct SymlinkInfo
@@ -274,6 +298,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         time_t modTime = 0; //number of seconds since Jan. 1st 1970 GMT
         FingerPrint sourceFilePrint = 0; //optional
         FingerPrint targetFilePrint = 0; //
+        uint64_t contentHash = 0; //optional: XXH64 of the copied data (0 if data was not passed through, e.g. server-side copy)
         std::optional<zen::FileError> errorModTime; //failure to set modification time
     };
 
@@ -296,6 +321,22 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     //already existing: fail
     static void copySymlink(const AbstractPath& sourcePath, const AbstractPath& targetPath, bool copyFilePermissions); //throw FileError
 
+    //----------------------------------------------------------------------------------------------------------------
+    /* adaptive block size: I/O buffer = stream block size * factor (=> block size contracts of the streams still hold)
+        - factor is tuned per device by hill-climbing over measured throughput (USB stick vs NVMe vs NFS vs WAN)
+        - best factors are persisted across runs: see GlobalConfig::blockSizeFactors
+        - device key is resolved once per file (not free: e.g. stat + realpath for native) and skipped for files too small to be measured */
+    struct TunedBlockSize
+    {
+        Zstring deviceKey; //empty: not tuned
+        size_t factor = 1;
+    };
+    static TunedBlockSize getTunedBlockSize(const AbstractPath& itemPath, std::optional<uint64_t> fileSize /*nullopt: unknown*/);
+    static void reportThroughput(const TunedBlockSize& tbs, uint64_t bytes, std::chrono::nanoseconds duration); //duration: time spent on I/O for this item only
+
+    static std::map<Zstring, size_t> getBlockSizeFactors(); //device key => factor: see getBlockSizeTuningKey()
+    static void setBlockSizeFactors(const std::map<Zstring, size_t>& factors);
+
     //----------------------------------------------------------------------------------------------------------------
 
     //- returns < 0 if not available
@@ -324,7 +365,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static void moveToRecycleBinIfExists(const AbstractPath& itemPath); //throw FileError, RecycleBinUnavailable
 
     //fails if item is not existing
-    static void moveToRecycleBin(const AbstractPath& itemPath) { itemPath.afsDevice.ref().moveToRecycleBin(itemPath.afsPath); }; //throw FileError, RecycleBinUnavailable
+    static void moveToRecycleBin(const AbstractPath& itemPath); //throw FileError, RecycleBinUnavailable
 
     //================================================================================================================
 
@@ -348,6 +389,8 @@ protected:
     FileCopyResult copyFileAsStream(const AfsPath& sourcePath, const StreamAttributes& sourceAttr, //throw FileError, ErrorFileLocked, X
                                     const AbstractPath& targetPath, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
 
+    //block size tuning: see getTunedBlockSize(const AbstractPath&, std::optional<uint64_t>)
+    TunedBlockSize getTunedBlockSize(const AfsPath& itemPath, std::optional<uint64_t> fileSize) const;
 
     std::wstring generateMoveErrorMsg(const AfsPath& pathFrom, const AbstractPath& pathTo) const
     {
@@ -364,8 +407,16 @@ protected:
     }
 
 private:
+    //item type buffer maintenance: see getItemTypeBuffered()
+    static void setBufferedItemType(const AbstractPath& itemPath, std::optional<ItemType> type); //nullopt: not existing
+    static void invalidateBufferedItem(const AbstractPath& itemPath); //including child items
+    static void moveBufferedItem(const AbstractPath& pathFrom, const AbstractPath& pathTo);
+
     virtual std::optional<Zstring> getNativeItemPath(const AfsPath& itemPath) const { return {}; };
 
+    //identifies the physical device for block size tuning: stable across runs + no passwords!
+    virtual Zstring getBlockSizeTuningKey(const AfsPath& itemPath) const { return zen::utfTo<Zstring>(getDisplayPath(AfsPath())); } //default: device root
+
     virtual Zstring getInitPathPhrase(const AfsPath& itemPath) const = 0;
 
     virtual std::vector<Zstring> getPathPhraseAliases(const AfsPath& itemPath) const = 0;
@@ -432,6 +483,8 @@ private:
     virtual void authenticateAccess(const RequestPasswordFun& requestPassword /*throw X*/) const = 0; //throw FileError, X
 
     virtual bool hasNativeTransactionalCopy() const = 0;
+
+    virtual bool hasSlowItemAccess() const = 0; //=> use item type buffer
     //----------------------------------------------------------------------------------------------------------------
 
     virtual int64_t getFreeDiskSpace(const AfsPath& folderPath) const = 0; //throw FileError, returns < 0 if not available
@@ -537,8 +590,12 @@ void AbstractFileSystem::moveAndRenameItem(const AbstractPath& pathFrom, const A
     if (typeid(pathFrom.afsDevice.ref()) != typeid(pathTo.afsDevice.ref()))
         throw ErrorMoveUnsupported(generateMoveErrorMsg(pathFrom, pathTo), _("Operation not supported between different devices."));
 
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(pathFrom); invalidateBufferedItem(pathTo));
+
     //already existing: undefined behavior! (e.g. fail/overwrite)
     pathFrom.afsDevice.ref().moveAndRenameItemForSameAfsType(pathFrom.afsPath, pathTo); //throw FileError, ErrorMoveUnsupported
+
+    moveBufferedItem(pathFrom, pathTo);
 }
 
 
@@ -550,14 +607,20 @@ void AbstractFileSystem::copyNewFolder(const AbstractPath& sourcePath, const Abs
     if (typeid(sourcePath.afsDevice.ref()) != typeid(targetPath.afsDevice.ref())) //fall back:
     {
         //already existing: fail
-        createFolderPlain(targetPath); //throw FileError
+        createFolderPlain(targetPath); //throw FileError => buffers item type
 
         if (copyFilePermissions)
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(getDisplayPath(targetPath))),
                             _("Operation not supported between different devices."));
     }
     else
+    {
+        ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(targetPath));
+
         sourcePath.afsDevice.ref().copyNewFolderForSameAfsType(sourcePath.afsPath, targetPath, copyFilePermissions); //throw FileError
+
+        setBufferedItemType(targetPath, ItemType::folder);
+    }
 }
 
 
@@ -572,8 +635,12 @@ void AbstractFileSystem::copySymlink(const AbstractPath& sourcePath, const Abstr
                                               L"%x", L'\n' + fmtPath(getDisplayPath(sourcePath))),
                                    L"%y", L'\n' + fmtPath(getDisplayPath(targetPath))), _("Operation not supported between different devices."));
 
+    ZEN_ON_SCOPE_FAIL(invalidateBufferedItem(targetPath));
+
     //already existing: fail
     sourcePath.afsDevice.ref().copySymlinkForSameAfsType(sourcePath.afsPath, targetPath, copyFilePermissions); //throw FileError
+
+    setBufferedItemType(targetPath, ItemType::symlink);
 }
 }
 
@@ -17,7 +17,7 @@ using namespace zen;
 void fff::initAfs(const AfsConfig& cfg)
 {
     ftpInit();
-    sftpInit();
+    sftpInit(appendPath(cfg.configDirPath, Zstr("SftpServers.dat")));
     gdriveInit(appendPath(cfg.configDirPath,   Zstr("GoogleDrive")),
                appendPath(cfg.resourceDirPath, Zstr("cacert.pem")));
 }
@@ -2033,6 +2033,8 @@ struct InputStreamFtp : public AFS::InputStream
     //  CURLOPT_FILETIME:                                           test case 77 files, 4MB: overall copy time increases by 12%
     //  CURLOPT_PREQUOTE/CURLOPT_PREQUOTE/CURLOPT_POSTQUOTE + MDTM: test case 77 files, 4MB: overall copy time increases by 12%
 
+    bool hasReadAhead() const override { return true; }
+
 private:
     void reportBytesProcessed(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw X
     {
@@ -2571,6 +2573,8 @@ private:
     }
 
     bool hasNativeTransactionalCopy() const override { return false; }
+
+    bool hasSlowItemAccess() const override { return true; }
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& folderPath) const override { return -1; } //throw FileError, returns < 0 if not available
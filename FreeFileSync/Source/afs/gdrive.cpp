@@ -72,6 +72,11 @@ const Zchar* GOOGLE_REST_API_SERVER = Zstr("www.googleapis.com");
 constexpr std::chrono::seconds HTTP_SESSION_MAX_IDLE_TIME  (20);
 constexpr std::chrono::seconds HTTP_SESSION_CLEANUP_INTERVAL(4);
 constexpr std::chrono::seconds GDRIVE_SYNC_INTERVAL         (5);
+constexpr std::chrono::seconds GDRIVE_RATE_LIMIT_BACKOFF_MIN(1);
+
+const size_t GDRIVE_BATCH_SIZE_MAX     = 100; //Google's limit: https://developers.google.com/workspace/drive/api/guides/performance#batch-requests
+const size_t GDRIVE_BATCH_PARALLEL_MAX = 4;   //concurrent batch requests per user session
+const int    GDRIVE_RATE_LIMIT_RETRY_MAX = 4; //exponential back-off: 1s, 2s, 4s, 8s
 
 const size_t GDRIVE_BLOCK_SIZE_DOWNLOAD =  64 * 1024; //libcurl returns blocks of only 16 kB as returned by recv() even if we request larger blocks via CURLOPT_BUFFERSIZE
 const size_t GDRIVE_BLOCK_SIZE_UPLOAD   =  64 * 1024; //libcurl requests blocks of 64 kB. larger blocksizes set via CURLOPT_UPLOAD_BUFFERSIZE do not seem to make a difference
@@ -83,7 +88,11 @@ const char gdriveFolderMimeType  [] = "application/vnd.google-apps.folder";
 const char gdriveShortcutMimeType[] = "application/vnd.google-apps.shortcut"; //= symbolic link!
 
 const char DB_FILE_DESCR[] = "FreeFileSync";
-const int  DB_FILE_VERSION = 5; //2021-05-15
+const int  DB_FILE_VERSION = 6; //2026-10-18
+const int  DB_JOURNAL_VERSION = 1; //2026-10-18
+
+constexpr std::chrono::seconds GDRIVE_JOURNAL_FLUSH_INTERVAL(2);
+const uint64_t GDRIVE_JOURNAL_COMPACT_MIN_SIZE = 4 * 1024 * 1024; //[byte] rewrite snapshot when journal grows larger than this and the last snapshot
 
 std::string getGdriveClientId    () { return ""; } // => replace with live credentials
 std::string getGdriveClientSecret() { return ""; } //
@@ -369,6 +378,302 @@ HttpSession::Result gdriveHttpsRequest(const std::string& serverRelPath, //throw
 
 //========================================================================================================
 
+struct GdriveMetaRequest //metadata-only request: no file content up-/download
+{
+    std::string httpMethod; //POST, PATCH, DELETE
+    std::string serverRelPath;
+    std::string postBuf; //JSON; optional
+};
+
+struct GdriveMetaResponse
+{
+    int statusCode = 0;
+    std::string body;
+};
+
+
+GdriveMetaResponse gdriveMetaRequestPlain(const GdriveMetaRequest& request, const GdriveAccess& access) //throw SysError
+{
+    std::vector<std::string> extraHeaders;
+    std::vector<CurlOption> extraOptions;
+    if (request.httpMethod != "POST")
+        extraOptions.emplace_back(CURLOPT_CUSTOMREQUEST, request.httpMethod.c_str());
+    if (!request.postBuf.empty())
+    {
+        extraHeaders.push_back("Content-Type: application/json; charset=UTF-8");
+        extraOptions.emplace_back(CURLOPT_POSTFIELDS, request.postBuf.c_str());
+    }
+
+    GdriveMetaResponse response;
+    response.statusCode = gdriveHttpsRequest(request.serverRelPath, extraHeaders, extraOptions,
+    [&](std::span<const char> buf) { response.body.append(buf.data(), buf.size()); },
+    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access).statusCode; //throw SysError
+    return response;
+}
+
+
+bool isRetryableError(const GdriveMetaResponse& response)
+{
+    //https://developers.google.com/workspace/drive/api/guides/limits
+    //https://developers.google.com/workspace/drive/api/guides/handle-errors#resolve_a_5xx_error
+    return response.statusCode == 429 ||
+           (response.statusCode == 403 && (contains(response.body, "\"rateLimitExceeded\"") ||
+                                            contains(response.body, "\"userRateLimitExceeded\""))) ||
+           response.statusCode == 500 ||
+           response.statusCode == 502 ||
+           response.statusCode == 503 ||
+           response.statusCode == 504;
+}
+
+
+//https://developers.google.com/workspace/drive/api/guides/performance#batch-requests
+std::vector<GdriveMetaResponse> gdriveMetaRequestBatch(const std::vector<const GdriveMetaRequest*>& requests, const GdriveAccess& access) //throw SysError
+{
+    const std::string boundary = "ffs_batch_" + formatAsHexString(generateGUID());
+
+    std::string postBuf;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const GdriveMetaRequest& req = *requests[i];
+        postBuf += "--" + boundary + "\r\n"
+                   "Content-Type: application/http\r\n"
+                   "Content-ID: <" + numberTo<std::string>(i) + ">\r\n"
+                   "\r\n" +
+                   req.httpMethod + ' ' + req.serverRelPath + " HTTP/1.1\r\n";
+        if (!req.postBuf.empty())
+            postBuf += "Content-Type: application/json; charset=UTF-8\r\n"
+                       "Content-Length: " + numberTo<std::string>(req.postBuf.size()) + "\r\n"
+                       "\r\n" + req.postBuf;
+        postBuf += "\r\n";
+    }
+    postBuf += "--" + boundary + "--\r\n";
+
+    std::string response;
+    std::string responseBoundary;
+    const HttpSession::Result httpResult = gdriveHttpsRequest("/batch/drive/v3", {"Content-Type: multipart/mixed; boundary=" + boundary},
+    {{CURLOPT_POSTFIELDS, postBuf.c_str()}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/,
+    [&](const std::string_view& header)
+    {
+        //e.g. "Content-Type: multipart/mixed; boundary=batch_abc123"
+        if (startsWithAsciiNoCase(header, "content-type:"))
+        {
+            responseBoundary = afterFirst(std::string(header), "boundary=", IfNotFoundReturn::none);
+            trim(responseBoundary, TrimSide::both, [](char c) { return isWhiteSpace(c) || c == '"'; });
+        }
+    }, access); //throw SysError
+
+    //batch as a whole rate-limited or failed temporarily: report for each request => let caller retry
+    if (const GdriveMetaResponse batchResponse{httpResult.statusCode, response};
+        isRetryableError(batchResponse))
+        return std::vector<GdriveMetaResponse>(requests.size(), batchResponse);
+
+    if (httpResult.statusCode != 200 || responseBoundary.empty())
+        throw SysError(formatGdriveErrorRaw(response));
+
+    std::vector<std::optional<GdriveMetaResponse>> responses(requests.size());
+
+    //response parts: "--<boundary>\r\n" <part headers incl. Content-ID> "\r\n\r\n" <HTTP status line + headers> "\r\n\r\n" <body>
+    std::vector<std::string> parts;
+    for (size_t pos = 0; pos < response.size();)
+    {
+        const size_t posNext = std::min(response.find("--" + responseBoundary, pos), response.size());
+        parts.push_back(response.substr(pos, posNext - pos));
+        pos = posNext == response.size() ? posNext : posNext + 2 + responseBoundary.size();
+    }
+
+    for (const std::string& part : parts)
+    {
+        const std::string partHeaders = beforeFirst(part, "\r\n\r\n", IfNotFoundReturn::none);
+        const std::string partContent = afterFirst (part, "\r\n\r\n", IfNotFoundReturn::none);
+
+        //e.g. "Content-ID: <response-7>"
+        const std::string contentId = beforeFirst(afterFirst(partHeaders, "<response-", IfNotFoundReturn::none), '>', IfNotFoundReturn::none);
+        if (contentId.empty() || !std::all_of(contentId.begin(), contentId.end(), [](char c) { return isDigit(c); }))
+            continue; //e.g. trailing "--\r\n"
+
+        const size_t idx = stringTo<size_t>(contentId);
+        if (idx >= responses.size())
+            throw SysError(formatSystemError("gdriveMetaRequestBatch", L"", L"Invalid batch response ID: " + utfTo<std::wstring>(contentId)));
+
+        //e.g. "HTTP/1.1 204 No Content"
+        const std::string statusLine = beforeFirst(partContent, "\r\n", IfNotFoundReturn::all);
+        std::string body = afterFirst(partContent, "\r\n\r\n", IfNotFoundReturn::none);
+        trim(body, TrimSide::right);
+
+        responses[idx] = GdriveMetaResponse{stringTo<int>(beforeFirst(afterFirst(statusLine, ' ', IfNotFoundReturn::none), ' ', IfNotFoundReturn::all)), std::move(body)};
+    }
+
+    std::vector<GdriveMetaResponse> results;
+    for (std::optional<GdriveMetaResponse>& resp : responses)
+        if (resp)
+            results.push_back(std::move(*resp));
+        else
+            throw SysError(formatSystemError("gdriveMetaRequestBatch", L"", L"Incomplete batch response.") + L"\n" + formatGdriveErrorRaw(response));
+    return results;
+}
+
+
+/*  coalesce metadata requests of concurrent threads into batch requests:
+    - no dedicated worker threads: calling threads take turns sending pending requests
+    - batches only form if multiple threads request at the same time: the sync engine uses a single worker thread
+      => during synchronization requests are sent one by one; main benefit is the shared rate limit handling
+    - why keep the batching then? comparison runs one thread per device, i.e. per (account, shared drive)
+      => folder pairs on several shared drives of the same account scan concurrently using the same access token
+    - at most GDRIVE_BATCH_PARALLEL_MAX batches are in flight per user session => each uses a separate HttpSessionManager session
+    - rate-limited (429/403) and temporarily failed (5xx) requests are retried with exponential back-off, which is shared by all requests of the same user session
+    - whole batch rate-limited or failed: retry with half the batch size                                                         */
+class GdriveRequestBatcher
+{
+public:
+    GdriveMetaResponse perform(const GdriveMetaRequest& request, const GdriveAccess& access) //throw SysError, ThreadStopRequest
+    {
+        const auto job = std::make_shared<BatchJob>(request);
+
+        std::unique_lock dummy(lockQueues_);
+        BatchQueue& queue = queues_[access.token]; //requests of different users can't be batched together
+        queue.pending.push_back(job);
+
+        ZEN_ON_SCOPE_FAIL( //e.g. ThreadStopRequest: don't leave our request behind
+            if (!dummy.owns_lock())
+                dummy.lock();
+            if (auto it = queues_.find(access.token); //"queue" might already be erased by another thread!
+                it != queues_.end())
+            {
+                RingBuffer<std::shared_ptr<BatchJob>> pendingOther;
+                for (const std::shared_ptr<BatchJob>& bj : it->second.pending)
+                    if (bj != job)
+                        pendingOther.push_back(bj);
+                it->second.pending.swap(pendingOther);
+
+                if (it->second.pending.empty() && it->second.sendersActive == 0)
+                    queues_.erase(it);
+            });
+
+        while (!job->done)
+            if (queue.sendersActive < GDRIVE_BATCH_PARALLEL_MAX && !queue.pending.empty())
+            {
+                if (const auto now = std::chrono::steady_clock::now();
+                    now < queue.backOffUntil)
+                {
+                    const auto backOffUntil = queue.backOffUntil;
+                    dummy.unlock();
+                    interruptibleSleep(backOffUntil - now); //throw ThreadStopRequest
+                    dummy.lock();
+                    continue; //re-evaluate: someone else might have sent our request in the meantime
+                }
+
+                std::vector<std::shared_ptr<BatchJob>> batch;
+                while (!queue.pending.empty() && batch.size() < queue.batchSizeMax)
+                {
+                    batch.push_back(queue.pending.front());
+                    queue.pending.pop_front();
+                }
+
+                ++queue.sendersActive;
+                ZEN_ON_SCOPE_EXIT(--queue.sendersActive; conditionJobDone_.notify_all()); //lock is held again at this point
+                ZEN_ON_SCOPE_FAIL(std::for_each(batch.rbegin(), batch.rend(), [&](const std::shared_ptr<BatchJob>& bj) { queue.pending.push_front(bj); })); //let other threads send
+
+                std::vector<GdriveMetaResponse> responses;
+                std::exception_ptr batchError;
+                {
+                    dummy.unlock();
+                    ZEN_ON_SCOPE_EXIT(dummy.lock());
+                    try
+                    {
+                        if (batch.size() == 1)
+                            responses.push_back(gdriveMetaRequestPlain(batch[0]->request, access)); //throw SysError
+                        else
+                        {
+                            std::vector<const GdriveMetaRequest*> requests;
+                            for (const std::shared_ptr<BatchJob>& bj : batch)
+                                requests.push_back(&bj->request);
+
+                            responses = gdriveMetaRequestBatch(requests, access); //throw SysError
+                        }
+                    }
+                    catch (ThreadStopRequest&) { throw; } //only concerns *this* thread
+                    catch (...) { batchError = std::current_exception(); } //hand any error to all waiting jobs
+                }
+
+                if (!batchError && batch.size() > 1 &&
+                    std::all_of(responses.begin(), responses.end(), [](const GdriveMetaResponse& resp) { return isRetryableError(resp); }))
+                    queue.batchSizeMax = std::max<size_t>(batch.size() / 2, 1); //split: be nice to the server
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    BatchJob& bj = *batch[i];
+                    if (!batchError && isRetryableError(responses[i]) && bj.retryCount < GDRIVE_RATE_LIMIT_RETRY_MAX)
+                    {
+                        queue.backOffUntil = std::max(queue.backOffUntil, std::chrono::steady_clock::now() + GDRIVE_RATE_LIMIT_BACKOFF_MIN * (1 << bj.retryCount));
+                        ++bj.retryCount;
+                        queue.pending.push_front(batch[i]); //retry ASAP after back-off
+                        continue;
+                    }
+
+                    if (batchError)
+                        bj.error = batchError;
+                    else
+                        bj.response = std::move(responses[i]);
+                    bj.done = true;
+                }
+            }
+            else
+                interruptibleWait(conditionJobDone_, dummy, [&] //throw ThreadStopRequest
+            {
+                return job->done || //check first: "queue" might already be erased by another thread!
+                       (queue.sendersActive < GDRIVE_BATCH_PARALLEL_MAX && !queue.pending.empty());
+            });
+
+        if (auto it = queues_.find(access.token); //"queue" might already be erased by another thread!
+            it != queues_.end() && it->second.pending.empty() && it->second.sendersActive == 0)
+            queues_.erase(it); //access tokens are short-lived => clean up
+
+        if (job->error)
+            std::rethrow_exception(job->error);
+        return std::move(job->response);
+    }
+
+private:
+    struct BatchJob
+    {
+        explicit BatchJob(const GdriveMetaRequest& req) : request(req) {}
+
+        const GdriveMetaRequest request;
+        int retryCount = 0;
+
+        bool done = false;
+        GdriveMetaResponse response;
+        std::exception_ptr error;
+    };
+
+    struct BatchQueue
+    {
+        RingBuffer<std::shared_ptr<BatchJob>> pending;
+        size_t sendersActive = 0;
+        size_t batchSizeMax = GDRIVE_BATCH_SIZE_MAX;
+        std::chrono::steady_clock::time_point backOffUntil;
+    };
+
+    std::mutex lockQueues_;
+    std::condition_variable conditionJobDone_;
+    std::unordered_map<std::string /*access token*/, BatchQueue> queues_;
+};
+
+//--------------------------------------------------------------------------------------
+constinit Global<GdriveRequestBatcher> globalGdriveRequestBatcher;
+GLOBAL_RUN_ONCE(globalGdriveRequestBatcher.set(std::make_unique<GdriveRequestBatcher>()));
+//--------------------------------------------------------------------------------------
+
+GdriveMetaResponse gdriveMetaRequest(const GdriveMetaRequest& request, const GdriveAccess& access) //throw SysError
+{
+    if (const std::shared_ptr<GdriveRequestBatcher> batcher = globalGdriveRequestBatcher.get())
+        return batcher->perform(request, access); //throw SysError
+
+    throw SysError(formatSystemError("gdriveMetaRequest", L"", L"Function call not allowed during init/shutdown."));
+}
+
+//========================================================================================================
+
 struct GdriveUser
 {
     std::wstring displayName;
@@ -1247,15 +1552,12 @@ void gdriveDeleteItem(const std::string& itemId, const GdriveAccess& access) //t
     {
         {"supportsAllDrives", "true"},
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {} /*extraHeaders*/, {{CURLOPT_CUSTOMREQUEST, "DELETE"}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const GdriveMetaResponse response = gdriveMetaRequest({"DELETE", "/drive/v3/files/" + itemId + '?' + queryParams}, access); //throw SysError
 
-    if (response.empty() && httpResult.statusCode == 204)
+    if (response.body.empty() && response.statusCode == 204)
         return; //"If successful, this method returns an empty response body"
 
-    throw SysError(formatGdriveErrorRaw(response));
+    throw SysError(formatGdriveErrorRaw(response.body));
 }
 
 
@@ -1269,10 +1571,8 @@ void gdriveUnlinkParent(const std::string& itemId, const std::string& parentId,
         {"supportsAllDrives", "true"},
         {"fields", "id,parents"}, //for test if operation was successful
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, { CURLOPT_POSTFIELDS, "{}"}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const GdriveMetaResponse httpResult = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, "{}"}, access); //throw SysError
+    const std::string& response = httpResult.body;
 
     if (response.empty() && httpResult.statusCode == 204)
         return; //removing last parent of item not owned by us returns "204 No Content" (instead of 200 + file body)
@@ -1306,10 +1606,7 @@ void gdriveMoveToTrash(const std::string& itemId, const GdriveAccess& access) //
     });
     const std::string postBuf = R"({ "trashed": true })";
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1336,10 +1633,7 @@ std::string /*folderId*/ gdriveCreateFolderPlain(const Zstring& folderName, cons
     postParams.objectVal.set("parents", std::vector<JsonValue> {JsonValue(parentId)});
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files?" + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"POST", "/drive/v3/files?" + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1373,10 +1667,7 @@ std::string /*shortcutId*/ gdriveCreateShortcutPlain(const Zstring& shortcutName
     postParams.objectVal.set("shortcutDetails", std::move(shortcutDetails));
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files?" + queryParams, {"Content-Type: application/json; charset=UTF-8"},
-    {{CURLOPT_POSTFIELDS, postBuf.c_str()}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"POST", "/drive/v3/files?" + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1413,11 +1704,7 @@ std::string /*fileId*/ gdriveCopyFile(const std::string& fileId, const std::stri
     postParams.objectVal.set("modifiedTime", modTimeRfc);
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + fileId + "/copy?" + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"POST", "/drive/v3/files/" + fileId + "/copy?" + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1462,11 +1749,7 @@ void gdriveMoveAndRenameItem(const std::string& itemId, const std::string& paren
     postParams.objectVal.set("modifiedTime", modTimeRfc);
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).body; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1877,6 +2160,9 @@ public:
     GdriveFileState(MemoryStreamIn& stream, GdriveAccessBuffer& accessBuf) : //throw SysError
         accessBuf_(accessBuf)
     {
+        journalChanges_ = false; //restoring the snapshot
+        ZEN_ON_SCOPE_EXIT(journalChanges_ = true);
+
         lastSyncToken_   = readContainer<std::string>(stream); //
         driveId_         = readContainer<std::string>(stream); //SysErrorUnexpectedEos
         sharedDriveName_ = utfTo<Zstring>(readContainer<std::string>(stream)); //
@@ -1895,18 +2181,7 @@ public:
             if (itemId.empty())
                 break;
 
-            GdriveItemDetails details = {}; //read in correct sequence!
-            details.itemName = utfTo<Zstring>(readContainer<std::string>(stream)); //
-            details.type     = readNumber<GdriveItemType>(stream); //
-            details.owner    = readNumber     <FileOwner>(stream); //
-            details.fileSize = readNumber      <uint64_t>(stream); //SysErrorUnexpectedEos
-            details.modTime  = readNumber       <int64_t>(stream); //
-            details.targetId = readContainer<std::string>(stream); //
-
-            size_t parentsCount = readNumber<uint32_t>(stream); //SysErrorUnexpectedEos
-            while (parentsCount-- != 0)
-                details.parentIds.push_back(readContainer<std::string>(stream)); //SysErrorUnexpectedEos
-
+            const GdriveItemDetails details = readItemDetails(stream); //throw SysErrorUnexpectedEos
             updateItemState(itemId, &details);
         }
     }
@@ -1924,22 +2199,6 @@ public:
                 writeContainer(stream, folderId);
         writeContainer(stream, std::string()); //sentinel
 
-        auto serializeItem = [&](const std::string& itemId, const GdriveItemDetails& details)
-        {
-            writeContainer             (stream, itemId);
-            writeContainer             (stream, utfTo<std::string>(details.itemName));
-            writeNumber<GdriveItemType>(stream, details.type);
-            writeNumber     <FileOwner>(stream, details.owner);
-            writeNumber      <uint64_t>(stream, details.fileSize);
-            writeNumber       <int64_t>(stream, details.modTime);
-            static_assert(sizeof(details.modTime) <= sizeof(int64_t)); //ensure cross-platform compatibility!
-            writeContainer(stream, details.targetId);
-
-            writeNumber(stream, static_cast<uint32_t>(details.parentIds.size()));
-            for (const std::string& parentId : details.parentIds)
-                writeContainer(stream, parentId);
-        };
-
         //serialize + clean up: only save items in "known folders" + items referenced by shortcuts
         for (const auto& [folderId, content] : folderContents_)
             if (content.isKnownFolder)
@@ -1948,7 +2207,7 @@ public:
                     const auto& [itemId, details] = *itItem;
                     if (itemId.empty())
                         throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
-                    serializeItem(itemId, details);
+                    writeItem(stream, itemId, details);
 
                     if (details.type == GdriveItemType::shortcut)
                     {
@@ -1957,7 +2216,7 @@ public:
 
                         if (auto it = itemDetails_.find(details.targetId);
                             it != itemDetails_.end())
-                            serializeItem(details.targetId, it->second);
+                            writeItem(stream, details.targetId, it->second);
                     }
                 }
         writeContainer(stream, std::string()); //sentinel
@@ -1969,6 +2228,49 @@ public:
 
     void setSharedDriveName(const Zstring& sharedDriveName) { sharedDriveName_ = sharedDriveName; }
 
+    //-------------- journal --------------
+    //all file state changes are recorded *in order* => replaying any prefix on top of the last snapshot restores a consistent (earlier) state
+    std::string takeJournalDelta()
+    {
+        std::string delta;
+        delta.swap(journal_.ref());
+        return delta;
+    }
+
+    void replayJournalDelta(const std::string_view delta) //throw SysError
+    {
+        journalChanges_ = false;
+        ZEN_ON_SCOPE_EXIT(journalChanges_ = true);
+
+        MemoryStreamIn stream(delta);
+        while (stream.pos() < delta.size())
+            switch (const JournalRecordType recType = readNumber<JournalRecordType>(stream)) //throw SysErrorUnexpectedEos
+            {
+                case JournalRecordType::itemUpdated:
+                {
+                    const std::string itemId = readContainer<std::string>(stream); //throw SysErrorUnexpectedEos
+                    const GdriveItemDetails details = readItemDetails(stream);    //
+                    updateItemState(itemId, &details);
+                }
+                break;
+
+                case JournalRecordType::itemDeleted:
+                    updateItemState(readContainer<std::string>(stream), nullptr); //throw SysErrorUnexpectedEos
+                    break;
+
+                case JournalRecordType::folderKnown:
+                    folderContents_[readContainer<std::string>(stream)].isKnownFolder = true; //throw SysErrorUnexpectedEos
+                    break;
+
+                case JournalRecordType::syncToken:
+                    lastSyncToken_ = readContainer<std::string>(stream); //throw SysErrorUnexpectedEos
+                    break;
+
+                default:
+                    throw SysError(_("File content is corrupted.") + L" (invalid journal record: " + numberTo<std::wstring>(static_cast<int>(recType)) + L')');
+            }
+    }
+
     struct PathStatus
     {
         std::string existingItemId;
@@ -2053,7 +2355,13 @@ public:
 
     void notifyFolderContent(const FileStateDelta& stateDelta, const std::string& folderId, const std::vector<GdriveItem>& childItems)
     {
-        folderContents_[folderId].isKnownFolder = true;
+        if (bool& isKnownFolder = folderContents_[folderId].isKnownFolder;
+            !isKnownFolder)
+        {
+            isKnownFolder = true;
+            writeNumber(journal_, JournalRecordType::folderKnown);
+            writeContainer(journal_, folderId);
+        }
 
         for (const GdriveItem& item : childItems)
             notifyItemUpdated(stateDelta, item.itemId, &item.details);
@@ -2185,6 +2493,9 @@ private:
         lastSyncToken_ = delta.newStartPageToken;
         lastSyncTime_ = std::chrono::steady_clock::now();
 
+        writeNumber(journal_, JournalRecordType::syncToken);
+        writeContainer(journal_, lastSyncToken_);
+
         //good to know: if item is created and deleted between polling for changes it is still reported as deleted by Google!
         //Same goes for any other change that is undone in between change notification syncs.
     }
@@ -2277,6 +2588,20 @@ private:
             if (!details || *details == it->second) //notified changes match our current file state
                 return; //=> avoid misleading changeLog_ entries after Google Drive sync!!!
 
+        if (journalChanges_)
+        {
+            if (details)
+            {
+                writeNumber(journal_, JournalRecordType::itemUpdated);
+                writeItem(journal_, itemId, *details);
+            }
+            else
+            {
+                writeNumber(journal_, JournalRecordType::itemDeleted);
+                writeContainer(journal_, itemId);
+            }
+        }
+
         //update change logs (and clean up obsolete entries)
         std::erase_if(changeLog_, [&](std::weak_ptr<ItemIdDelta>& weakPtr)
         {
@@ -2345,6 +2670,46 @@ private:
         }
     }
 
+    static void writeItem(MemoryStreamOut& stream, const std::string& itemId, const GdriveItemDetails& details)
+    {
+        writeContainer             (stream, itemId);
+        writeContainer             (stream, utfTo<std::string>(details.itemName));
+        writeNumber<GdriveItemType>(stream, details.type);
+        writeNumber     <FileOwner>(stream, details.owner);
+        writeNumber      <uint64_t>(stream, details.fileSize);
+        writeNumber       <int64_t>(stream, details.modTime);
+        static_assert(sizeof(details.modTime) <= sizeof(int64_t)); //ensure cross-platform compatibility!
+        writeContainer(stream, details.targetId);
+
+        writeNumber(stream, static_cast<uint32_t>(details.parentIds.size()));
+        for (const std::string& parentId : details.parentIds)
+            writeContainer(stream, parentId);
+    }
+
+    static GdriveItemDetails readItemDetails(MemoryStreamIn& stream) //throw SysErrorUnexpectedEos
+    {
+        GdriveItemDetails details = {}; //read in correct sequence!
+        details.itemName = utfTo<Zstring>(readContainer<std::string>(stream)); //
+        details.type     = readNumber<GdriveItemType>(stream); //
+        details.owner    = readNumber     <FileOwner>(stream); //
+        details.fileSize = readNumber      <uint64_t>(stream); //SysErrorUnexpectedEos
+        details.modTime  = readNumber       <int64_t>(stream); //
+        details.targetId = readContainer<std::string>(stream); //
+
+        size_t parentsCount = readNumber<uint32_t>(stream); //SysErrorUnexpectedEos
+        while (parentsCount-- != 0)
+            details.parentIds.push_back(readContainer<std::string>(stream)); //SysErrorUnexpectedEos
+        return details;
+    }
+
+    enum class JournalRecordType : unsigned char
+    {
+        itemUpdated = 1,
+        itemDeleted,
+        folderKnown,
+        syncToken,
+    };
+
     using DetailsIterator = std::unordered_map<std::string, GdriveItemDetails>::iterator;
 
     struct FolderContent
@@ -2360,6 +2725,9 @@ private:
 
     std::vector<std::weak_ptr<ItemIdDelta>> changeLog_; //track changed items since FileStateDelta was created (includes sync with Google + our own intermediate change notifications)
 
+    MemoryStreamOut journal_; //file state changes not yet persisted, see GdrivePersistentSessions::flushSession()
+    bool journalChanges_ = true; //false while restoring snapshot + journal
+
     std::string driveId_; //ID of shared drive or "My Drive": never empty!
     Zstring sharedDriveName_; //name of shared drive: empty for "My Drive"!
 
@@ -2425,6 +2793,51 @@ public:
         //starredFolders_? no, will be fully restored by syncWithGoogle()
     }
 
+    //journal delta := sequence of (drive ID, file state delta), terminated by an empty drive ID
+    std::string takeJournalDelta()
+    {
+        MemoryStreamOut stream;
+        auto addDelta = [&](GdriveFileState& fileState)
+        {
+            if (std::string delta = fileState.takeJournalDelta();
+                !delta.empty())
+            {
+                writeContainer(stream, fileState.getDriveId());
+                writeContainer(stream, delta);
+            }
+        };
+        addDelta(myDrive_);
+        for (auto& [driveId, fileState] : sharedDrives_)
+            addDelta(fileState.ref());
+
+        if (!stream.ref().empty())
+            writeContainer(stream, std::string()); //sentinel
+        return std::move(stream.ref());
+    }
+
+    void replayJournalDelta(MemoryStreamIn& stream) //throw SysError
+    {
+        for (;;)
+        {
+            const std::string driveId = readContainer<std::string>(stream); //SysErrorUnexpectedEos
+            if (driveId.empty())
+                break;
+
+            const std::string delta = readContainer<std::string>(stream); //SysErrorUnexpectedEos
+
+            if (driveId == myDrive_.getDriveId())
+                myDrive_.replayJournalDelta(delta); //throw SysError
+            else if (auto it = sharedDrives_.find(driveId);
+                     it != sharedDrives_.end())
+                it->second.ref().replayJournalDelta(delta); //throw SysError
+            //else: shared drive added after last snapshot => fine: snapshot is due, see syncWithGoogle()
+        }
+    }
+
+    //changes that can't be expressed by the journal, e.g. shared drives added/removed
+    bool snapshotIsDue() const { return snapshotDue_; }
+    void resetSnapshotDue() { snapshotDue_ = false; }
+
     std::vector<Zstring /*locationName*/> listLocations() //throw SysError
     {
         if (syncIsDue())
@@ -2499,6 +2912,9 @@ private:
         }
 
         starredFolders_ = ftStarredFolders.get(); //throw SysError //
+        if (currentDrives.size() != sharedDrives_.size() ||
+            std::any_of(currentDrives.begin(), currentDrives.end(), [&](const auto& item) { return !sharedDrives_.contains(item.first); }))
+            snapshotDue_ = true;
         sharedDrives_.swap(currentDrives);                         //transaction!
         lastSyncTime_ = std::chrono::steady_clock::now(); //...(uhm, mostly, except for setSharedDriveName())
     }
@@ -2553,6 +2969,8 @@ private:
     std::unordered_map<std::string /*drive ID*/, SharedRef<GdriveFileState>> sharedDrives_;
 
     std::vector<StarredFolderDetails> starredFolders_;
+
+    bool snapshotDue_ = false;
 };
 
 //==========================================================================================
@@ -2566,6 +2984,7 @@ public:
         onSystemShutdownRegister(onBeforeSystemShutdownCookie_);
     }
 
+    //perf: usually only the journal needs to be appended, see flushSession()
     void saveActiveSessions() //throw FileError
     {
         std::vector<Protected<SessionHolder>*> protectedSessions; //pointers remain stable, thanks to std::unordered_map<>
@@ -2575,28 +2994,18 @@ public:
                 protectedSessions.push_back(&protectedSession);
         });
 
-        if (!protectedSessions.empty())
-        {
-            createDirectoryIfMissingRecursion(configDirPath_); //throw FileError
-
-            std::exception_ptr firstError;
+        std::exception_ptr firstError;
 
-            //access each session outside the globalSessions_ lock!
-            for (Protected<SessionHolder>* protectedSession : protectedSessions)
-                protectedSession->access([&](SessionHolder& holder)
+        //access each session outside the globalSessions_ lock!
+        for (Protected<SessionHolder>* protectedSession : protectedSessions)
+            try
             {
-                if (holder.session)
-                    try
-                    {
-                        const Zstring dbFilePath = getDbFilePath(holder.session->accessBuf.ref().getUserEmail());
-                        saveSession(dbFilePath, *holder.session); //throw FileError
-                    }
-                    catch (FileError&) { if (!firstError) firstError = std::current_exception(); }
-            });
+                flushSession(*protectedSession); //throw FileError
+            }
+            catch (FileError&) { if (!firstError) firstError = std::current_exception(); }
 
-            if (firstError)
-                std::rethrow_exception(firstError); //throw FileError
-        }
+        if (firstError)
+            std::rethrow_exception(firstError); //throw FileError
     }
 
     std::string addUserSession(const std::string& gdriveLoginHint, const std::function<void()>& updateGui /*throw X*/, int timeoutSec) //throw SysError, X
@@ -2606,14 +3015,17 @@ public:
         accessUserSession(accessInfo.userInfo.email, timeoutSec, [&](std::optional<UserSession>& userSession) //throw SysError
         {
             if (userSession)
+            {
                 userSession->accessBuf.ref().update(accessInfo); //redundant?
+                userSession->dbStatus.snapshotDue = true; //access info is not part of the journal
+            }
             else
             {
                 const std::shared_ptr<int> timeoutSec2 = std::make_shared<int>(timeoutSec); //context option: valid only for duration of this call!
                 auto accessBuf = makeSharedRef<GdriveAccessBuffer>(accessInfo);
                 accessBuf.ref().setContextTimeout(timeoutSec2); //[!] used by GdriveDrivesBuffer()!
                 auto drivesBuf = makeSharedRef<GdriveDrivesBuffer>(accessBuf.ref()); //throw SysError
-                userSession = {accessBuf, drivesBuf};
+                userSession = {accessBuf, drivesBuf, {.snapshotDue = true}};
             }
         });
 
@@ -2633,19 +3045,21 @@ public:
         catch ([[maybe_unused]] const SysError& e) { assert(false); } //best effort: try to invalidate the access token
         //=> expected to fail 1. if offline => not worse than removing FFS via "Uninstall Programs" 2. already revoked 3. if DB is corrupted
 
+        std::lock_guard dummy(lockDbFiles_); //don't let flushSession() recreate the DB files
+
         try
         {
-            //start with deleting the DB file (1. maybe it's corrupted? 2. skip unnecessary lazy-load)
-            const Zstring dbFilePath = getDbFilePath(accountEmail);
-            try
-            {
-                removeFilePlain(dbFilePath); //throw FileError
-            }
-            catch (FileError&)
-            {
-                if (itemExists(dbFilePath)) //throw FileError
-                    throw;
-            }
+            //start with deleting the DB files (1. maybe corrupted? 2. skip unnecessary lazy-load)
+            for (const Zstring& filePath : {getDbFilePath(accountEmail), getJournalFilePath(accountEmail)})
+                try
+                {
+                    removeFilePlain(filePath); //throw FileError
+                }
+                catch (FileError&)
+                {
+                    if (itemExists(filePath)) //throw FileError
+                        throw;
+                }
         }
         catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //file access errors should be further enriched by context info => SysError
 
@@ -2741,6 +3155,8 @@ private:
     GdrivePersistentSessions& operator=(const GdrivePersistentSessions&) = delete;
 
     struct UserSession;
+    struct SessionHolder;
+    struct DbFileStatus;
 
     Zstring getDbFilePath(const std::string& accountEmail) const
     {
@@ -2748,17 +3164,22 @@ private:
         return appendPath(configDirPath_, utfTo<Zstring>(getAsciiLowerCase(accountEmail)) + Zstr(".db"));
     }
 
+    //don't end with ".db": see listAccounts()
+    Zstring getJournalFilePath(const std::string& accountEmail) const { return getDbFilePath(accountEmail) + Zstr(".journal"); }
+
     void accessUserSession(const std::string& accountEmail, int timeoutSec, const std::function<void(std::optional<UserSession>& userSession)>& useSession /*throw X*/) //throw SysError, X
     {
         Protected<SessionHolder>* protectedSession = nullptr; //pointers remain stable, thanks to std::unordered_map<>
         globalSessions_.access([&](GlobalSessions& sessions) { protectedSession = &sessions[accountEmail]; });
 
+        startJournalWriter();
+
         protectedSession->access([&](SessionHolder& holder)
         {
             if (!holder.dbWasLoaded) //let's NOT load the DB files under the globalSessions_ lock, but the session-specific one!
                 try
                 {
-                    holder.session = loadSession(getDbFilePath(accountEmail), timeoutSec); //throw SysError
+                    holder.session = loadSession(getDbFilePath(accountEmail), getJournalFilePath(accountEmail), timeoutSec); //throw FileError
                 }
                 catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //GdrivePersistentSessions errors should be further enriched with context info => SysError
             holder.dbWasLoaded = true;
@@ -2771,26 +3192,187 @@ private:
         });
     }
 
-    static void saveSession(const Zstring& dbFilePath, const UserSession& userSession) //throw FileError
+    /*  DB file layout:  <email>.db         := header + journal generation + compressed snapshot of the full file state
+                         <email>.db.journal := header + journal generation + sequence of [block size, CRC32, compressed journal delta]
+
+        - file state changes are appended to the journal in the background => fast shutdown + little data loss on crash/kill
+        - journal is valid only if its generation matches the snapshot's => snapshot rewrite ("compaction") implicitly discards the old journal
+        - incomplete trailing journal block (e.g. crash during write) is detected via block size/CRC32 and ignored           */
+    void flushSession(Protected<SessionHolder>& protectedSession) //throw FileError
+    {
+        std::lock_guard dummy(lockDbFiles_); //serialize DB file writes => keep journal blocks in order!
+
+        Zstring dbFilePath;
+        Zstring journalFilePath;
+        DbFileStatus dbStatus;
+        bool writeSnapshot = false;
+        MemoryStreamOut streamOutBody;
+        std::string journalDelta;
+
+        protectedSession.access([&](SessionHolder& holder)
+        {
+            if (holder.session)
+            {
+                UserSession& userSession = *holder.session;
+                const std::string& accountEmail = userSession.accessBuf.ref().getUserEmail();
+                dbFilePath      = getDbFilePath     (accountEmail);
+                journalFilePath = getJournalFilePath(accountEmail);
+
+                writeSnapshot = userSession.dbStatus.snapshotDue || userSession.drivesBuf.ref().snapshotIsDue() ||
+                                userSession.dbStatus.journalSize > std::max(userSession.dbStatus.snapshotSize, GDRIVE_JOURNAL_COMPACT_MIN_SIZE);
+                if (writeSnapshot)
+                {
+                    //serialize inside the session lock, but compress + write outside!
+                    userSession.accessBuf.ref().serialize(streamOutBody);
+                    userSession.drivesBuf.ref().serialize(streamOutBody);
+                    userSession.drivesBuf.ref().takeJournalDelta(); //=> included in snapshot
+                    userSession.drivesBuf.ref().resetSnapshotDue();
+                    ++userSession.dbStatus.generation;
+                    userSession.dbStatus.journalSize = 0;
+                    userSession.dbStatus.snapshotDue = false;
+                }
+                else
+                    journalDelta = userSession.drivesBuf.ref().takeJournalDelta();
+
+                dbStatus = userSession.dbStatus;
+            }
+        });
+
+        if (!writeSnapshot && journalDelta.empty())
+            return;
+
+        auto updateDbStatus = [&](const DbFileStatus& dbStatusNew)
+        {
+            protectedSession.access([&](SessionHolder& holder)
+            {
+                if (holder.session && holder.session->dbStatus.generation == dbStatusNew.generation)
+                {
+                    const bool snapshotDue = holder.session->dbStatus.snapshotDue; //requested in the meantime?
+                    holder.session->dbStatus = dbStatusNew;
+                    holder.session->dbStatus.snapshotDue |= snapshotDue;
+                }
+            });
+        };
+        //changes are lost from memory: make sure they're not lost on disk either => rewrite full state next time
+        ZEN_ON_SCOPE_FAIL(updateDbStatus({.generation = dbStatus.generation, .snapshotDue = true}));
+
+        createDirectoryIfMissingRecursion(configDirPath_); //throw FileError
+
+        if (writeSnapshot)
+        {
+            dbStatus.snapshotSize = saveSnapshot(dbFilePath, streamOutBody.ref(), dbStatus.generation); //throw FileError
+
+            setFileContent(journalFilePath, getJournalHeader(dbStatus.generation), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            dbStatus.journalSize = getJournalHeader(dbStatus.generation).size();
+        }
+        else
+        {
+            std::string journalBlock;
+            try
+            {
+                journalBlock = compress(journalDelta, 3 /*best compression level: see db_file.cpp*/); //throw SysError
+            }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(journalFilePath)), e.toString()); }
+
+            if (dbStatus.journalSize == 0) //(re-)create journal
+            {
+                setFileContent(journalFilePath, getJournalHeader(dbStatus.generation), nullptr /*notifyUnbufferedIO*/); //throw FileError
+                dbStatus.journalSize = getJournalHeader(dbStatus.generation).size();
+            }
+
+            MemoryStreamOut streamOut;
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(journalBlock.size()));
+            writeNumber<uint32_t>(streamOut, getCrc32(journalBlock));
+            writeArray(streamOut, journalBlock.data(), journalBlock.size());
+
+            appendFileContent(journalFilePath, streamOut.ref()); //throw FileError
+            dbStatus.journalSize += streamOut.ref().size();
+        }
+
+        updateDbStatus(dbStatus);
+    }
+
+    static std::string getJournalHeader(uint64_t generation)
     {
         MemoryStreamOut streamOut;
         writeArray(streamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
-        writeNumber<int32_t>(streamOut, DB_FILE_VERSION);
+        writeNumber<int32_t>(streamOut, DB_JOURNAL_VERSION);
+        writeNumber<uint64_t>(streamOut, generation);
+        return std::move(streamOut.ref());
+    }
 
-        MemoryStreamOut streamOutBody;
-        userSession.accessBuf.ref().serialize(streamOutBody);
-        userSession.drivesBuf.ref().serialize(streamOutBody);
+    static uint64_t saveSnapshot(const Zstring& dbFilePath, const std::string& streamBody, uint64_t generation) //throw FileError
+    {
+        MemoryStreamOut streamOut;
+        writeArray(streamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
+        writeNumber<int32_t>(streamOut, DB_FILE_VERSION);
+        writeNumber<uint64_t>(streamOut, generation);
 
         try
         {
-            streamOut.ref() += compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/); //throw SysError
+            streamOut.ref() += compress(streamBody, 3 /*best compression level: see db_file.cpp*/); //throw SysError
         }
         catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath)), e.toString()); }
 
         setFileContent(dbFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        return streamOut.ref().size();
     }
 
-    static std::optional<UserSession> loadSession(const Zstring& dbFilePath, int timeoutSec) //throw FileError
+    //replay all complete journal blocks; return false if journal is not usable (anymore), e.g. missing, incomplete block, generation mismatch
+    static bool replayJournal(const Zstring& journalFilePath, uint64_t generation, GdriveDrivesBuffer& drivesBuf, uint64_t& journalSize) //throw FileError
+    {
+        std::string byteStream;
+        try
+        {
+            byteStream = getFileContent(journalFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (FileError&)
+        {
+            if (itemExists(journalFilePath)) //throw FileError
+                throw;
+            return false; //=> journal will be created
+        }
+
+        try
+        {
+            const std::string& journalHeader = getJournalHeader(generation);
+            if (!startsWith(byteStream, journalHeader))
+                return false; //e.g. stale journal from before last snapshot => discard
+
+            size_t pos = journalHeader.size();
+
+            while (pos < byteStream.size())
+            {
+                if (byteStream.size() - pos < 2 * sizeof(uint32_t))
+                    return false;
+
+                MemoryStreamIn streamBlockHeader(std::string_view(byteStream).substr(pos, 2 * sizeof(uint32_t)));
+                const size_t   blockSize = readNumber<uint32_t>(streamBlockHeader); //throw SysErrorUnexpectedEos
+                const uint32_t blockCrc  = readNumber<uint32_t>(streamBlockHeader); //
+                pos += 2 * sizeof(uint32_t);
+
+                if (byteStream.size() - pos < blockSize)
+                    return false;
+
+                const std::string_view journalBlock = std::string_view(byteStream).substr(pos, blockSize);
+                if (getCrc32(journalBlock) != blockCrc)
+                    return false;
+                pos += blockSize;
+
+                const std::string& journalDelta = decompress(journalBlock); //throw SysError
+                MemoryStreamIn streamInDelta(journalDelta);
+                drivesBuf.replayJournalDelta(streamInDelta); //throw SysError
+                journalSize = pos;
+            }
+            return true;
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(journalFilePath)), e.toString());
+        }
+    }
+
+    static std::optional<UserSession> loadSession(const Zstring& dbFilePath, const Zstring& journalFilePath, int timeoutSec) //throw FileError
     {
         std::string byteStream;
         try
@@ -2838,7 +3420,7 @@ private:
                 auto accessBuf = makeSharedRef<GdriveAccessBuffer>(streamIn2); //throw SysError
                 accessBuf.ref().setContextTimeout(timeoutSec2); //not used by GdriveDrivesBuffer(), but let's be consistent
                 auto drivesBuf = makeSharedRef<GdriveDrivesBuffer>(accessBuf.ref()); //throw SysError
-                return UserSession{accessBuf, drivesBuf};
+                return UserSession{accessBuf, drivesBuf, {.snapshotDue = true}};
             }
             else
             {
@@ -2846,10 +3428,15 @@ private:
                     throw SysError(_("File content is corrupted.") + L" (invalid header)");
 
                 const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
-                if (version != 4 &&
+                if (version != 4 && //TODO: remove migration code at some time! 2021-05-15
+                    version != 5 && //TODO: remove migration code at some time! 2026-10-18
                     version != DB_FILE_VERSION)
                     throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
 
+                DbFileStatus dbStatus{.snapshotSize = byteStream.size()};
+                if (version >= 6)
+                    dbStatus.generation = readNumber<uint64_t>(streamIn); //throw SysErrorUnexpectedEos
+
                 const std::string& uncompressedStream = decompress({byteStream.begin() + streamIn.pos(), byteStream.end()}); //throw SysError
                 MemoryStreamIn streamInBody(uncompressedStream);
 
@@ -2864,7 +3451,11 @@ private:
                         return makeSharedRef<GdriveDrivesBuffer>(streamInBody, accessBuf.ref()); //throw SysError
                 }();
 
-                return UserSession{accessBuf, drivesBuf};
+                if (version <= 4 ||
+                    !replayJournal(journalFilePath, dbStatus.generation, drivesBuf.ref(), dbStatus.journalSize)) //throw FileError
+                    dbStatus.snapshotDue = true; //start a new journal on top of a fresh snapshot
+
+                return UserSession{accessBuf, drivesBuf, dbStatus};
             }
         }
         catch (const SysError& e)
@@ -2873,10 +3464,19 @@ private:
         }
     }
 
+    struct DbFileStatus
+    {
+        uint64_t generation   = 0; //snapshot and journal belong together only if generations match
+        uint64_t snapshotSize = 0; //[byte]
+        uint64_t journalSize  = 0; //[byte] 0 if journal needs to be (re-)created
+        bool snapshotDue = false;
+    };
+
     struct UserSession
     {
         SharedRef<GdriveAccessBuffer> accessBuf;
         SharedRef<GdriveDrivesBuffer> drivesBuf;
+        DbFileStatus dbStatus;
     };
 
     struct SessionHolder
@@ -2886,15 +3486,47 @@ private:
     };
     using GlobalSessions = std::unordered_map<std::string /*Google account email*/, Protected<SessionHolder>, StringHashAsciiNoCase, StringEqualAsciiNoCase>;
 
+    //write journal in the background => don't lose much on crash/kill, and keep shutdown fast
+    void startJournalWriter()
+    {
+        std::call_once(onceStartJournalWriter_, [this]
+        {
+            journalWriter_ = InterruptibleThread([this]
+            {
+                setCurrentThreadName(Zstr("Journal Writer[Google Drive]"));
+
+                std::wstring lastErrorMsg;
+                for (;;)
+                {
+                    interruptibleSleep(GDRIVE_JOURNAL_FLUSH_INTERVAL); //throw ThreadStopRequest
+                    try
+                    {
+                        saveActiveSessions(); //throw FileError
+                    }
+                    catch (const FileError& e)
+                    {
+                        if (e.toString() != lastErrorMsg) //don't spam the error log
+                            logExtraError(lastErrorMsg = e.toString());
+                    }
+                }
+            });
+        });
+    }
+
     Protected<GlobalSessions> globalSessions_;
     const Zstring configDirPath_;
 
+    std::mutex lockDbFiles_;
+
     const SharedRef<std::function<void()>> onBeforeSystemShutdownCookie_ = makeSharedRef<std::function<void()>>([this]
     {
         try //let's not lose Google Drive data due to unexpected system shutdown:
         { saveActiveSessions(); } //throw FileError
         catch (const FileError& e) { logExtraError(e.toString()); }
     });
+
+    std::once_flag onceStartJournalWriter_;
+    InterruptibleThread journalWriter_; //declare last: stop before other members are destroyed!
 };
 //==========================================================================================
 constinit Global<GdrivePersistentSessions> globalGdriveSessions;
@@ -3166,6 +3798,8 @@ struct InputStreamGdrive : public AFS::InputStream
         return std::move(attr); //[!]
     }
 
+    bool hasReadAhead() const override { return true; }
+
 private:
     void reportBytesProcessed(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw X
     {
@@ -3893,6 +4527,8 @@ private:
     }
 
     bool hasNativeTransactionalCopy() const override { return true; }
+
+    bool hasSlowItemAccess() const override { return true; } //file state is buffered, but unknown folders still need a server round-trip
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& folderPath) const override //throw FileError, returns < 0 if not available
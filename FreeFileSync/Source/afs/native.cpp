@@ -14,6 +14,7 @@
 #include <zen/thread.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/globals.h>
 #include "abstract_impl.h"
 #include "../base/icon_loader.h"
 
@@ -74,6 +75,64 @@ AFS::FingerPrint getFileFingerprint(FileIndex fileIndex)
 }
 
 
+//block size tuning per physical device: all native paths share the same device root "/"
+using MountPointBuffer = std::unordered_map<dev_t, Zstring /*mount point path*/>;
+
+constinit Global<Protected<MountPointBuffer>> globalMountPointBuffer;
+GLOBAL_RUN_ONCE(globalMountPointBuffer.set(std::make_unique<Protected<MountPointBuffer>>()));
+
+
+//mount point instead of st_dev: stable across runs
+Zstring getMountPointPath(const Zstring& itemPath) //throw FileError
+{
+    try
+    {
+        //item need not exist yet (e.g. copy target)
+        Zstring existingPath = itemPath;
+        for (struct stat itemInfo = {}; ::stat(existingPath.c_str(), &itemInfo) != 0;)
+            if (const std::optional<Zstring> parentPath = getParentFolderPath(existingPath))
+                existingPath = *parentPath;
+            else
+                THROW_LAST_SYS_ERROR("stat");
+
+        existingPath = getSymlinkResolvedPath(existingPath); //throw FileError; => parent folders are on the same device or a different mount
+
+        struct stat existingInfo = {};
+        if (::stat(existingPath.c_str(), &existingInfo) != 0)
+            THROW_LAST_SYS_ERROR("stat");
+
+        const std::shared_ptr<Protected<MountPointBuffer>> mountPointBuf = globalMountPointBuffer.get();
+
+        std::optional<Zstring> mountPath;
+        if (mountPointBuf)
+            mountPointBuf->access([&](const MountPointBuffer& buf)
+        {
+            if (auto it = buf.find(existingInfo.st_dev);
+                it != buf.end())
+                mountPath = it->second;
+        });
+
+        if (!mountPath)
+        {
+            mountPath = existingPath;
+            while (const std::optional<Zstring> parentPath = getParentFolderPath(*mountPath))
+            {
+                struct stat parentInfo = {};
+                if (::stat(parentPath->c_str(), &parentInfo) != 0 ||
+                    parentInfo.st_dev != existingInfo.st_dev)
+                    break;
+                mountPath = *parentPath;
+            }
+
+            if (mountPointBuf)
+                mountPointBuf->access([&](MountPointBuffer& buf) { buf.emplace(existingInfo.st_dev, *mountPath); });
+        }
+        return *mountPath;
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(itemPath)), e.toString()); }
+}
+
+
 struct NativeFileInfo
 {
     FileTimeNative modTime;
@@ -422,6 +481,15 @@ private:
 
     std::wstring getDisplayPath(const AfsPath& itemPath) const override { return utfTo<std::wstring>(getNativePath(itemPath)); }
 
+    Zstring getBlockSizeTuningKey(const AfsPath& itemPath) const override
+    {
+        try
+        {
+            return getMountPointPath(getNativePath(itemPath)); //throw FileError
+        }
+        catch (FileError&) { return rootPath_; } //access errors are reported by the actual I/O
+    }
+
     bool isNullFileSystem() const override { return rootPath_.empty(); }
 
     std::weak_ordering compareDeviceSameAfsType(const AbstractFileSystem& afsRhs) const override
@@ -565,7 +633,17 @@ private:
 
         initComForThread(); //throw FileError
 
-        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(sourcePath), nativePathTarget, notifyUnbufferedIO); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+        const TunedBlockSize blockSizeIn  = getTunedBlockSize(sourcePath, sourceAttr.fileSize);
+        const TunedBlockSize blockSizeOut = AFS::getTunedBlockSize(targetPath, sourceAttr.fileSize);
+
+        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(sourcePath), nativePathTarget, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                                                             blockSizeIn.factor, blockSizeOut.factor, notifyUnbufferedIO);
+
+        if (!nativeResult.copiedInChunks) //block size factors not used
+        {
+            reportThroughput(blockSizeIn,  nativeResult.fileSize, nativeResult.readTime);
+            reportThroughput(blockSizeOut, nativeResult.fileSize, nativeResult.writeTime);
+        }
 
         //at this point we know we created a new file, so it's fine to delete it for cleanup!
         ZEN_ON_SCOPE_FAIL(try { zen::removeFilePlain(nativePathTarget); }
@@ -580,6 +658,7 @@ private:
         result.modTime = nativeFileTimeToTimeT(nativeResult.sourceModTime);
         result.sourceFilePrint = getFileFingerprint(nativeResult.sourceFileIdx);
         result.targetFilePrint = getFileFingerprint(nativeResult.targetFileIdx);
+        result.contentHash = nativeResult.contentHash;
         result.errorModTime = nativeResult.errorModTime;
         return result;
     }
@@ -669,6 +748,8 @@ private:
     }
 
     bool hasNativeTransactionalCopy() const override { return false; }
+
+    bool hasSlowItemAccess() const override { return false; }
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& folderPath) const override //throw FileError, returns < 0 if not available
@@ -10,6 +10,8 @@
 #include <zen/thread.h>
 #include <zen/globals.h>
 #include <zen/file_io.h>
+#include <zen/file_access.h>
+#include <zen/serialize.h>
 #include <zen/socket.h>
 #include <zen/open_ssl.h>
 #include <zen/resolve_path.h>
@@ -53,6 +55,12 @@ constexpr std::chrono::seconds SFTP_SESSION_MAX_IDLE_TIME           (20);
 constexpr std::chrono::seconds SFTP_SESSION_CLEANUP_INTERVAL         (4); //facilitate default of 5-seconds delay for error retry
 constexpr std::chrono::seconds SFTP_CHANNEL_LIMIT_DETECTION_TIME_OUT(30);
 
+const size_t SFTP_PREWARM_SESSIONS_MAX = 20; //don't trust an excessive peak count from a previous run
+constexpr std::chrono::days SFTP_SESSION_LIMIT_MAX_AGE(7); //connection failures might have been temporary network issues => probe again
+
+const char SFTP_STATS_FILE_DESCR[] = "FreeFileSync";
+const int  SFTP_STATS_FILE_VERSION = 1; //2026-10-18
+
 //permissions for new files: rw- rw- rw- [0666] => consider umask! (e.g. 0022 for ffs.org)
 const long SFTP_DEFAULT_PERMISSION_FILE = LIBSSH2_SFTP_S_IRUSR | LIBSSH2_SFTP_S_IWUSR |
                                           LIBSSH2_SFTP_S_IRGRP | LIBSSH2_SFTP_S_IWGRP |
@@ -737,7 +745,14 @@ class SftpSessionManager //reuse (healthy) SFTP sessions globally
     struct SshSessionCache;
 
 public:
-    SftpSessionManager() {}
+    explicit SftpSessionManager(const Zstring& serverStatsFilePath) : serverStatsFilePath_(serverStatsFilePath)
+    {
+        try
+        {
+            loadServerStats(); //throw FileError
+        }
+        catch (const FileError& e) { logExtraError(e.toString()); } //not critical: just start without pre-warming
+    }
 
     struct ReUseOnDelete
     {
@@ -858,6 +873,7 @@ public:
                     std::unique_ptr<SshSession, ReUseOnDelete> sshSession(cache.idleSshSessions.back().release());
                     /**/                                                  cache.idleSshSessions.pop_back();
                     sharedSessionWeak = sharedSession = std::make_shared<SshSessionShared>(std::move(sshSession), login.timeoutSec); //still holding lock => constructor must be *fast*!
+                    markSessionInUse(cache);
                 }
             if (!sharedSession)
                 sessionCfg = *cache.activeCfg;
@@ -874,6 +890,7 @@ public:
             {
                 if (sharedSession->getSessionCfg() == *cache.activeCfg) //created outside the lock => check *again*
                     cache.sshSessionsWithThreadAffinity[threadId] = sharedSession;
+                markSessionInUse(cache); //even if incompatible: still counts towards the server's connection limit until deleted by ReUseOnDelete()
             });
         }
 
@@ -898,6 +915,7 @@ public:
             {
                 sshSession.reset(cache.idleSshSessions.back().release());
                 /**/             cache.idleSshSessions.pop_back();
+                markSessionInUse(cache);
             }
             else
                 sessionCfg = *cache.activeCfg;
@@ -907,7 +925,10 @@ public:
 
         //create new SFTP session outside the lock: 1. don't block other threads 2. non-atomic regarding "sessionCache"! => one session too many is not a problem!
         if (!sshSession)
+        {
             sshSession.reset(new SshSession(*sessionCfg, login.timeoutSec)); //throw SysError, SysErrorPassword
+            getSessionCache(login).access([&](SshSessionCache& cache) { markSessionInUse(cache); });
+        }
 
         return std::make_unique<SshSessionExclusive>(std::move(sshSession), login.timeoutSec);
     }
@@ -926,6 +947,89 @@ public:
         });
     }
 
+    /* AFS::authenticateAccess() is called once per device before traversal/sync: connect the number of sessions seen in use
+       during the previous run in parallel now, instead of serially on first use: SSH handshake + authentication easily
+       take a few hundred milliseconds each, usually followed by the opening of an SFTP channel, all of which block the caller */
+    void prewarmSessions(const SftpLogin& login)
+    {
+        size_t sessionCount = 0;
+        std::optional<SshSessionCfg> sessionCfg;
+
+        getSessionCache(login).access([&](SshSessionCache& cache)
+        {
+            if (!cache.activeCfg || cache.prewarmPending)
+                return;
+
+            size_t sessionsTarget = std::min(cache.serverStats.sessionsPeak, SFTP_PREWARM_SESSIONS_MAX);
+            if (cache.serverStats.sessionsMax > 0) //server limit detected during previous run
+                sessionsTarget = std::min(sessionsTarget, cache.serverStats.sessionsMax);
+
+            const size_t sessionsAvailable = cache.sessionsInUse + cache.idleSshSessions.size();
+            if (sessionsTarget > sessionsAvailable)
+            {
+                sessionCount = sessionsTarget - sessionsAvailable;
+                sessionCfg = *cache.activeCfg;
+                cache.prewarmPending = true;
+            }
+        });
+
+        if (sessionCount > 0)
+        {
+            startSessionPrewarming();
+            {
+                std::lock_guard dummy(lockPrewarm_);
+                prewarmQueue_.push_back({*sessionCfg, sessionCount, login.timeoutSec});
+            }
+            conditionNewPrewarm_.notify_all();
+        }
+    }
+
+    void saveServerStats() //throw FileError
+    {
+        std::vector<std::pair<SshDeviceId, SshServerStats>> serverStats;
+
+        std::vector<std::pair<const SshDeviceId*, Protected<SshSessionCache>*>> sessionCaches; //pointers remain stable, thanks to std::map<>
+        globalSessionCache_.access([&](GlobalSshSessions& sessionsById)
+        {
+            for (auto& [deviceId, sessionCache] : sessionsById)
+                sessionCaches.emplace_back(&deviceId, &sessionCache);
+        });
+
+        for (const auto& [deviceId, sessionCache] : sessionCaches)
+            sessionCache->access([&](const SshSessionCache& cache)
+        {
+            SshServerStats stats = cache.serverStats;
+            if (cache.sessionsInUsePeak > 0) //=> device was used during this run: replace old peak
+                stats.sessionsPeak = cache.sessionsInUsePeak;
+
+            if (stats.sessionsMax > 0 && cache.sessionsInUsePeak > stats.sessionsMax) //regular use exceeded the limit => wasn't a hard server limit
+                stats.sessionsMax = 0;
+
+            if (stats.sessionsPeak > 1 || stats.sessionsMax > 0) //nothing to pre-warm for a single session
+                serverStats.emplace_back(*deviceId, stats);
+        });
+
+        MemoryStreamOut streamOut;
+        writeArray(streamOut, SFTP_STATS_FILE_DESCR, sizeof(SFTP_STATS_FILE_DESCR));
+        writeNumber<int32_t>(streamOut, SFTP_STATS_FILE_VERSION);
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(serverStats.size()));
+        for (const auto& [deviceId, stats] : serverStats)
+        {
+            writeContainer(streamOut, utfTo<std::string>(deviceId.server));
+            writeNumber<uint16_t>(streamOut, deviceId.port);
+            writeContainer(streamOut, utfTo<std::string>(deviceId.username));
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(stats.sessionsPeak));
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(stats.sessionsMax));
+            writeNumber<int64_t >(streamOut, stats.sessionsMaxTime);
+        }
+
+        if (serverStats.empty() && !itemExists(serverStatsFilePath_)) //throw FileError
+            return; //don't create file for users who never connect to multiple SFTP sessions
+
+        setFileContent(serverStatsFilePath_, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+
 private:
     SftpSessionManager           (const SftpSessionManager&) = delete;
     SftpSessionManager& operator=(const SftpSessionManager&) = delete;
@@ -998,11 +1102,166 @@ private:
         }
     }
 
+    struct SshServerStats
+    {
+        size_t sessionsPeak = 0; //max. number of sessions used concurrently
+        size_t sessionsMax  = 0; //server rejected further connections beyond this count; 0 if unknown
+        time_t sessionsMaxTime = 0; //time of detection: limit expires after SFTP_SESSION_LIMIT_MAX_AGE
+    };
+
+    static void markSessionInUse(SshSessionCache& cache)
+    {
+        ++cache.sessionsInUse;
+        cache.sessionsInUsePeak = std::max(cache.sessionsInUsePeak, cache.sessionsInUse);
+    }
+
+    void loadServerStats() //throw FileError
+    {
+        std::string byteStream;
+        try
+        {
+            byteStream = getFileContent(serverStatsFilePath_, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (FileError&)
+        {
+            if (itemExists(serverStatsFilePath_)) //throw FileError
+                throw;
+            return;
+        }
+
+        try
+        {
+            MemoryStreamIn streamIn(byteStream);
+            //-------- file format header --------
+            char tmp[sizeof(SFTP_STATS_FILE_DESCR)] = {};
+            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+
+            if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(SFTP_STATS_FILE_DESCR)))
+                throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+            const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+            if (version != SFTP_STATS_FILE_VERSION)
+                throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+            const time_t now = std::time(nullptr);
+
+            const size_t serverCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+            for (size_t i = 0; i < serverCount; ++i)
+            {
+                SftpLogin login;
+                login.server   = utfTo<Zstring>(readContainer<std::string>(streamIn)); //
+                login.portCfg  = readNumber<uint16_t>(streamIn);                       //throw SysErrorUnexpectedEos
+                login.username = utfTo<Zstring>(readContainer<std::string>(streamIn)); //
+
+                SshServerStats stats;
+                stats.sessionsPeak = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+                stats.sessionsMax  = readNumber<uint32_t>(streamIn); //
+                stats.sessionsMaxTime = readNumber<int64_t>(streamIn); //
+
+                if (now - stats.sessionsMaxTime > std::chrono::seconds(SFTP_SESSION_LIMIT_MAX_AGE).count()) //expired
+                    stats.sessionsMax = 0;
+
+                getSessionCache(login).access([&](SshSessionCache& cache) { cache.serverStats = stats; });
+            }
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(serverStatsFilePath_)), e.toString());
+        }
+    }
+
+    void startSessionPrewarming()
+    {
+        std::call_once(oncePrewarmerStarted_, [this]
+        {
+            sessionPrewarmer_ = InterruptibleThread([this]
+            {
+                setCurrentThreadName(Zstr("Session Prewarm[SFTP]"));
+                for (;;)
+                {
+                    PrewarmRequest req;
+                    {
+                        std::unique_lock dummy(lockPrewarm_);
+                        interruptibleWait(conditionNewPrewarm_, dummy, [this] { return !prewarmQueue_.empty(); }); //throw ThreadStopRequest
+
+                        req = std::move(prewarmQueue_.front());
+                        prewarmQueue_.erase(prewarmQueue_.begin());
+                    }
+                    createIdleSessions(req); //throw ThreadStopRequest
+                }
+            });
+        });
+    }
+
+    struct PrewarmRequest
+    {
+        std::optional<SshSessionCfg> sessionCfg;
+        size_t sessionCount = 0;
+        int timeoutSec = 0;
+    };
+
+    void createIdleSessions(const PrewarmRequest& req) //throw ThreadStopRequest
+    {
+        Protected<SshSessionCache>& sessionCache = getSessionCache(req.sessionCfg->deviceId);
+        ZEN_ON_SCOPE_EXIT(sessionCache.access([](SshSessionCache& cache) { cache.prewarmPending = false; }));
+
+        //1. connect + authenticate in parallel: these are blocking calls
+        std::vector<std::unique_ptr<SshSession>> sessions(req.sessionCount);
+        std::atomic<size_t> connectErrors{0};
+        {
+            std::vector<InterruptibleThread> worker;
+            for (size_t i = 0; i < req.sessionCount; ++i)
+                worker.emplace_back([&, i]
+            {
+                setCurrentThreadName(Zstr("Session Prewarm[SFTP] ") + numberTo<Zstring>(i));
+                try
+                {
+                    sessions[i] = std::make_unique<SshSession>(*req.sessionCfg, req.timeoutSec); //throw SysError, SysErrorPassword
+                }
+                catch (const SysErrorPassword&) {} //not a connection limit: authentication is left for a regular connection attempt
+                catch (SysError&) { ++connectErrors; }
+            });
+            for (InterruptibleThread& wt : worker)
+                wt.join(); //not interruptible, but bounded by timeoutSec
+        }
+        interruptionPoint(); //throw ThreadStopRequest
+
+        std::erase(sessions, nullptr);
+
+        //2. open one SFTP channel per session: non-blocking => process all sessions in one go
+        if (!sessions.empty())
+            try
+            {
+                std::vector<SshSession*> sshSessions;
+                for (const std::unique_ptr<SshSession>& session : sessions)
+                    sshSessions.push_back(session.get());
+
+                SshSession::addSftpChannel(sshSessions, req.timeoutSec); //throw SysError
+            }
+            catch (SysError&) { sessions.clear(); } //let the regular connection attempt deal with it
+
+        const bool limitDetected = !sessions.empty() && connectErrors > 0;
+
+        sessionCache.access([&](SshSessionCache& cache)
+        {
+            //some connections succeeded, others failed => most likely hit the server's connection limit: don't try exceeding it next time
+            if (limitDetected)
+            {
+                cache.serverStats.sessionsMax     = cache.sessionsInUse + cache.idleSshSessions.size() + sessions.size();
+                cache.serverStats.sessionsMaxTime = std::time(nullptr);
+            }
+
+            if (cache.activeCfg && *req.sessionCfg == *cache.activeCfg) //config may have changed in the meantime
+                for (std::unique_ptr<SshSession>& session : sessions)
+                    cache.idleSshSessions.push_back(std::move(session));
+            sessions.clear(); //run ~SshSession *inside* the lock! => avoid hitting server limits!
+        });
+    }
+
     //run a dedicated clean-up thread => it's unclear when the server let's a connection time out, so we do it preemptively
     void startGlobalSessionCleanUp()
     {
-        static constinit std::once_flag onceStartThread; //=> no "magic static" code gen
-        std::call_once(onceStartThread, [this]
+        std::call_once(onceCleanerStarted_, [this]
         {
             sessionCleaner_ = InterruptibleThread([this]
             {
@@ -1060,12 +1319,27 @@ private:
 
         Zstring sessionPassword;   //user/password
         Zstring sessionPassphrase; //keyfile/passphrase
+
+        size_t sessionsInUse     = 0; //sessions currently extracted from idleSshSessions or newly created
+        size_t sessionsInUsePeak = 0; //during this run
+        SshServerStats serverStats;   //as of previous runs
+        bool prewarmPending = false;
     };
 
     using GlobalSshSessions = std::map<SshDeviceId, Protected<SshSessionCache>>;
     Protected<GlobalSshSessions> globalSessionCache_;
 
+    const Zstring serverStatsFilePath_;
+
+    std::mutex                  lockPrewarm_;
+    std::condition_variable     conditionNewPrewarm_;
+    std::vector<PrewarmRequest> prewarmQueue_;
+
+    std::once_flag onceCleanerStarted_;   //per instance: a function-local static would start the threads
+    std::once_flag oncePrewarmerStarted_; //for the first instance only
+
     InterruptibleThread sessionCleaner_;
+    InterruptibleThread sessionPrewarmer_; //declare last: accesses all of the above
 };
 
 //--------------------------------------------------------------------------------------
@@ -1078,14 +1352,20 @@ constinit Global<SftpSessionManager> globalSftpSessionManager; //caveat: life ti
 void SftpSessionManager::ReUseOnDelete::operator()(SshSession* session) const
 {
     //assert(session); -> custom deleter is only called on non-null pointer
-    if (session->isHealthy()) //thread that created the "!isHealthy()" session is responsible for clean up (avoid hitting server connection limits!)
-        if (std::shared_ptr<SftpSessionManager> mgr = globalSftpSessionManager.get())
-            mgr->getSessionCache(session->getSessionCfg().deviceId).access([&](SshSessionCache& cache)
+    if (std::shared_ptr<SftpSessionManager> mgr = globalSftpSessionManager.get())
+        mgr->getSessionCache(session->getSessionCfg().deviceId).access([&](SshSessionCache& cache)
+    {
+        assert(cache.sessionsInUse > 0);
+        if (cache.sessionsInUse > 0)
+            --cache.sessionsInUse;
+
+        if (session->isHealthy()) //thread that created the "!isHealthy()" session is responsible for clean up (avoid hitting server connection limits!)
         {
             assert(cache.activeCfg);
             if (cache.activeCfg && session->getSessionCfg() == *cache.activeCfg)
                 cache.idleSshSessions.emplace_back(std::exchange(session, nullptr)); //pass ownership
-        });
+        }
+    });
     delete session;
 }
 
@@ -1904,6 +2184,8 @@ private:
 
             mgr->setActiveConfig(login_);
 
+            ZEN_ON_SCOPE_SUCCESS(mgr->prewarmSessions(login_)); //access confirmed (or at least not yet failed)
+
             if (login_.authType == SftpAuthType::password ||
                 login_.authType == SftpAuthType::keyFile)
                 if (!login_.password)
@@ -1943,6 +2225,8 @@ private:
     }
 
     bool hasNativeTransactionalCopy() const override { return false; }
+
+    bool hasSlowItemAccess() const override { return true; }
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& folderPath) const override //throw FileError, returns < 0 if not available
@@ -2047,15 +2331,22 @@ Zstring concatenateSftpFolderPathPhrase(const SftpLogin& login, const AfsPath& f
 }
 
 
-void fff::sftpInit()
+void fff::sftpInit(const Zstring& serverStatsFilePath)
 {
     assert(!globalSftpSessionManager.get());
-    globalSftpSessionManager.set(std::make_unique<SftpSessionManager>());
+    globalSftpSessionManager.set(std::make_unique<SftpSessionManager>(serverStatsFilePath));
 }
 
 
 void fff::sftpTeardown()
 {
+    try
+    {
+        if (const std::shared_ptr<SftpSessionManager> mgr = globalSftpSessionManager.get())
+            mgr->saveServerStats(); //throw FileError
+    }
+    catch (const FileError& e) { logExtraError(e.toString()); }
+
     assert(globalSftpSessionManager.get());
     globalSftpSessionManager.set(nullptr);
 }
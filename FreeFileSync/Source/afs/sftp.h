@@ -15,7 +15,7 @@ namespace fff
 bool  acceptsItemPathPhraseSftp(const Zstring& itemPathPhrase); //noexcept
 AbstractPath createItemPathSftp(const Zstring& itemPathPhrase); //noexcept
 
-void sftpInit();
+void sftpInit(const Zstring& serverStatsFilePath); //remember session counts per SFTP server across runs
 void sftpTeardown();
 
 //-------------------------------------------------------
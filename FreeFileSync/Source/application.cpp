@@ -20,12 +20,14 @@
 #include "afs/concrete.h"
 #include "base/comparison.h"
 #include "base/synchronization.h"
+#include "base/icon_cache.h"
 #include "ui/batch_status_handler.h"
 #include "ui/main_dlg.h"
 #include "ui/small_dlgs.h"
 #include "base_tools.h"
 #include "ffs_paths.h"
 #include "return_codes.h"
+#include "startup_trace.h"
 
     #include <gtk/gtk.h>
 
@@ -103,6 +105,9 @@ bool Application::OnInit()
 {
     //do not call wxApp::OnInit() to avoid using wxWidgets command line parser
 
+    startupTraceInit(); //as early as possible: env variable FFS_STARTUP_TRACE
+    StartupPhase phaseOnInit("Application::OnInit");
+
     const auto now = std::chrono::system_clock::now(); //e.g. "ErrorLog 2023-07-05 105207.073.xml"
     initExtraLog([logFilePath = appendPath(getConfigDirPath(), Zstr("ErrorLog ") +
                                            formatTime(Zstr("%Y-%m-%d %H%M%S"), getLocalTime(std::chrono::system_clock::to_time_t(now))) + Zstr('.') +
@@ -118,12 +123,18 @@ bool Application::OnInit()
     });
 
     //tentatively set program language to OS default until GlobalSettings.xml is read later
-    try { localizationInit(appendPath(getResourceDirPath(), Zstr("Languages.zip"))); } //throw FileError
-    catch (const FileError& e) { logExtraError(e.toString()); }
+    {
+        StartupPhase phase("localizationInit");
+        try { localizationInit(appendPath(getResourceDirPath(), Zstr("Languages.zip")), appendPath(getConfigDirPath(), Zstr("Languages.dat"))); } //throw FileError
+        catch (const FileError& e) { logExtraError(e.toString()); }
+    }
 
     //parallel xBRZ-scaling! => run as early as possible
-    try { imageResourcesInit(appendPath(getResourceDirPath(), Zstr("Icons.zip"))); }
-    catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
+    {
+        StartupPhase phase("imageResourcesInit"); //scaling continues in the background: waiting time shows up in later phases
+        try { imageResourcesInit(appendPath(getResourceDirPath(), Zstr("Icons.zip"))); }
+        catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
+    }
 
     //GTK should already have been initialized by wxWidgets (see \src\gtk\app.cpp:wxApp::Initialize)
     auto loadCSS = [&](const char* fileName)
@@ -144,18 +155,21 @@ bool Application::OnInit()
                                                     GTK_STYLE_PROVIDER(provider),             //GtkStyleProvider* provider
                                                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION); //guint priority
     };
-    try
     {
-        loadCSS("Gtk3Styles.css"); //throw SysError
-    }
-    catch (const SysError& e)
-    {
-        std::cerr << "[FreeFileSync] " + utfTo<std::string>(e.toString()) + "\n" "Loading GTK3\'s old CSS format instead..." "\n";
+        StartupPhase phase("loadCSS");
         try
         {
-            loadCSS("Gtk3Styles.old.css"); //throw SysError
+            loadCSS("Gtk3Styles.css"); //throw SysError
+        }
+        catch (const SysError& e)
+        {
+            std::cerr << "[FreeFileSync] " + utfTo<std::string>(e.toString()) + "\n" "Loading GTK3\'s old CSS format instead..." "\n";
+            try
+            {
+                loadCSS("Gtk3Styles.old.css"); //throw SysError
+            }
+            catch (const SysError& e2) { logExtraError(_("Failed to update the color theme.") + L"\n\n" + e2.toString()); }
         }
-        catch (const SysError& e2) { logExtraError(_("Failed to update the color theme.") + L"\n\n" + e2.toString()); }
     }
 
     /* we're a GUI app: ignore SIGHUP when the parent terminal quits! (or process is killed!)
@@ -174,7 +188,14 @@ bool Application::OnInit()
     SetAppName(L"FreeFileSync"); //if not set, defaults to executable name
 
 
-    initAfs({getResourceDirPath(), getConfigDirPath()}); //bonus: using FTP Gdrive implicitly inits OpenSSL (used in runSanityChecks() on Linux) already during globals init
+    {
+        StartupPhase phase("initAfs");
+        initAfs({getResourceDirPath(), getConfigDirPath()}); //bonus: using FTP Gdrive implicitly inits OpenSSL (used in runSanityChecks() on Linux) already during globals init
+    }
+    {
+        StartupPhase phase("iconCacheInit");
+        iconCacheInit(appendPath(getConfigDirPath(), Zstr("IconCache.dat")));
+    }
 
 
     auto onSystemShutdown = [](int /*unused*/ = 0)
@@ -211,8 +232,10 @@ int Application::OnExit()
     //assert(rv); -> fails if clipboard wasn't used
     localizationCleanup();
     imageResourcesCleanup();
+    iconCacheTeardown();
     teardownAfs();
     colorThemeCleanup();
+    startupTraceFinish(); //no-op if written already
     return wxApp::OnExit();
 }
 
@@ -236,6 +259,9 @@ int Application::OnRun()
 
 void Application::onEnterEventLoop()
 {
+    std::optional<StartupPhase> phaseEventLoop;
+    phaseEventLoop.emplace("Application::onEnterEventLoop");
+
     const std::vector<Zstring>& commandArgs = getCommandlineArgs(*this);
 
     //wxWidgets app exit handling is weird... we want to exit only if the logical main window is closed, not just *any* window!
@@ -383,6 +409,7 @@ void Application::onEnterEventLoop()
         GlobalConfig globalCfg;
         try
         {
+            StartupPhase phase("readGlobalConfig");
             std::wstring warningMsg;
             std::tie(globalCfg, warningMsg) = readGlobalConfig(globalCfgFilePath); //throw FileError
             assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
@@ -402,11 +429,18 @@ void Application::onEnterEventLoop()
         }
 
         //late GlobalSettings.xml-dependent app initialization:
-        try { setLanguage(globalCfg.programLanguage); } //throw FileError
-        catch (const FileError& e) { logExtraError(e.toString()); }
+        {
+            StartupPhase phase("setLanguage");
+            try { setLanguage(globalCfg.programLanguage); } //throw FileError
+            catch (const FileError& e) { logExtraError(e.toString()); }
+        }
+        {
+            StartupPhase phase("colorThemeInit");
+            try { colorThemeInit(*this, globalCfg.appColorTheme); } //throw FileError
+            catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
+        }
 
-        try { colorThemeInit(*this, globalCfg.appColorTheme); } //throw FileError
-        catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
+        AFS::setBlockSizeFactors(globalCfg.blockSizeFactors);
 
 
         //-----------------------------------------------------------
@@ -438,6 +472,8 @@ void Application::onEnterEventLoop()
 
             replaceDirectories(batchCfg.guiCfg.mainCfg); //throw FileError
 
+            phaseEventLoop.reset(); //close before writing the report, or it's missing
+            startupTraceFinish(); //don't include sync duration
             runBatchMode(batchCfg, filePath0, globalCfg, globalCfgFilePath);
         }
         else //GUI mode: (ffs_gui *or* ffs_batch)
@@ -516,6 +552,15 @@ void Application::runBatchMode(const FfsBatchConfig& batchCfg, const Zstring& cf
         //batch mode: place directory locks on directories during both comparison AND synchronization
         std::unique_ptr<LockHolder> dirLocks;
 
+        //started by RealTimeSync: compare changed folders only
+        std::optional<ChangeJournal> changeJournal;
+        if (const std::optional<Zstring> journalFilePath = getEnvironmentVar(CHANGE_JOURNAL_ENV_VAR))
+            try
+            {
+                changeJournal = loadChangeJournal(*journalFilePath); //throw FileError
+            }
+            catch (const FileError& e) { statusHandler.logMessage(e.toString(), PhaseCallback::MsgType::warning); } //throw CancelProcess
+
         FolderComparison cmpResult = compare(globalCfg.warnDlgs,
                                              globalCfg.fileTimeTolerance,
                                              requestPassword,
@@ -523,6 +568,7 @@ void Application::runBatchMode(const FfsBatchConfig& batchCfg, const Zstring& cf
                                              globalCfg.createLockFile,
                                              dirLocks,
                                              extractCompareCfg(batchCfg.guiCfg.mainCfg),
+                                             changeJournal ? &*changeJournal : nullptr,
                                              statusHandler); //throw CancelProcess
         if (!cmpResult.empty())
             synchronize(syncStartTime,
@@ -661,6 +707,8 @@ void Application::runBatchMode(const FfsBatchConfig& batchCfg, const Zstring& cf
     globalCfg.dpiLayouts[getDpiScalePercent()].progressDlg.size        = dlgOpt.dlgRect.size; //=> ignore dlgOpt.pos
     globalCfg.dpiLayouts[getDpiScalePercent()].progressDlg.isMaximized = dlgOpt.dlgRect.isMaximized;
 
+    globalCfg.blockSizeFactors = AFS::getBlockSizeFactors();
+
     //----------------------------------------------------------------------
     switch (r.summary.result)
     {
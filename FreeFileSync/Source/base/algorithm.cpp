@@ -8,6 +8,9 @@
 #include <zen/crc.h>
 #include <zen/guid.h>
 #include <zen/file_access.h> //needed for TempFileBuffer only
+#include <zen/thread.h>
+#include <zen/perf.h>
+#include <zen/extra_log.h>
 #include "norm_filter.h"
 #include "db_file.h"
 #include "cmp_filetime.h"
@@ -33,11 +36,52 @@ void fff::swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCm
 
 namespace
 {
+/* fork-join over the top-level folders of a base folder pair: idle workers take the next unprocessed folder (no static partitioning)
+   thread-safety: tasks must only modify items of "their" folder tree: FileSystemObject::notifySyncCfgChanged() propagates up to the top-level
+   folder, but not into BaseFolderPair, which is no FileSystemObject        */
+void processSubfoldersParallel(ContainerObject& conObj, const std::function<void(FolderPair& folder, size_t folderIdx)>& processFolder)
+{
+    std::vector<FolderPair*> folders;
+    for (FolderPair& folder : conObj.subfolders())
+        folders.push_back(&folder);
+
+    const size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U), folders.size());
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < folders.size(); ++i)
+            processFolder(*folders[i], i);
+        return;
+    }
+
+    std::atomic<size_t> nextFolderIdx = 0;
+
+    ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Sync Directions"));
+    for (size_t i = 0; i < threadCount; ++i)
+        tg.run([&]
+        {
+            for (size_t folderIdx = nextFolderIdx++; folderIdx < folders.size(); folderIdx = nextFolderIdx++)
+                processFolder(*folders[folderIdx], folderIdx);
+        });
+    tg.wait();
+}
+
+//----------------------------------------------------------------------------------------------
+
 //visitFSObjectRecursively? nope, see premature end of traversal in processFolder()
 class SetSyncDirViaDifferences
 {
 public:
-    static void execute(const DirectionByDiff& dirs, ContainerObject& conObj) { SetSyncDirViaDifferences(dirs).recurse(conObj); }
+    static void execute(const DirectionByDiff& dirs, BaseFolderPair& baseFolder)
+    {
+        const SetSyncDirViaDifferences algo(dirs);
+
+        for (FilePair& file : baseFolder.files())
+            algo.processFile(file);
+        for (SymlinkPair& link : baseFolder.symlinks())
+            algo.processLink(link);
+
+        processSubfoldersParallel(baseFolder, [&](FolderPair& folder, size_t folderIdx) { algo.processFolder(folder); });
+    }
 
 private:
     SetSyncDirViaDifferences(const DirectionByDiff& dirs) : dirs_(dirs) {}
@@ -346,27 +390,121 @@ private:
         fileTimeTolerance_(baseFolder.getFileTimeTolerance()),
         ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
     {
-        recurse(baseFolder, &dbFolder, &dbFolder);
+        //collect candidates per top-level folder in parallel...
+        std::vector<MoveCandidates> candidates(1 + baseFolder.subfolders().size());
+
+        collectFiles(baseFolder, &dbFolder, &dbFolder, candidates[0]);
+
+        processSubfoldersParallel(baseFolder, [&](FolderPair& folder, size_t folderIdx)
+        { collectFolder(folder, &dbFolder, &dbFolder, candidates[1 + folderIdx]); });
+
+        //...and merge in traversal order: same result as sequential recursion
+        for (MoveCandidates& mc : candidates)
+        {
+            for (FilePair* file : mc.oldMovePairs)
+                file->setMovePair(nullptr); //discard remnants from previous move detection and start fresh (e.g. consider manual folder rename)
+
+            append(filesL_, mc.filesL);
+            append(filesR_, mc.filesR);
+
+            for (const auto& [dbEntry, file] : mc.exLeftOnlyByPath)
+                exLeftOnlyByPath_.emplace(dbEntry, file);
+            for (const auto& [dbEntry, file] : mc.exRightOnlyByPath)
+                exRightOnlyByPath_.emplace(dbEntry, file);
+
+            addByAttributes<SelectSide::left >(mc.exLeftOnlyNoPrint,   exLeftOnlyByAttr_);
+            addByAttributes<SelectSide::right>(mc.exRightOnlyNoPrint, exRightOnlyByAttr_);
+        }
 
         purgeDuplicates<SelectSide::left >(filesL_,  exLeftOnlyById_);
         purgeDuplicates<SelectSide::right>(filesR_, exRightOnlyById_);
 
-        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty()) &&
-            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty()))
+        if (!exLeftOnlyByAttr_.empty() || !exRightOnlyByAttr_.empty())
+            excludeAmbiguousDbMatches(dbFolder);
+
+        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty() || !exLeftOnlyByAttr_ .empty()) &&
+            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty() || !exRightOnlyByAttr_.empty()))
             detectMovePairs(dbFolder);
     }
 
-    void recurse(ContainerObject& conObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR)
+    /* fallback for devices without file IDs (SFTP, FTP, many network shares): without it a renamed folder means "delete + copy" of all its files
+       => match by (file name, size, modification time): conservative, but sufficient for moved/renamed folders which keep their file names
+       => only if the match is unique among one-side-only files *and* database entries     */
+    struct FileAttrKey
+    {
+        ZstringNorm itemName;
+        uint64_t fileSize = 0;
+        time_t modTime = 0;
+
+        std::strong_ordering operator<=>(const FileAttrKey&) const = default;
+    };
+
+    template <SelectSide side>
+    static void addByAttributes(const std::vector<FilePair*>& files, std::map<FileAttrKey, FilePair*>& exOneSideByAttr)
+    {
+        for (FilePair* file : files)
+            if (const auto [it, inserted] = exOneSideByAttr.try_emplace({file->getItemName<side>(), file->getFileSize<side>(), file->getLastWriteTime<side>()}, file);
+                !inserted)
+                it->second = nullptr; //ambiguous
+    }
+
+    void excludeAmbiguousDbMatches(const InSyncFolder& dbFolder)
+    {
+        std::map<FileAttrKey, int> dbMatchCountL;
+        std::map<FileAttrKey, int> dbMatchCountR;
+        countDbMatches(dbFolder, dbMatchCountL, dbMatchCountR);
+
+        for (const auto& [key, count] : dbMatchCountL)
+            if (count > 1)
+                exLeftOnlyByAttr_[key] = nullptr;
+
+        for (const auto& [key, count] : dbMatchCountR)
+            if (count > 1)
+                exRightOnlyByAttr_[key] = nullptr;
+    }
+
+    void countDbMatches(const InSyncFolder& container, std::map<FileAttrKey, int>& dbMatchCountL, std::map<FileAttrKey, int>& dbMatchCountR) const
+    {
+        for (const auto& [fileName, dbFile] : container.files)
+        {
+            if (dbFile.left.filePrint == 0)
+                if (FileAttrKey key{fileName, dbFile.fileSize, dbFile.left.modTime};
+                    exLeftOnlyByAttr_.contains(key))
+                    ++dbMatchCountL[std::move(key)];
+
+            if (dbFile.right.filePrint == 0)
+                if (FileAttrKey key{fileName, dbFile.fileSize, dbFile.right.modTime};
+                    exRightOnlyByAttr_.contains(key))
+                    ++dbMatchCountR[std::move(key)];
+        }
+
+        for (const auto& [folderName, subFolder] : container.folders)
+            countDbMatches(subFolder, dbMatchCountL, dbMatchCountR);
+    }
+
+    struct MoveCandidates
+    {
+        std::vector<FilePair*> filesL;
+        std::vector<FilePair*> filesR;
+        std::vector<std::pair<const InSyncFile*, FilePair*>>  exLeftOnlyByPath;
+        std::vector<std::pair<const InSyncFile*, FilePair*>> exRightOnlyByPath;
+        std::vector<FilePair*> oldMovePairs; //setMovePair() modifies the other end, too => not thread-safe
+        std::vector<FilePair*>  exLeftOnlyNoPrint; //device without file IDs?
+        std::vector<FilePair*> exRightOnlyNoPrint; //
+    };
+
+    static void collectFiles(ContainerObject& conObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, MoveCandidates& mc)
     {
         for (FilePair& file : conObj.files())
         {
-            file.setMovePair(nullptr); //discard remnants from previous move detection and start fresh (e.g. consider manual folder rename)
+            if (file.getMovePair())
+                mc.oldMovePairs.push_back(&file);
 
             const AFS::FingerPrint filePrintL = file.isEmpty<SelectSide::left >() ? 0 : file.getFilePrint<SelectSide::left >();
             const AFS::FingerPrint filePrintR = file.isEmpty<SelectSide::right>() ? 0 : file.getFilePrint<SelectSide::right>();
 
-            if (filePrintL != 0) filesL_.push_back(&file); //collect *all* prints for uniqueness check!
-            if (filePrintR != 0) filesR_.push_back(&file); //
+            if (filePrintL != 0) mc.filesL.push_back(&file); //collect *all* prints for uniqueness check!
+            if (filePrintR != 0) mc.filesR.push_back(&file); //
 
             auto getDbEntry = [](const InSyncFolder* dbFolder, const Zstring& fileName) -> const InSyncFile*
             {
@@ -381,34 +519,43 @@ private:
                 cat == FILE_LEFT_ONLY)
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemName<SelectSide::left>()))
-                    exLeftOnlyByPath_.emplace(dbEntry, &file);
+                    mc.exLeftOnlyByPath.emplace_back(dbEntry, &file);
+
+                if (filePrintL == 0)
+                    mc.exLeftOnlyNoPrint.push_back(&file);
             }
             else if (cat == FILE_RIGHT_ONLY)
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemName<SelectSide::right>()))
-                    exRightOnlyByPath_.emplace(dbEntry, &file);
+                    mc.exRightOnlyByPath.emplace_back(dbEntry, &file);
+
+                if (filePrintR == 0)
+                    mc.exRightOnlyNoPrint.push_back(&file);
             }
         }
+    }
 
-        for (FolderPair& folder : conObj.subfolders())
+    static void collectFolder(FolderPair& folder, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR, MoveCandidates& mc)
+    {
+        auto getDbEntry = [](const InSyncFolder* dbFolder, const ZstringNorm& folderName) -> const InSyncFolder*
         {
-            auto getDbEntry = [](const InSyncFolder* dbFolder, const ZstringNorm& folderName) -> const InSyncFolder*
-            {
-                if (dbFolder)
-                    if (const auto it = dbFolder->folders.find(folderName);
-                        it != dbFolder->folders.end())
-                        return &it->second;
-                return nullptr;
-            };
-            const ZstringNorm itemNameL = folder.getItemName<SelectSide::left >();
-            const ZstringNorm itemNameR = folder.getItemName<SelectSide::right>();
+            if (dbFolder)
+                if (const auto it = dbFolder->folders.find(folderName);
+                    it != dbFolder->folders.end())
+                    return &it->second;
+            return nullptr;
+        };
+        const ZstringNorm itemNameL = folder.getItemName<SelectSide::left >();
+        const ZstringNorm itemNameR = folder.getItemName<SelectSide::right>();
 
-            const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, itemNameL);
-            const InSyncFolder* dbEntryR = dbFolderL == dbFolderR && itemNameL == itemNameR ?
-                                           dbEntryL : getDbEntry(dbFolderR, itemNameR);
+        const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, itemNameL);
+        const InSyncFolder* dbEntryR = dbFolderL == dbFolderR && itemNameL == itemNameR ?
+                                       dbEntryL : getDbEntry(dbFolderR, itemNameR);
 
-            recurse(folder, dbEntryL, dbEntryR);
-        }
+        collectFiles(folder, dbEntryL, dbEntryR, mc);
+
+        for (FolderPair& subFolder : folder.subfolders())
+            collectFolder(subFolder, dbEntryL, dbEntryR, mc);
     }
 
     template <SelectSide side>
@@ -451,7 +598,7 @@ private:
     void detectMovePairs(const InSyncFolder& container) const
     {
         for (const auto& [fileName, dbAttrib] : container.files)
-            findAndSetMovePair(dbAttrib);
+            findAndSetMovePair(fileName, dbAttrib);
 
         for (const auto& [folderName, subFolder] : container.folders)
             detectMovePairs(subFolder);
@@ -474,10 +621,11 @@ private:
     }
 
     template <SelectSide side>
-    FilePair* getAssocFilePair(const InSyncFile& dbFile) const
+    FilePair* getAssocFilePair(const ZstringNorm& fileName, const InSyncFile& dbFile) const
     {
         const std::unordered_map<const InSyncFile*, FilePair*>& exOneSideByPath = selectParam<side>(exLeftOnlyByPath_, exRightOnlyByPath_);
         const std::unordered_map<AFS::FingerPrint,  FilePair*>& exOneSideById   = selectParam<side>(exLeftOnlyById_,   exRightOnlyById_);
+        const std::map<FileAttrKey,                 FilePair*>& exOneSideByAttr = selectParam<side>(exLeftOnlyByAttr_, exRightOnlyByAttr_);
 
         if (const auto it = exOneSideByPath.find(&dbFile);
             it != exOneSideByPath.end())
@@ -485,21 +633,27 @@ private:
         //even if the association by path doesn't match time and size while the association by ID does!
         //there doesn't seem to be (any?) value in allowing this!
 
-        if (const AFS::FingerPrint filePrint = selectParam<side>(dbFile.left, dbFile.right).filePrint;
-            filePrint != 0)
-            if (const auto it = exOneSideById.find(filePrint);
+        const InSyncDescrFile& dbDescr = selectParam<side>(dbFile.left, dbFile.right);
+        if (dbDescr.filePrint != 0)
+        {
+            if (const auto it = exOneSideById.find(dbDescr.filePrint);
                 it != exOneSideById.end())
                 return it->second;
+        }
+        else //no file ID at time of last sync: device doesn't support them?
+            if (const auto it = exOneSideByAttr.find({fileName, dbFile.fileSize, dbDescr.modTime});
+                it != exOneSideByAttr.end())
+                return it->second; //nullptr if ambiguous
 
         return nullptr;
     }
 
-    void findAndSetMovePair(const InSyncFile& dbFile) const
+    void findAndSetMovePair(const ZstringNorm& fileName, const InSyncFile& dbFile) const
     {
         if (stillInSync(dbFile, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
-            if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(dbFile))
+            if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(fileName, dbFile))
                 if (sameSizeAndDate<SelectSide::left>(*fileLeftOnly, dbFile))
-                    if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile))
+                    if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(fileName, dbFile))
                         if (sameSizeAndDate<SelectSide::right>(*fileRightOnly, dbFile))
                         {
                             if (!fileLeftOnly ->getMovePair() &&                   //needless checks? (file prints are unique in this context)
@@ -550,6 +704,9 @@ private:
     std::unordered_map<const InSyncFile*, FilePair*>  exLeftOnlyByPath_;
     std::unordered_map<const InSyncFile*, FilePair*> exRightOnlyByPath_;
 
+    std::map<FileAttrKey, FilePair*>  exLeftOnlyByAttr_; //nullptr if ambiguous
+    std::map<FileAttrKey, FilePair*> exRightOnlyByAttr_; //
+
     /*  Detect Renamed Files:
 
          X  ->  |_|      Create right
@@ -564,6 +721,8 @@ private:
               |  (file ID, size, date)                   |  (file ID, size, date)
               |            or                            |            or
               |  (file path, size, date)                 |  (file path, size, date)
+              |            or                            |            or
+              |  (file name, size, date) if no file IDs  |  (file name, size, date) if no file IDs
              \|/                                        \|/
         file left only                             file right only
 
@@ -591,7 +750,12 @@ private:
         //-> considering filter not relevant:
         //  if stricter filter than last time: all ok;
         //  if less strict filter (if file ex on both sides -> conflict, fine; if file ex. on one side: copy to other side: fine)
-        recurse(baseFolder, &dbFolder);
+        for (FilePair& file : baseFolder.files())
+            processFile(file, &dbFolder);
+        for (SymlinkPair& symlink : baseFolder.symlinks())
+            processSymlink(symlink, &dbFolder);
+
+        processSubfoldersParallel(baseFolder, [&](FolderPair& folder, size_t folderIdx) { processDir(folder, &dbFolder); });
     }
 
     void recurse(ContainerObject& conObj, const InSyncFolder* dbFolder) const
@@ -839,6 +1003,18 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
     ZEN_ON_SCOPE_EXIT
     (
         //*INDENT-OFF*
+        StopWatch totalTime;
+        std::chrono::nanoseconds timeDetectMoved{}; //
+        std::chrono::nanoseconds timeViaChanges {}; //performance instrumentation per pass
+        std::chrono::nanoseconds timeViaDiff    {}; //
+
+        auto timePass = [](std::chrono::nanoseconds& passTime, auto&& runPass)
+        {
+            const StopWatch passWatch;
+            runPass();
+            passTime += passWatch.elapsed();
+        };
+
         for (const auto& [baseFolder, dirCfg] : directCfgs)
             if (!pairsToSkip.contains(baseFolder))
             {
@@ -846,13 +1022,16 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
                 if (AFS::isNullPath(baseFolder->getAbstractPath<SelectSide::left >()) ||
                     AFS::isNullPath(baseFolder->getAbstractPath<SelectSide::right>()))
                 {
-                    SetSyncDirViaDifferences::execute({.leftOnly   = SyncDirection::none,
-                                                       .rightOnly  = SyncDirection::none,
-                                                       .leftNewer  = SyncDirection::none,
-                                                       .rightNewer = SyncDirection::none}, *baseFolder);
+                    timePass(timeViaDiff, [&]
+                    {
+                        SetSyncDirViaDifferences::execute({.leftOnly   = SyncDirection::none,
+                                                           .rightOnly  = SyncDirection::none,
+                                                           .leftNewer  = SyncDirection::none,
+                                                           .rightNewer = SyncDirection::none}, *baseFolder);
+                    });
                 }
                 else if (const DirectionByDiff* diffDirs = std::get_if<DirectionByDiff>(&dirCfg.dirs))
-                    SetSyncDirViaDifferences::execute(*diffDirs, *baseFolder);
+                    timePass(timeViaDiff, [&] { SetSyncDirViaDifferences::execute(*diffDirs, *baseFolder); });
                 else
                 {
                     const DirectionByChange& changeDirs = std::get<DirectionByChange>(dirCfg.dirs);
@@ -861,9 +1040,9 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
                     if (const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr)
                     {
                         //detect moved files (*before* setting sync directions: might combine moved files into single file pairs, which changes category!)
-                        DetectMovedFiles::execute(*baseFolder, *lastSyncState);                
+                        timePass(timeDetectMoved, [&] { DetectMovedFiles::execute(*baseFolder, *lastSyncState); });
 
-                        SetSyncDirViaChanges::execute(*baseFolder, *lastSyncState, changeDirs);
+                        timePass(timeViaChanges, [&] { SetSyncDirViaChanges::execute(*baseFolder, *lastSyncState, changeDirs); });
                     }
                     else //fallback:
                     {
@@ -873,10 +1052,20 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
                                                                                   baseFolder->getAbstractPath<SelectSide::right>());                        
                         try { callback.logMessage(msg, PhaseCallback::MsgType::warning); /*throw X*/} catch (...) {};
 
-                        SetSyncDirViaDifferences::execute(getDiffDirDefault(changeDirs), *baseFolder);
+                        timePass(timeViaDiff, [&] { SetSyncDirViaDifferences::execute(getDiffDirDefault(changeDirs), *baseFolder); });
                     }
                 }
             }
+
+        if (totalTime.elapsed() >= std::chrono::seconds(10)) //diagnostics only: not for the user log
+        {
+            auto fmtMs = [](std::chrono::nanoseconds passTime)
+            { return numberTo<std::wstring>(std::chrono::duration_cast<std::chrono::milliseconds>(passTime).count()) + L" ms"; };
+
+            logExtraError(L"Slow sync direction calculation: " + fmtMs(totalTime.elapsed()) +
+                          L" (DetectMovedFiles: " + fmtMs(timeDetectMoved) + L", SetSyncDirViaChanges: " + fmtMs(timeViaChanges) +
+                          L", SetSyncDirViaDifferences: " + fmtMs(timeViaDiff) + L')');
+        }
         //*INDENT-ON*
     );
 
@@ -5,12 +5,24 @@
 // *****************************************************************************
 
 #include "binary.h"
+#include <zen/xxhash.h>
 
 using namespace zen;
 using namespace fff;
 using AFS = AbstractFileSystem;
 
 
+namespace
+{
+std::optional<uint64_t> getFileSizeFast(AFS::InputStream& stream) //throw FileError
+{
+    if (const std::optional<AFS::StreamAttributes> attr = stream.tryGetAttributesFast()) //throw FileError
+        return attr->fileSize;
+    return {}; //SFTP/FTP
+}
+}
+
+
 bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
     int64_t totalBytesNotified = 0;
@@ -19,8 +31,29 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
     const std::unique_ptr<AFS::InputStream> stream1 = AFS::getInputStream(filePath1); //throw FileError
     const std::unique_ptr<AFS::InputStream> stream2 = AFS::getInputStream(filePath2); //
 
-    const size_t blockSize1 = stream1->getBlockSize(); //throw FileError
-    const size_t blockSize2 = stream2->getBlockSize(); //
+    const AFS::TunedBlockSize tunedBlockSize1 = AFS::getTunedBlockSize(filePath1, getFileSizeFast(*stream1)); //throw FileError
+    const AFS::TunedBlockSize tunedBlockSize2 = AFS::getTunedBlockSize(filePath2, getFileSizeFast(*stream2)); //
+
+    const size_t blockSize1 = stream1->getBlockSize() /*throw FileError*/ * tunedBlockSize1.factor;
+    const size_t blockSize2 = stream2->getBlockSize() /*throw FileError*/ * tunedBlockSize2.factor;
+
+    uint64_t bytesCompared = 0;
+    std::chrono::nanoseconds readTime1{}; //measure separately: the slower device must not drag down the throughput of the other
+    std::chrono::nanoseconds readTime2{};
+
+    auto tryReadTimed = [&](AFS::InputStream& stream, std::chrono::nanoseconds& readTime, void* buffer, size_t bytesToRead)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const size_t bytesRead = stream.tryRead(buffer, bytesToRead, notifyIoDiv); //throw FileError, X; may return short; only 0 means EOF
+        readTime += std::chrono::steady_clock::now() - startTime;
+        return bytesRead;
+    };
+
+    auto reportThroughput = [&]
+    {
+        AFS::reportThroughput(tunedBlockSize1, bytesCompared, readTime1);
+        AFS::reportThroughput(tunedBlockSize2, bytesCompared, readTime2);
+    };
 
     const size_t bufCapacity = blockSize2 - 1 + blockSize1 + blockSize2;
 
@@ -32,14 +65,14 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
     size_t buf1PosEnd = 0;
     for (;;)
     {
-        const size_t bytesRead1 = stream1->tryRead(buf1 + buf1PosEnd, blockSize1, notifyIoDiv); //throw FileError, X; may return short; only 0 means EOF
+        const size_t bytesRead1 = tryReadTimed(*stream1, readTime1, buf1 + buf1PosEnd, blockSize1); //throw FileError, X; may return short; only 0 means EOF
 
         if (bytesRead1 == 0) //end of file
         {
             size_t buf1Pos = 0;
             while (buf1Pos < buf1PosEnd)
             {
-                const size_t bytesRead2 = stream2->tryRead(buf2, blockSize2, notifyIoDiv); //throw FileError, X; may return short; only 0 means EOF
+                const size_t bytesRead2 = tryReadTimed(*stream2, readTime2, buf2, blockSize2); //throw FileError, X; may return short; only 0 means EOF
 
                 if (bytesRead2 == 0 ||//end of file
                     bytesRead2 > buf1PosEnd - buf1Pos)
@@ -50,16 +83,21 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
 
                 buf1Pos += bytesRead2;
             }
-            return stream2->tryRead(buf2, blockSize2, notifyIoDiv) == 0; //throw FileError, X; expect EOF
+            if (tryReadTimed(*stream2, readTime2, buf2, blockSize2) != 0) //throw FileError, X; expect EOF
+                return false;
+
+            reportThroughput(); //only for complete comparisons: early mismatch says nothing about the device
+            return true;
         }
         else
         {
-            buf1PosEnd += bytesRead1;
+            buf1PosEnd    += bytesRead1;
+            bytesCompared += bytesRead1;
 
             size_t buf1Pos = 0;
             while (buf1PosEnd - buf1Pos >= blockSize2)
             {
-                const size_t bytesRead2 = stream2->tryRead(buf2, blockSize2, notifyIoDiv); //throw FileError, X; may return short; only 0 means EOF
+                const size_t bytesRead2 = tryReadTimed(*stream2, readTime2, buf2, blockSize2); //throw FileError, X; may return short; only 0 means EOF
 
                 if (bytesRead2 == 0) //end of file
                     return false;
@@ -77,3 +115,30 @@ bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
         }
     }
 }
+
+
+uint64_t fff::getFileContentHash(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    const std::unique_ptr<AFS::InputStream> stream = AFS::getInputStream(filePath); //throw FileError
+
+    const AFS::TunedBlockSize tunedBlockSize = AFS::getTunedBlockSize(filePath, getFileSizeFast(*stream)); //throw FileError
+    const size_t blockSize = stream->getBlockSize() /*throw FileError*/ * tunedBlockSize.factor;
+
+    const std::unique_ptr<std::byte[]> buf(new std::byte[blockSize]);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    uint64_t bytesHashed = 0;
+
+    XXHash64 contentHash;
+    for (;;)
+    {
+        const size_t bytesRead = stream->tryRead(buf.get(), blockSize, notifyUnbufferedIO); //throw FileError, X; may return short; only 0 means EOF
+        if (bytesRead == 0) //end of file
+        {
+            AFS::reportThroughput(tunedBlockSize, bytesHashed, std::chrono::steady_clock::now() - startTime);
+            return contentHash.get();
+        }
+        contentHash.add(buf.get(), bytesRead);
+        bytesHashed += bytesRead;
+    }
+}
@@ -15,6 +15,9 @@ namespace fff
 bool filesHaveSameContent(const AbstractPath& filePath1,
                           const AbstractPath& filePath2,
                           const zen::IoCallback& notifyUnbufferedIO  /*throw X*/); //throw FileError, X
+
+//XXH64 of the file content: same as AFS::FileCopyResult::contentHash
+uint64_t getFileContentHash(const AbstractPath& filePath, const zen::IoCallback& notifyUnbufferedIO  /*throw X*/); //throw FileError, X
 }
 
 #endif //BINARY_H_3941281398513241134
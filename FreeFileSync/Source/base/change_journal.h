@@ -0,0 +1,95 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CHANGE_JOURNAL_H_4870213458792347508
+#define CHANGE_JOURNAL_H_4870213458792347508
+
+#include <set>
+#include <chrono>
+#include <zen/file_io.h>
+#include <zen/file_path.h>
+
+
+namespace fff
+{
+/* changes reported by RealTimeSync since the last successful run of the external command
+   => lets FreeFileSync skip traversal of unchanged folders during comparison
+
+   contract: all changes within "watchedFolders" since "changesSince" are listed as "changedItems" (or one of their parent folders)
+             a watched folder listed as changed item itself: state unknown => full traversal     */
+struct ChangeJournal
+{
+    std::set<Zstring, zen::LessNativePath> watchedFolders; //native paths
+    std::set<Zstring, zen::LessNativePath> changedItems;   //native paths of created/modified/deleted files and folders
+    std::chrono::system_clock::time_point changesSince = std::chrono::system_clock::time_point::max(); //start of the last successful run
+    //=> sync.ffs_db written before this time may be outdated
+};
+
+//RealTimeSync => FreeFileSync: path to the journal file
+constexpr ZstringView CHANGE_JOURNAL_ENV_VAR = Zstr("change_journal");
+
+
+namespace impl
+{
+const char CHANGE_JOURNAL_HEADER[] = "FreeFileSync Change Journal 2";
+}
+
+
+inline
+void saveChangeJournal(const ChangeJournal& journal, const Zstring& filePath) //throw FileError
+{
+    using namespace zen;
+
+    std::string content = std::string(impl::CHANGE_JOURNAL_HEADER) + '\n';
+
+    content += "S " + numberTo<std::string>(std::chrono::duration_cast<std::chrono::nanoseconds>(journal.changesSince.time_since_epoch()).count()) + '\n';
+
+    for (const Zstring& folderPath : journal.watchedFolders)
+        if (!contains(folderPath, Zstr('\n'))) //can't be represented => no incremental comparison for this folder
+            content += "W " + utfTo<std::string>(folderPath) + '\n';
+
+    for (Zstring itemPath : journal.changedItems)
+    {
+        while (contains(itemPath, Zstr('\n'))) //report parent folder instead: a superset is fine
+            itemPath = beforeLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+
+        if (!itemPath.empty())
+            content += "C " + utfTo<std::string>(itemPath) + '\n';
+    }
+
+    setFileContent(filePath, content, nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+inline
+ChangeJournal loadChangeJournal(const Zstring& filePath) //throw FileError
+{
+    using namespace zen;
+
+    const std::string content = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    std::vector<std::string_view> lines = splitCpy(std::string_view(content), '\n', SplitOnEmpty::skip);
+
+    if (lines.empty() || lines[0] != impl::CHANGE_JOURNAL_HEADER)
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), _("File content is corrupted.") + L" (invalid header)");
+
+    ChangeJournal journal;
+    for (auto it = lines.begin() + 1; it != lines.end(); ++it)
+        if (startsWith(*it, "S "))
+            journal.changesSince = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                                                             std::chrono::nanoseconds(stringTo<int64_t>(it->substr(2)))));
+        else if (startsWith(*it, "W "))
+            journal.watchedFolders.insert(utfTo<Zstring>(it->substr(2)));
+        else if (startsWith(*it, "C "))
+            journal.changedItems.insert(utfTo<Zstring>(it->substr(2)));
+        else
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), _("File content is corrupted.") + L" (unknown entry)");
+
+    return journal;
+}
+}
+
+#endif //CHANGE_JOURNAL_H_4870213458792347508
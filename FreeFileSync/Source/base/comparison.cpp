@@ -12,6 +12,7 @@
 #include "parallel_scan.h"
 #include "dir_exist_async.h"
 #include "db_file.h"
+#include "change_journal.h"
 #include "binary.h"
 #include "cmp_filetime.h"
 #include "status_handler_impl.h"
@@ -183,6 +184,184 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
 
 //#############################################################################################################################
 
+//"parentPath" is "itemPath" or one of its parent folders?
+bool isSameOrParentPath(const Zstring& parentPath, const Zstring& itemPath)
+{
+    if (equalNativePath(parentPath, itemPath))
+        return true;
+
+    const Zstring parentPathPf = appendSeparator(parentPath);
+    return itemPath.size() > parentPathPf.size() &&
+           equalNativePath(parentPathPf, Zstring(itemPath.c_str(), parentPathPf.size()));
+}
+
+
+//relative paths of changed items; none if state of base folder is unknown
+std::optional<std::set<Zstring>> getChangedItems(const AbstractPath& baseFolderPath, const ChangeJournal& journal)
+{
+    const Zstring& nativePath = getNativeItemPath(baseFolderPath);
+    if (nativePath.empty()) //RealTimeSync monitors native folders only
+        return std::nullopt;
+
+    if (std::none_of(journal.watchedFolders.begin(), journal.watchedFolders.end(),
+    [&](const Zstring& watchedPath) { return isSameOrParentPath(watchedPath, nativePath); }))
+    return std::nullopt;
+
+    const Zstring nativePathPf = appendSeparator(nativePath);
+
+    std::set<Zstring> changedItems;
+    for (const Zstring& itemPath : journal.changedItems)
+        if (isSameOrParentPath(itemPath, nativePath)) //e.g. folder was (re-)created, changes were lost
+            return std::nullopt;
+        else if (isSameOrParentPath(nativePath, itemPath))
+            changedItems.insert(Zstring(itemPath.begin() + nativePathPf.size(), itemPath.end()));
+
+    return changedItems;
+}
+
+
+//convert sync.ffs_db to the format of a folder traversal
+template <SelectSide side>
+void getLastKnownState(const InSyncFolder& dbFolder, const Zstring& relPath, FolderContainer& output, std::set<Zstring>& staleFolders)
+{
+    /* caveat: sync.ffs_db only stores *normalized* item names, which (unlike the raw names) can't be used to access the file system!
+       => restrict to ASCII names where both forms are identical, and list folders with non-ASCII names again      */
+    bool haveNonAsciiName = false;
+
+    for (const auto& [fileName, file] : dbFolder.files)
+        if (isAsciiString(fileName.normStr))
+        {
+            const InSyncDescrFile& descr = selectParam<side>(file.left, file.right);
+            output.addFile(fileName.normStr,
+            {
+                .modTime = descr.modTime,
+                .fileSize = file.fileSize,
+                .filePrint = descr.filePrint,
+            });
+        }
+        else
+            haveNonAsciiName = true;
+
+    for (const auto& [linkName, symlink] : dbFolder.symlinks)
+        if (isAsciiString(linkName.normStr))
+            output.addSymlink(linkName.normStr, {.modTime = selectParam<side>(symlink.left, symlink.right).modTime});
+        else
+            haveNonAsciiName = true;
+
+    for (const auto& [folderName, subFolder] : dbFolder.folders)
+        if (isAsciiString(folderName.normStr)) //non-ASCII folders are missing in last known state => traversed completely
+            getLastKnownState<side>(subFolder, relPath.empty() ? folderName.normStr : relPath + FILE_NAME_SEPARATOR + folderName.normStr,
+                                    output.addFolder(folderName.normStr, {}), staleFolders);
+        else
+            haveNonAsciiName = true;
+
+    if (haveNonAsciiName && !relPath.empty()) //base folder is always listed
+        staleFolders.insert(relPath);
+}
+
+
+//sync.ffs_db written after RealTimeSync started recording changes? => last known state + changes = current state
+bool isDatabaseCurrent(const AbstractPath& baseFolderPath, const ChangeJournal& journal)
+{
+    const AbstractPath dbFilePath = getDatabaseFilePath(baseFolderPath);
+
+    std::optional<time_t> modTime;
+    try
+    {
+        if (const std::optional<AFS::StreamAttributes> attr = AFS::getInputStream(dbFilePath)->tryGetAttributesFast()) //throw FileError, ErrorFileLocked
+            modTime = attr->modTime;
+        else //SFTP/FTP
+            AFS::traverseFolder(baseFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
+        {
+            if (fi.itemName == AFS::getItemName(dbFilePath))
+                modTime = fi.modTime;
+        }, nullptr /*onFolder*/, nullptr /*onSymlink*/);
+    }
+    catch (FileError&) { return false; } //e.g. not existing => full traversal
+
+    if (!modTime)
+        return false;
+
+    /* not updated during last run: outdated, even if database content had been accurate (sync.ffs_db is not rewritten if unchanged)
+       e.g. pair was mirrored meanwhile, or synced with a different configuration => items changed before "changesSince" are missing in journal
+       time_t has seconds precision: rounding down may cost a full traversal, but never accepts an outdated database */
+    return std::chrono::system_clock::from_time_t(*modTime) >= journal.changesSince;
+}
+
+
+//incremental comparison: traverse changed folders only, take everything else from sync.ffs_db
+std::map<DirectoryKey, FolderChanges> getFolderChanges(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                                       const FolderStatus& folderStatus, const ChangeJournal& journal,
+                                                       PhaseCallback& callback /*throw X*/) //throw X
+{
+    std::map<DirectoryKey, size_t> keyUsageCount;
+    for (const auto& [folderPair, fpCfg] : workLoad)
+    {
+        ++keyUsageCount[DirectoryKey{folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}];
+        ++keyUsageCount[DirectoryKey{folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}];
+    }
+
+    struct PairChanges
+    {
+        DirectoryKey keyL;
+        DirectoryKey keyR;
+        std::set<Zstring> changedItemsL;
+        std::set<Zstring> changedItemsR;
+        uint64_t filterPrint;
+    };
+    std::map<std::pair<AbstractPath, AbstractPath>, PairChanges> pairChanges;
+
+    for (const auto& [folderPair, fpCfg] : workLoad)
+        if (folderStatus.existing.contains(folderPair.folderPathLeft) &&
+            folderStatus.existing.contains(folderPair.folderPathRight) &&
+            fpCfg.handleSymlinks != SymLinkHandling::follow && //changes of symlink targets are not reported
+            std::holds_alternative<DirectionByChange>(fpCfg.directionCfg.dirs)) //only two-way sync updates sync.ffs_db consistently
+        {
+            const DirectoryKey keyL{folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks};
+            const DirectoryKey keyR{folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks};
+
+            if (keyUsageCount[keyL] == 1 && //same folder in multiple pairs: which sync.ffs_db should we take?
+                keyUsageCount[keyR] == 1)
+                if (std::optional<std::set<Zstring>> changedItemsL = getChangedItems(folderPair.folderPathLeft, journal))
+                    if (std::optional<std::set<Zstring>> changedItemsR = getChangedItems(folderPair.folderPathRight, journal))
+                        if (isDatabaseCurrent(folderPair.folderPathLeft,  journal) &&
+                            isDatabaseCurrent(folderPair.folderPathRight, journal))
+                            pairChanges.emplace(std::pair(folderPair.folderPathLeft, folderPair.folderPathRight),
+                                                PairChanges{keyL, keyR, std::move(*changedItemsL), std::move(*changedItemsR), fpCfg.filter.nameFilter.ref().getFingerprint()});
+        }
+
+    std::set<std::pair<AbstractPath, AbstractPath>> folderPairs;
+    for (const auto& [folderPair, changes] : pairChanges)
+        folderPairs.insert(folderPair);
+
+    const std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> lastSyncStates = loadLastSynchronousState(folderPairs, callback); //throw X
+
+    std::map<DirectoryKey, FolderChanges> output;
+
+    for (auto& [folderPair, changes] : pairChanges)
+        if (auto it = lastSyncStates.find(folderPair);
+            it != lastSyncStates.end() && //no sync.ffs_db => full traversal
+            it->second.ref().completeFilterPrint == changes.filterPrint) /* items not in sync after last run => database lists outdated state
+                                                                            filter changed => items previously excluded are missing in database */
+        {
+            auto lastKnownL = makeSharedRef<FolderContainer>();
+            auto lastKnownR = makeSharedRef<FolderContainer>();
+            std::set<Zstring> staleFoldersL;
+            std::set<Zstring> staleFoldersR;
+            getLastKnownState<SelectSide::left >(it->second.ref(), Zstring(), lastKnownL.ref(), staleFoldersL);
+            getLastKnownState<SelectSide::right>(it->second.ref(), Zstring(), lastKnownR.ref(), staleFoldersR);
+
+            output.emplace(changes.keyL, FolderChanges{lastKnownL, std::move(changes.changedItemsL), std::move(staleFoldersL)});
+            output.emplace(changes.keyR, FolderChanges{lastKnownR, std::move(changes.changedItemsR), std::move(staleFoldersR)});
+
+            callback.logMessage(_("Comparing changed folders only:") + L' ' +
+                                AFS::getDisplayPath(folderPair.first) + L" <-> " + AFS::getDisplayPath(folderPair.second), PhaseCallback::MsgType::info); //throw X
+        }
+    return output;
+}
+
+//#############################################################################################################################
+
 class ComparisonBuffer
 {
 public:
@@ -193,7 +372,8 @@ public:
         folderStatus_(folderStatus),
         cb_(callback) {}
 
-    FolderComparison execute(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad);
+    FolderComparison execute(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                             const std::map<DirectoryKey, FolderChanges>& folderChanges /*optional: incremental comparison*/);
 
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
@@ -225,10 +405,12 @@ private:
     const FolderStatus& folderStatus_;
     std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders!
     ProcessCallback& cb_;
+    const SharedRef<ObjectIdTable> objectIds_ = makeSharedRef<ObjectIdTable>(); //shared by all BaseFolderPair of the FolderComparison
 };
 
 
-FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad)
+FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                           const std::map<DirectoryKey, FolderChanges>& folderChanges)
 {
     std::set<DirectoryKey> foldersToRead;
     for (const auto& [folderPair, fpCfg] : workLoad)
@@ -254,7 +436,7 @@ FolderComparison ComparisonBuffer::execute(const std::vector<std::pair<ResolvedF
         cb_.updateStatus(textScanning + statusLine); //throw X
     };
 
-    folderBuffer_ = parallelFolderScan(foldersToRead,
+    folderBuffer_ = parallelFolderScan(foldersToRead, folderChanges,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return cb_.reportError(errorInfo); }, //throw X
     onStatusUpdate, //throw X
     UI_UPDATE_INTERVAL / 2); //every ~25 ms
@@ -508,6 +690,30 @@ void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingCon
     else
         file.setContentCategory(haveSameContent ? FileContentCategory::equal : FileContentCategory::different);
 }
+
+
+//file copied during an earlier sync and unchanged on both sides since? => content is identical without reading it: see InSyncFile::contentHash
+bool unchangedSinceCopy(const FilePair& file, const InSyncFolder& dbFolder)
+{
+    const Zstring& relPath = file.getRelativePath<SelectSide::left>();
+    if (relPath != file.getRelativePath<SelectSide::right>()) //database only stores file pairs with equal names
+        return false;
+
+    const InSyncFolder* dbParent = &dbFolder;
+    for (const Zstring& folderName : splitCpy(beforeLast(relPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none), FILE_NAME_SEPARATOR, SplitOnEmpty::skip))
+        if (auto it = dbParent->folders.find(folderName);
+            it != dbParent->folders.end())
+            dbParent = &it->second;
+        else
+            return false;
+
+    auto it = dbParent->files.find(file.getItemName<SelectSide::left>());
+    return it != dbParent->files.end() &&
+           it->second.contentHash != 0 && //set only if the data was passed through during file copy
+           it->second.fileSize      == file.getFileSize     <SelectSide::left >() && //left and right file sizes are equal
+           it->second.left .modTime == file.getLastWriteTime<SelectSide::left >() && //no FAT tolerance: see DetectMovedFiles::sameSizeAndDate()
+           it->second.right.modTime == file.getLastWriteTime<SelectSide::right>();
+}
 }
 
 
@@ -524,14 +730,17 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
         ParallelOps& parallelOpsL; //
         ParallelOps& parallelOpsR; //consider aliasing!
         RingBuffer<FilePair*> filesToCompareBytewise;
+        std::optional<std::pair<AbstractPath, AbstractPath>> dbFolderPair; //two-way sync: sync.ffs_db is consistently updated
     };
     std::vector<BinaryWorkload> fpWorkload;
 
-    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise)
+    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise, bool twoWaySync)
     {
         ParallelOps& posL = parallelOpsStatus[basePathL.afsDevice];
         ParallelOps& posR = parallelOpsStatus[basePathR.afsDevice];
         fpWorkload.push_back({posL, posR, std::move(filesToCompareBytewise)});
+        if (twoWaySync)
+            fpWorkload.back().dbFolderPair = std::pair(basePathL, basePathR);
     };
 
     std::vector<SharedRef<BaseFolderPair>> output;
@@ -564,15 +773,42 @@ std::vector<SharedRef<BaseFolderPair>> ComparisonBuffer::compareByContent(const
             }
         if (!filesToCompareBytewise.empty())
             addToBinaryWorkload(output.back().ref().getAbstractPath<SelectSide::left >(),
-                                output.back().ref().getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise));
+                                output.back().ref().getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise),
+                                std::holds_alternative<DirectionByChange>(fpCfg.directionCfg.dirs));
 
         //finish symlink categorization
         for (SymlinkPair* symlink : uncategorizedLinks)
             categorizeSymlinkByContent(*symlink, cb_);
     }
 
+    //skip files whose content is known to be identical from sync.ffs_db
+    std::set<std::pair<AbstractPath, AbstractPath>> dbFolderPairs;
+    for (const BinaryWorkload& bwl : fpWorkload)
+        if (bwl.dbFolderPair)
+            dbFolderPairs.insert(*bwl.dbFolderPair);
+
+    if (!dbFolderPairs.empty())
+    {
+        const std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> lastSyncStates = loadLastSynchronousState(dbFolderPairs, cb_); //throw X
+
+        for (BinaryWorkload& bwl : fpWorkload)
+            if (bwl.dbFolderPair)
+                if (auto it = lastSyncStates.find(*bwl.dbFolderPair);
+                    it != lastSyncStates.end())
+                {
+                    RingBuffer<FilePair*> filesToCompareBytewise;
+                    for (FilePair* file : bwl.filesToCompareBytewise)
+                        if (unchangedSinceCopy(*file, it->second.ref()))
+                            file->setContentCategory(FileContentCategory::equal);
+                        else
+                            filesToCompareBytewise.push_back(file);
+
+                    bwl.filesToCompareBytewise.swap(filesToCompareBytewise);
+                }
+    }
+
     //finish categorization: compare files (that have same size) bytewise...
-    if (!fpWorkload.empty()) //run ProcessPhase::binaryCompare only when needed
+    if (std::any_of(fpWorkload.begin(), fpWorkload.end(), [](const BinaryWorkload& bwl) { return !bwl.filesToCompareBytewise.empty(); })) //run ProcessPhase::binaryCompare only when needed
     {
         int      itemsTotal = 0;
         uint64_t bytesTotal = 0;
@@ -1040,7 +1276,8 @@ SharedRef<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFold
                                                                      fpCfg.filter.nameFilter.ref().copyFilterAddingExclusion(excludeFilterFailedRead),
                                                                      fpCfg.compareVar,
                                                                      fileTimeTolerance_,
-                                                                     fpCfg.ignoreTimeShiftMinutes);
+                                                                     fpCfg.ignoreTimeShiftMinutes,
+                                                                     objectIds_);
     //PERF_START;
     MergeSides::execute(*folderContL, *folderContR, failedReadsL, failedReadsR,
                         output.ref(), undefinedFiles, undefinedSymlinks);
@@ -1069,6 +1306,7 @@ FolderComparison fff::compare(WarningDialogs& warnings,
                               bool createDirLocks,
                               std::unique_ptr<LockHolder>& dirLocks,
                               const std::vector<FolderPairCfg>& fpCfgList,
+                              const ChangeJournal* changeJournal,
                               ProcessCallback& callback /*throw X*/) //throw X
 {
     //indicator at the very beginning of the log to make sense of "total time"
@@ -1170,10 +1408,14 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         //reduce peak memory by restricting lifetime of ComparisonBuffer to have ended when loading potentially huge InSyncFolder instance in redetermineSyncDirection()
         {
             //------------------- fill directory buffer: traverse/read folders --------------------------
+            std::map<DirectoryKey, FolderChanges> folderChanges;
+            if (changeJournal)
+                folderChanges = getFolderChanges(workLoad, resInfo.baseFolderStatus, *changeJournal, callback); //throw X
+
             ComparisonBuffer cmpBuf(resInfo.baseFolderStatus,
                                     fileTimeTolerance, callback);
             //PERF_START;
-            output = cmpBuf.execute(workLoad);
+            output = cmpBuf.execute(workLoad, folderChanges);
             //PERF_STOP;
         }
         assert(output.size() == fpCfgList.size());
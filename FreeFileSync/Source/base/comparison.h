@@ -11,6 +11,7 @@
 #include "process_callback.h"
 #include "norm_filter.h"
 #include "lock_holder.h"
+#include "change_journal.h"
 
 
 namespace fff
@@ -39,6 +40,7 @@ FolderComparison compare(WarningDialogs& warnings,
                          bool createDirLocks,
                          std::unique_ptr<LockHolder>& dirLocks, //out
                          const std::vector<FolderPairCfg>& fpCfgList,
+                         const ChangeJournal* changeJournal, //optional: compare changed folders only
                          ProcessCallback& callback /*throw X*/); //throw X
 }
 
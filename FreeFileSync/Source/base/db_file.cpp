@@ -21,7 +21,7 @@ namespace
 //-------------------------------------------------------------------------------------------------------------------------------
 const char DB_FILE_DESCR[] = "FreeFileSync";
 const int DB_FILE_VERSION   = 11; //2020-02-07
-const int DB_STREAM_VERSION =  5; //2023-07-29
+const int DB_STREAM_VERSION =  6; //2026-10-18
 //-------------------------------------------------------------------------------------------------------------------------------
 
 struct SessionData
@@ -39,9 +39,10 @@ using DbStreams = std::unordered_map<UniqueId, SessionData>; //list of streams b
 /*------------------------------------------------------------------------------
   | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
   ------------------------------------------------------------------------------*/
+}
+
 
-template <SelectSide side> inline
-AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
+AbstractPath fff::getDatabaseFilePath(const AbstractPath& baseFolderPath)
 {
     static_assert(std::endian::native == std::endian::little);
     /* Windows, Linux, macOS considerations for uniform database format:
@@ -54,9 +55,12 @@ AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
 
         => give DB files different names:                   */
     const Zstring dbName = Zstr(".sync"); //files beginning with dots are usually hidden
-    return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), dbName + SYNC_DB_FILE_ENDING);
+    return AFS::appendRelPath(baseFolderPath, dbName + SYNC_DB_FILE_ENDING);
 }
 
+
+namespace
+{
 //#######################################################################################################################################
 
 void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
@@ -247,6 +251,9 @@ public:
         writeContainer(streamOut, bufSmallNum);
         writeContainer(streamOut, bufBigNum);
 
+        writeNumber<int8_t  >(streamOut, dbFolder.completeFilterPrint.has_value());
+        writeNumber<uint64_t>(streamOut, dbFolder.completeFilterPrint.value_or(0));
+
         const std::string& buf = streamOut.ref();
 
         //distribute "outputBoth" over left and right streams:
@@ -275,6 +282,7 @@ private:
 
             writeFileDescr(inSyncData.left);
             writeFileDescr(inSyncData.right);
+            writeNumber<uint64_t>(streamOutBigNum_, inSyncData.contentHash);
         }
 
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
@@ -373,6 +381,7 @@ public:
             }
             else if (streamVersion == 3 || //TODO: remove migration code at some time! 2021-02-14
                      streamVersion == 4 || //TODO: remove migration code at some time! 2023-07-29
+                     streamVersion == 5 || //TODO: remove migration code at some time! 2026-10-18
                      streamVersion == DB_STREAM_VERSION)
             {
                 MemoryStreamIn& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
@@ -399,6 +408,14 @@ public:
                     parser.recurse<SelectSide::left>(output.ref()); //throw SysError
                 else
                     parser.recurse<SelectSide::right>(output.ref()); //throw SysError
+
+                if (streamVersion >= 6) //TODO: remove migration code at some time! 2026-10-18
+                {
+                    const bool     isComplete  = readNumber<int8_t  >(streamIn) != 0; //throw SysErrorUnexpectedEos
+                    const uint64_t filterPrint = readNumber<uint64_t>(streamIn);      //
+                    if (isComplete)
+                        output.ref().completeFilterPrint = filterPrint;
+                }
                 return output;
             }
             else
@@ -433,9 +450,13 @@ private:
             const InSyncDescrFile descrL = readFileDescr(); //throw SysErrorUnexpectedEos
             const InSyncDescrFile descrT = readFileDescr(); //
 
+            uint64_t contentHash = 0;
+            if (streamVersion_ >= 6) //TODO: remove migration code at some time! 2026-10-18
+                contentHash = readNumber<uint64_t>(streamInBigNum_); //throw SysErrorUnexpectedEos
+
             container.addFile(itemName,
                               selectParam<leadSide>(descrL, descrT),
-                              selectParam<leadSide>(descrT, descrL), cmpVar, fileSize);
+                              selectParam<leadSide>(descrT, descrL), cmpVar, fileSize, contentHash);
         }
 
         size_t linkCount = readNumber<uint32_t>(streamInSmallNum_);
@@ -512,7 +533,7 @@ private:
                 /*const auto fileIdL =*/ readContainer<std::string>(inputLeft_);
                 const time_t modTimeR = readNumber<int64_t>(inputRight_);
                 /*const auto fileIdR =*/ readContainer<std::string>(inputRight_);
-                container.addFile(itemName, InSyncDescrFile{modTimeL, AFS::FingerPrint()}, InSyncDescrFile{modTimeR, AFS::FingerPrint()}, cmpVar, fileSize);
+                container.addFile(itemName, InSyncDescrFile{modTimeL, AFS::FingerPrint()}, InSyncDescrFile{modTimeR, AFS::FingerPrint()}, cmpVar, fileSize, 0 /*contentHash*/);
             }
 
             size_t linkCount = readNumber<uint32_t>(inputBoth_);
@@ -567,6 +588,11 @@ public:
     {
         LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter());
         updater.recurse(baseFolder, Zstring(), dbFolder);
+
+        if (updater.allInSync_) //entries for excluded items are kept, but don't matter: filter is recorded
+            dbFolder.completeFilterPrint = baseFolder.getFilter().getFingerprint();
+        else
+            dbFolder.completeFilterPrint = std::nullopt;
     }
 
 private:
@@ -596,18 +622,29 @@ private:
                     const Zstring& fileName = file.getItemName<SelectSide::left>();
                     assert(file.getFileSize<SelectSide::left>() == file.getFileSize<SelectSide::right>());
 
+                    uint64_t contentHash = file.getContentHash(); //set if copied during this sync
+                    if (contentHash == 0)
+                        if (auto it = dbFiles.find(fileName);
+                            it != dbFiles.end() && //carry over if file content was not touched since:
+                            it->second.fileSize      == file.getFileSize     <SelectSide::left >() &&
+                            it->second.left .modTime == file.getLastWriteTime<SelectSide::left >() &&
+                            it->second.right.modTime == file.getLastWriteTime<SelectSide::right>())
+                            contentHash = it->second.contentHash;
+
                     //create or update new "in-sync" state
                     dbFiles.insert_or_assign(fileName, InSyncFile
                     {
-                        .left     = InSyncDescrFile{file.getLastWriteTime<SelectSide::left >(), file.getFilePrint<SelectSide::left >()},
-                        .right    = InSyncDescrFile{file.getLastWriteTime<SelectSide::right>(), file.getFilePrint<SelectSide::right>()},
-                        .cmpVar   = activeCmpVar_,
-                        .fileSize = file.getFileSize<SelectSide::left>(),
+                        .left        = InSyncDescrFile{file.getLastWriteTime<SelectSide::left >(), file.getFilePrint<SelectSide::left >()},
+                        .right       = InSyncDescrFile{file.getLastWriteTime<SelectSide::right>(), file.getFilePrint<SelectSide::right>()},
+                        .cmpVar      = activeCmpVar_,
+                        .fileSize    = file.getFileSize<SelectSide::left>(),
+                        .contentHash = contentHash,
                     });
                     toPreserve.insert(fileName);
                 }
                 else //not in sync: preserve last synchronous state
                 {
+                    allInSync_ = false;
                     toPreserve.insert(file.getItemName<SelectSide::left >()); //left/right may differ in case!
                     toPreserve.insert(file.getItemName<SelectSide::right>()); //
                 }
@@ -648,6 +685,7 @@ private:
                 }
                 else //not in sync: preserve last synchronous state
                 {
+                    allInSync_ = false;
                     toPreserve.insert(symlink.getItemName<SelectSide::left >()); //left/right may differ in case!
                     toPreserve.insert(symlink.getItemName<SelectSide::right>()); //
                 }
@@ -683,6 +721,7 @@ private:
                 }
                 else //not in sync: preserve last synchronous state
                 {
+                    allInSync_ = false;
                     toPreserve.emplace(folder.getItemName<SelectSide::left >(), &folder); //names differing (in case)? => treat like any other folder rename
                     toPreserve.emplace(folder.getItemName<SelectSide::right>(), &folder); //=> no *new* database entries even if child items are in sync
                     //BUT: update existing one: there should be only *one* DB entry after a folder rename (matching either folder name on left or right)
@@ -731,6 +770,7 @@ private:
 
     const PathFilter& filter_; //filter used while scanning directory: generates view on actual files!
     const CompareVariant activeCmpVar_;
+    bool allInSync_ = true; //=> database lists exactly the items found by comparison (within filter_)
 };
 
 
@@ -791,20 +831,16 @@ std::pair<DbStreams::const_iterator,
 
 //#######################################################################################################################################
 
-std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::set<std::pair<AbstractPath, AbstractPath>>& folderPairs,
         PhaseCallback& callback /*throw X*/) //throw X
 {
     std::set<AbstractPath> dbFilePaths;
 
-    for (const BaseFolderPair* baseFolder : baseFolders)
-        //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
-        if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
-            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
-        {
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::left >(*baseFolder));
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::right>(*baseFolder));
-        }
-    //else: ignore; there's no value in reporting it other than to confuse users
+    for (const auto& [folderPathL, folderPathR] : folderPairs)
+    {
+        dbFilePaths.insert(getDatabaseFilePath(folderPathL));
+        dbFilePaths.insert(getDatabaseFilePath(folderPathR));
+    }
 
     std::map<AbstractPath, DbStreams> dbStreamsByPath;
     //------------ (try to) load DB files in parallel -------------------------
@@ -833,42 +869,69 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
     }
     //----------------------------------------------------------------
 
-    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+    std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> output;
+
+    for (const std::pair<AbstractPath, AbstractPath>& folderPair : folderPairs)
+    {
+        const AbstractPath dbPathL = getDatabaseFilePath(folderPair.first);
+        const AbstractPath dbPathR = getDatabaseFilePath(folderPair.second);
+
+        auto itL = dbStreamsByPath.find(dbPathL);
+        auto itR = dbStreamsByPath.find(dbPathR);
+
+        if (itL != dbStreamsByPath.end() &&
+            itR != dbStreamsByPath.end())
+            try
+            {
+                const DbStreams& streamsL = itL->second;
+                const DbStreams& streamsR = itR->second;
+
+                //find associated session: there can be at most one session within intersection of left and right IDs
+                const auto [itStreamL, itStreamR] = findCommonSession(streamsL, streamsR,
+                                                                      AFS::getDisplayPath(dbPathL),
+                                                                      AFS::getDisplayPath(dbPathR)); //throw FileError
+                if (itStreamL != streamsL.end())
+                {
+                    assert(itStreamL->second.isLeadStream != itStreamR->second.isLeadStream);
+                    SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(itStreamL->second.isLeadStream,
+                                                                                  itStreamL->second.rawStream,
+                                                                                  itStreamR->second.rawStream,
+                                                                                  AFS::getDisplayPath(dbPathL),
+                                                                                  AFS::getDisplayPath(dbPathR)); //throw FileError
+                    output.emplace(folderPair, lastSyncState);
+                }
+            }
+            catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
+    }
+
+    return output;
+}
+
+
+std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+        PhaseCallback& callback /*throw X*/) //throw X
+{
+    std::set<std::pair<AbstractPath, AbstractPath>> folderPairs;
 
     for (const BaseFolderPair* baseFolder : baseFolders)
+        //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
         if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
             baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
-        {
-            const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(*baseFolder);
-            const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(*baseFolder);
+            folderPairs.emplace(baseFolder->getAbstractPath<SelectSide::left >(),
+                                baseFolder->getAbstractPath<SelectSide::right>());
+    //else: ignore; there's no value in reporting it other than to confuse users
 
-            auto itL = dbStreamsByPath.find(dbPathL);
-            auto itR = dbStreamsByPath.find(dbPathR);
+    const std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> lastSyncStates = loadLastSynchronousState(folderPairs, callback); //throw X
 
-            if (itL != dbStreamsByPath.end() &&
-                itR != dbStreamsByPath.end())
-                try
-                {
-                    const DbStreams& streamsL = itL->second;
-                    const DbStreams& streamsR = itR->second;
-
-                    //find associated session: there can be at most one session within intersection of left and right IDs
-                    const auto [itStreamL, itStreamR] = findCommonSession(streamsL, streamsR,
-                                                                          AFS::getDisplayPath(dbPathL),
-                                                                          AFS::getDisplayPath(dbPathR)); //throw FileError
-                    if (itStreamL != streamsL.end())
-                    {
-                        assert(itStreamL->second.isLeadStream != itStreamR->second.isLeadStream);
-                        SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(itStreamL->second.isLeadStream,
-                                                                                      itStreamL->second.rawStream,
-                                                                                      itStreamR->second.rawStream,
-                                                                                      AFS::getDisplayPath(dbPathL),
-                                                                                      AFS::getDisplayPath(dbPathR)); //throw FileError
-                        output.emplace(baseFolder, lastSyncState);
-                    }
-                }
-                catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
-        }
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+
+    for (const BaseFolderPair* baseFolder : baseFolders)
+        if (auto it = lastSyncStates.find({baseFolder->getAbstractPath<SelectSide::left >(),
+                                           baseFolder->getAbstractPath<SelectSide::right>()});
+            it != lastSyncStates.end() &&
+            baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
+            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
+            output.emplace(baseFolder, it->second);
 
     return output;
 }
@@ -877,8 +940,8 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
 void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy,
                                    PhaseCallback& callback /*throw X*/) //throw X
 {
-    const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(baseFolder);
-    const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(baseFolder);
+    const AbstractPath dbPathL = getDatabaseFilePath(baseFolder.getAbstractPath<SelectSide::left >());
+    const AbstractPath dbPathR = getDatabaseFilePath(baseFolder.getAbstractPath<SelectSide::right>());
 
     //------------ (try to) load DB files in parallel -------------------------
     DbStreams streamsL; //list of session ID + DirInfo-stream
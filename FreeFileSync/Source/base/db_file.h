@@ -36,6 +36,7 @@ struct InSyncFile
     InSyncDescrFile right; //
     CompareVariant cmpVar = CompareVariant::timeSize; //the one active while finding "file in sync"
     uint64_t fileSize = 0; //file size must be identical on both sides!
+    uint64_t contentHash = 0; //optional: XXH64 of the (identical) content of both sides, as computed during file copy => see compareByContent()
 };
 
 struct InSyncSymlink
@@ -57,6 +58,9 @@ struct InSyncFolder
     FileList    files;
     SymlinkList symlinks; //non-followed symlinks
 
+    std::optional<uint64_t> completeFilterPrint; //base folder only: all items passing this filter (see PathFilter::getFingerprint()) were in sync
+    //=> database is an image of both folders (as of the time it was written) and can replace folder traversal
+
     //convenience
     InSyncFolder& addFolder(const Zstring& folderName)
     {
@@ -65,9 +69,9 @@ struct InSyncFolder
         return it->second;
     }
 
-    void addFile(const Zstring& fileName, const InSyncDescrFile& descrL, const InSyncDescrFile& descrR, CompareVariant cmpVar, uint64_t fileSize)
+    void addFile(const Zstring& fileName, const InSyncDescrFile& descrL, const InSyncDescrFile& descrR, CompareVariant cmpVar, uint64_t fileSize, uint64_t contentHash)
     {
-            files.emplace(fileName, InSyncFile {descrL, descrR, cmpVar, fileSize});
+            files.emplace(fileName, InSyncFile {descrL, descrR, cmpVar, fileSize, contentHash});
         assert(inserted);
     }
 
@@ -79,9 +83,15 @@ struct InSyncFolder
 };
 
 
+AbstractPath getDatabaseFilePath(const AbstractPath& baseFolderPath);
+
 std::unordered_map<const BaseFolderPair*, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
         PhaseCallback& callback /*throw X*/); //throw X
 
+//before comparison: caller must ensure that both folders exist
+std::map<std::pair<AbstractPath, AbstractPath>, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::set<std::pair<AbstractPath, AbstractPath>>& folderPairs,
+        PhaseCallback& callback /*throw X*/); //throw X
+
 void saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, //throw X
                               PhaseCallback& callback /*throw X*/);
 }
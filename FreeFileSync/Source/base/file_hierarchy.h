@@ -151,6 +151,78 @@ class FilePair;
 class FolderPair;
 class BaseFolderPair;
 
+/* weak references to FileSystemObject without std::weak_ptr's atomic ref-counting: e.g. for grid views with millions of rows
+   - slots are reused after destruction of their object => generation detects stale IDs
+   - one table per FolderComparison, shared by all of its BaseFolderPair
+   - not thread-safe: items must only be destroyed while no view is reading, i.e. on the main thread
+     => sync workers don't destroy items, but mark them as removed on both sides: see ContainerObject::removeDoubleEmpty()      */
+struct ObjectId
+{
+    uint32_t slot       = 0;
+    uint32_t generation = 0; //0: null ID
+    bool operator==(const ObjectId&) const = default;
+};
+
+
+class ObjectIdTable
+{
+public:
+    ObjectIdTable() {}
+    ~ObjectIdTable() { assert(freeSlots_.size() == slots_.size()); } //all objects are expected to unregister before
+
+    ObjectId add(FileSystemObject& fsObj)
+    {
+        uint32_t slot = 0;
+        if (!freeSlots_.empty())
+        {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else
+        {
+            if (slots_.size() >= std::numeric_limits<uint32_t>::max())
+                throw std::length_error(std::string(__FILE__) + '[' + zen::numberTo<std::string>(__LINE__) + "] Too many items.");
+
+            slot = static_cast<uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+        slots_[slot].fsObj = &fsObj;
+        return {slot, slots_[slot].generation};
+    }
+
+    void remove(ObjectId id)
+    {
+        assert(get(id));
+        Slot& s = slots_[id.slot];
+        s.fsObj = nullptr;
+        if (++s.generation == 0) //wrap around: skip null ID
+            s.generation = 1;
+        freeSlots_.push_back(id.slot);
+    }
+
+    //returns nullptr if object was deleted meanwhile; complexity: constant, no allocations, no atomics
+    FileSystemObject* get(ObjectId id) const
+    {
+        if (id.slot < slots_.size())
+            if (const Slot& s = slots_[id.slot];
+                s.generation == id.generation)
+                return s.fsObj;
+        return nullptr;
+    }
+
+private:
+    ObjectIdTable           (const ObjectIdTable&) = delete;
+    ObjectIdTable& operator=(const ObjectIdTable&) = delete;
+
+    struct Slot
+    {
+        FileSystemObject* fsObj = nullptr;
+        uint32_t generation = 1;
+    };
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+};
+
 /*------------------------------------------------------------------
     inheritance diagram:
 
@@ -288,13 +360,22 @@ public:
                    const FilterRef& filter,
                    CompareVariant cmpVar,
                    unsigned int fileTimeTolerance,
-                   const std::vector<unsigned int>& ignoreTimeShiftMinutes) :
+                   const std::vector<unsigned int>& ignoreTimeShiftMinutes,
+                   const zen::SharedRef<ObjectIdTable>& objectIds) : //shared by all BaseFolderPair of a FolderComparison
         ContainerObject(*this), //trust that ContainerObject knows that *this is not yet fully constructed!
         filter_(filter), cmpVar_(cmpVar), fileTimeTolerance_(fileTimeTolerance), ignoreTimeShiftMinutes_(ignoreTimeShiftMinutes),
         folderStatusLeft_ (folderStatusLeft),
         folderStatusRight_(folderStatusRight),
         folderPathLeft_(folderPathLeft),
-        folderPathRight_(folderPathRight) {}
+        folderPathRight_(folderPathRight),
+        objectIds_(objectIds) {}
+
+    ~BaseFolderPair()
+    {
+        clearFiles();      //child items unregister from objectIds_:
+        clearSymlinks();   //destroy them *before* our members
+        clearSubfolders(); //
+    }
 
     template <SelectSide side> BaseFolderStatus getFolderStatus() const; //base folder status at the time of comparison!
     template <SelectSide side> void setFolderStatus(BaseFolderStatus value); //update after creating the directory in FFS
@@ -305,6 +386,10 @@ public:
     unsigned int getFileTimeTolerance() const { return fileTimeTolerance_; }
     const std::vector<unsigned int>& getIgnoredTimeShift() const { return ignoreTimeShiftMinutes_; }
 
+    /**/  ObjectIdTable& getObjectIds()       { return objectIds_.ref(); }
+    const ObjectIdTable& getObjectIds() const { return objectIds_.ref(); }
+    const zen::SharedRef<ObjectIdTable>& getObjectIdsRef() { return objectIds_; }
+
     void flip() override;
 
 private:
@@ -321,6 +406,8 @@ private:
 
     AbstractPath folderPathLeft_;
     AbstractPath folderPathRight_;
+
+    zen::SharedRef<ObjectIdTable> objectIds_;
 };
 
 
@@ -378,6 +465,8 @@ public:
     const BaseFolderPair& base() const { return parent_.getBase(); }
     /**/  BaseFolderPair& base()       { return parent_.getBase(); }
 
+    ObjectId getId() const { return id_; } //see ObjectIdTable
+
     bool passFileFilter(const PathFilter& filter) const; //optimized for perf!
 
     virtual void flip();
@@ -391,14 +480,18 @@ protected:
                      ContainerObject& parentObj) :
         itemNameL_(itemNameL),
         itemNameR_(itemNameL == itemNameR ? itemNameL : itemNameR), //perf: no measurable speed drawback; -3% peak memory => further needed by ContainerObject construction!
-        parent_(parentObj)
+        parent_(parentObj),
+        id_(parentObj.getBase().getObjectIds().add(*this))
     {
         assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_); //also checks ref-counted string precondition
         FileSystemObject::notifySyncCfgChanged(); //non-virtual call! (=> anyway in a constructor!)
     }
 
     virtual ~FileSystemObject() //don't need polymorphic deletion, but we have a vtable anyway
-    { assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_); }
+    {
+        assert(itemNameL_.c_str() == itemNameR_.c_str() || itemNameL_ != itemNameR_);
+        base().getObjectIds().remove(id_);
+    }
 
     virtual void notifySyncCfgChanged()
     {
@@ -428,6 +521,7 @@ private:
     Zstring itemNameR_; //class invariant: same Zstring.c_str() pointer iff equal!
 
     ContainerObject& parent_;
+    const ObjectId id_;
 };
 
 //------------------------------------------------------------------
@@ -527,6 +621,9 @@ public:
     void setContentCategory(FileContentCategory category);
     FileContentCategory getContentCategory() const;
 
+    void setContentHash(uint64_t contentHash) { contentHash_ = contentHash; } //call after setSyncedTo()
+    uint64_t getContentHash() const { return contentHash_; } //optional: 0 if unknown
+
     template <SelectSide side> void removeItem();
 
 private:
@@ -542,6 +639,8 @@ private:
 
     FileContentCategory contentCategory_ = FileContentCategory::unknown;
     Zstringc categoryDescr_; //optional: custom category description (e.g. FileContentCategory::conflict or invalidTime)
+
+    uint64_t contentHash_ = 0; //optional: XXH64 of the (identical) content of both sides, as computed during file copy
 };
 
 //------------------------------------------------------------------
@@ -827,6 +926,7 @@ void FilePair::removeItem()
 
     selectParam<side>(attrL_, attrR_) = FileAttributes();
     contentCategory_ = FileContentCategory::unknown;
+    contentHash_ = 0;
     removeFsObject<side>();
 }
 
@@ -1410,6 +1510,7 @@ void FilePair::setSyncedTo(uint64_t fileSize,
     setItemName<sideTrg>(getItemName<getOtherSide<sideTrg>>());
 
     contentCategory_ = FileContentCategory::equal;
+    contentHash_ = 0; //unknown unless set by caller
     categoryDescr_.clear();
     setSyncDir(SyncDirection::none);
 }
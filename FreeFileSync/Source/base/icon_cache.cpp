@@ -0,0 +1,299 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "icon_cache.h"
+#include <unordered_map>
+#include <zen/globals.h>
+#include <zen/file_io.h>
+#include <zen/file_access.h>
+#include <zen/serialize.h>
+#include <zen/extra_log.h>
+
+    #include <sys/mman.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const char ICON_CACHE_FILE_DESCR[] = "FreeFileSync Icon Cache";
+const int ICON_CACHE_FILE_VERSION = 1;
+
+const size_t ICON_CACHE_BYTES_MAX = 64 * 1024 * 1024; //pixel data to keep on disk
+const int ICON_CACHE_PIXEL_SIZE_MAX = 1024;           //sanity check while loading
+
+
+class IconCache
+{
+public:
+    explicit IconCache(const Zstring& filePath) : filePath_(filePath)
+    {
+        try
+        {
+            if (itemExists(filePath_)) //throw FileError
+                load(); //throw FileError, SysError
+        }
+        catch (const FileError& e) { logExtraError(e.toString()); }
+        catch (SysError&) //corrupted or outdated format: it's only a cache!
+        {
+            entries_.clear();
+            unmap();
+        }
+    }
+
+    ~IconCache() { unmap(); }
+
+    bool contains(const std::string& key)
+    {
+        std::lock_guard dummy(lockEntries_);
+        return entries_.contains(key);
+    }
+
+    ImageHolder get(const std::string& key)
+    {
+        std::lock_guard dummy(lockEntries_);
+
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+            return {};
+
+        Entry& entry = it->second;
+        if (entry.lastUse != sessionTime_)
+        {
+            entry.lastUse = sessionTime_; //save on exit: keep entries in use
+            modified_ = true;
+        }
+
+        const std::string_view pixels = entry.getPixels();
+        const size_t pixelCount = static_cast<size_t>(entry.width) * entry.height;
+
+        ImageHolder img(entry.width, entry.height, true /*withAlpha*/);
+        std::memcpy(img.getRgb  (), pixels.data(),                  pixelCount * 3);
+        std::memcpy(img.getAlpha(), pixels.data() + pixelCount * 3, pixelCount);
+        return img;
+    }
+
+    void set(const std::string& key, ImageHolder& img)
+    {
+        if (!img || !img.getAlpha() || img.getWidth() <= 0 || img.getHeight() <= 0)
+            return;
+
+        const size_t pixelCount = static_cast<size_t>(img.getWidth()) * img.getHeight();
+
+        std::string pixels(reinterpret_cast<const char*>(img.getRgb()), pixelCount * 3);
+        pixels.append(reinterpret_cast<const char*>(img.getAlpha()), pixelCount);
+
+        std::lock_guard dummy(lockEntries_);
+
+        Entry& entry = entries_[key];
+        entry.width  = img.getWidth();
+        entry.height = img.getHeight();
+        entry.lastUse = sessionTime_;
+        entry.pixelsMapped = {};
+        entry.pixelsNew.swap(pixels);
+        modified_ = true;
+    }
+
+    void save() //throw FileError
+    {
+        std::lock_guard dummy(lockEntries_);
+        if (!modified_)
+            return;
+
+        //keep most recently used entries only:
+        std::vector<const std::pair<const std::string, Entry>*> items;
+        for (const auto& item : entries_)
+            items.push_back(&item);
+
+        std::sort(items.begin(), items.end(), [](const auto* lhs, const auto* rhs) { return lhs->second.lastUse > rhs->second.lastUse; });
+
+        size_t pixelBytes = 0;
+        for (auto it = items.begin(); it != items.end(); ++it)
+            if ((pixelBytes += (*it)->second.getPixels().size()) > ICON_CACHE_BYTES_MAX)
+            {
+                items.erase(it, items.end());
+                break;
+            }
+
+        MemoryStreamOut streamOut;
+        writeArray(streamOut, ICON_CACHE_FILE_DESCR, sizeof(ICON_CACHE_FILE_DESCR));
+        writeNumber<int32_t>(streamOut, ICON_CACHE_FILE_VERSION);
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(items.size()));
+
+        uint64_t pixelsOffset = 0;
+        for (const auto* item : items)
+        {
+            const auto& [key, entry] = *item;
+            writeContainer<std::string>(streamOut, key);
+            writeNumber<int32_t>(streamOut, entry.width);
+            writeNumber<int32_t>(streamOut, entry.height);
+            writeNumber<int64_t>(streamOut, entry.lastUse);
+            writeNumber<uint64_t>(streamOut, pixelsOffset);
+            pixelsOffset += entry.getPixels().size();
+        }
+
+        //pixel data last: not paged in until needed
+        for (const auto* item : items)
+        {
+            const std::string_view pixels = item->second.getPixels();
+            writeArray(streamOut, pixels.data(), pixels.size());
+        }
+
+        setFileContent(filePath_, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        modified_ = false;
+    }
+
+private:
+    IconCache           (const IconCache&) = delete;
+    IconCache& operator=(const IconCache&) = delete;
+
+    void load() //throw FileError, SysError
+    {
+        {
+            FileInputPlain fileIn(filePath_); //throw FileError, ErrorFileLocked
+
+            const size_t fileSize = makeUnsigned(fileIn.getStatBuffered().st_size); //throw FileError
+            if (fileSize == 0)
+                throw SysError(_("File content is corrupted.") + L" (empty file)");
+
+            void* const mapping = ::mmap(nullptr,           //void* addr
+                                         fileSize,          //size_t length
+                                         PROT_READ,         //int prot
+                                         MAP_PRIVATE,       //int flags
+                                         fileIn.getHandle(), //int fd
+                                         0);                //off_t offset
+            if (mapping == MAP_FAILED)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath_)), "mmap");
+
+            mapping_ = {static_cast<const char*>(mapping), fileSize};
+        } //file handle not needed anymore: mapping stays valid
+
+        MemoryStreamIn streamIn(mapping_);
+
+        char formatDescr[sizeof(ICON_CACHE_FILE_DESCR)] = {};
+        readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(std::begin(formatDescr), std::end(formatDescr), std::begin(ICON_CACHE_FILE_DESCR)))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+        if (version != ICON_CACHE_FILE_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        struct IndexItem
+        {
+            std::string key;
+            Entry entry;
+            uint64_t pixelsOffset = 0;
+        };
+        std::vector<IndexItem> index;
+
+        for (uint32_t i = readNumber<uint32_t>(streamIn); i-- > 0;) //throw SysErrorUnexpectedEos
+        {
+            IndexItem& item = index.emplace_back(); //don't reserve() a corrupted item count
+            item.key           = readContainer<std::string>(streamIn); //
+            item.entry.width   = readNumber<int32_t>(streamIn);        //
+            item.entry.height  = readNumber<int32_t>(streamIn);        //throw SysErrorUnexpectedEos
+            item.entry.lastUse = readNumber<int64_t>(streamIn);        //
+            item.pixelsOffset  = readNumber<uint64_t>(streamIn);       //
+        }
+
+        const std::string_view pixelData = mapping_.substr(streamIn.pos());
+
+        for (IndexItem& item : index)
+        {
+            if (item.entry.width  <= 0 || item.entry.width  > ICON_CACHE_PIXEL_SIZE_MAX ||
+                item.entry.height <= 0 || item.entry.height > ICON_CACHE_PIXEL_SIZE_MAX)
+                throw SysError(_("File content is corrupted.") + L" (invalid image size)");
+
+            const size_t pixelBytes = static_cast<size_t>(item.entry.width) * item.entry.height * 4;
+            if (item.pixelsOffset > pixelData.size() || pixelBytes > pixelData.size() - item.pixelsOffset)
+                throw SysErrorUnexpectedEos();
+
+            item.entry.pixelsMapped = pixelData.substr(item.pixelsOffset, pixelBytes);
+            entries_.emplace(std::move(item.key), std::move(item.entry));
+        }
+    }
+
+    void unmap()
+    {
+        if (!mapping_.empty())
+        {
+            [[maybe_unused]] const int rv = ::munmap(const_cast<char*>(mapping_.data()), mapping_.size());
+            assert(rv == 0);
+            mapping_ = {};
+        }
+    }
+
+    struct Entry
+    {
+        int width  = 0;
+        int height = 0;
+        time_t lastUse = 0;
+        std::string_view pixelsMapped; //RGB + alpha: either reference into memory mapping
+        std::string pixelsNew;         //...or added during this session
+
+        std::string_view getPixels() const { return pixelsNew.empty() ? pixelsMapped : pixelsNew; }
+    };
+
+    const Zstring filePath_;
+    const time_t sessionTime_ = std::time(nullptr);
+
+    std::string_view mapping_; //read-only: MAP_PRIVATE
+
+    std::mutex lockEntries_;
+    std::unordered_map<std::string, Entry> entries_;
+    bool modified_ = false;
+};
+
+
+constinit Global<IconCache> globalIconCache;
+}
+
+
+void fff::iconCacheInit(const Zstring& filePath)
+{
+    assert(!globalIconCache.get());
+    globalIconCache.set(std::make_unique<IconCache>(filePath));
+}
+
+
+void fff::iconCacheTeardown()
+{
+    try
+    {
+        if (const std::shared_ptr<IconCache> cache = globalIconCache.get())
+            cache->save(); //throw FileError
+    }
+    catch (const FileError& e) { logExtraError(e.toString()); }
+
+    assert(globalIconCache.get());
+    globalIconCache.set(nullptr);
+}
+
+
+bool fff::iconCacheContains(const std::string& key)
+{
+    if (const std::shared_ptr<IconCache> cache = globalIconCache.get())
+        return cache->contains(key);
+    return false;
+}
+
+
+ImageHolder fff::iconCacheGet(const std::string& key)
+{
+    if (const std::shared_ptr<IconCache> cache = globalIconCache.get())
+        return cache->get(key);
+    return {};
+}
+
+
+void fff::iconCacheSet(const std::string& key, ImageHolder& img)
+{
+    if (const std::shared_ptr<IconCache> cache = globalIconCache.get())
+        cache->set(key, img);
+}
@@ -0,0 +1,31 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ICON_CACHE_H_2384750238457023487
+#define ICON_CACHE_H_2384750238457023487
+
+#include <zen/zstring.h>
+#include <wx+/image_holder.h>
+
+
+namespace fff
+{
+/* persistent buffer for file icons and thumbnails: avoid repeating the same GIO/GTK lookups and image decoding after each program start
+   - memory-mapped file: pixel data is only paged in when needed
+   - keyed by icon theme + themed icon (i.e. MIME type) + icon size, thumbnails by file path + modification time + size
+   - most recently used entries are kept up to a total size limit
+
+   => all functions are safe to call from multiple threads!
+   => iconCacheGet()/iconCacheSet() are no-op if not initialized, e.g. RealTimeSync */
+void iconCacheInit(const Zstring& filePath);
+void iconCacheTeardown(); //save new entries
+
+bool iconCacheContains(const std::string& key);
+zen::ImageHolder iconCacheGet(const std::string& key); //returns empty holder if not buffered
+void iconCacheSet(const std::string& key, zen::ImageHolder& img); //copies pixel data; images without alpha channel are not buffered
+}
+
+#endif //ICON_CACHE_H_2384750238457023487
@@ -6,6 +6,8 @@
 
 #include "icon_loader.h"
 #include <zen/thread.h> //includes <std/thread.hpp>
+#include <zen/globals.h>
+#include "icon_cache.h"
 
     #include <gtk/gtk.h>
     #include <sys/stat.h>
@@ -152,6 +154,53 @@ ImageHolder imageHolderFromGicon(GIcon& gicon, int maxSize) //throw SysError
     //we may have to shrink (e.g. openSUSE + GTK3): "an icon theme may have icons that differ slightly from their nominal sizes"
     return copyToImageHolder(*pixBuf, maxSize); //throw SysError
 }
+
+
+//same themed icon looks different after switching icon theme, or GTK theme (e.g. dark mode: symbolic icons are recolored)
+//=> part of the cache key: stale icons of other themes age out of the cache
+constinit Global<Protected<std::string>> globalIconThemeKey;
+GLOBAL_RUN_ONCE(globalIconThemeKey.set(std::make_unique<Protected<std::string>>()));
+
+
+void updateIconThemeKey()
+{
+    assert(runningOnMainThread()); //GTK is NOT thread safe!!!
+
+    std::string themeKey;
+    if (GtkSettings* const settings = ::gtk_settings_get_default()) //not owned!
+    {
+        gchar* iconThemeName = nullptr;
+        gchar* themeName = nullptr;
+        gboolean preferDark = FALSE;
+        ::g_object_get(settings,
+                       "gtk-icon-theme-name",               &iconThemeName,
+                       "gtk-theme-name",                    &themeName,
+                       "gtk-application-prefer-dark-theme", &preferDark,
+                       nullptr);
+        ZEN_ON_SCOPE_EXIT(::g_free(iconThemeName); ::g_free(themeName));
+
+        themeKey = std::string(iconThemeName ? iconThemeName : "") + '|' + (themeName ? themeName : "") + (preferDark ? "|dark" : "");
+    }
+
+    if (const std::shared_ptr<Protected<std::string>> themeKeyBuf = globalIconThemeKey.get())
+        themeKeyBuf->access([&](std::string& key) { key = std::move(themeKey); });
+}
+
+
+std::string getIconCacheKey(GIcon& gicon, int maxSize) //returns empty string if icon has no persistent representation
+{
+    gchar* const iconStr = ::g_icon_to_string(&gicon); //e.g. themed icon: list of icon names derived from MIME type
+    if (!iconStr)
+        return {};
+    ZEN_ON_SCOPE_EXIT(::g_free(iconStr));
+
+    //theme key is updated on main thread only: worker threads (getFileIcon()) might use an outdated key for a while => no harm: image is looked up by extractWxImage()
+    std::string themeKey;
+    if (const std::shared_ptr<Protected<std::string>> themeKeyBuf = globalIconThemeKey.get())
+        themeKeyBuf->access([&](const std::string& key) { themeKey = key; });
+
+    return "icon|" + themeKey + '|' + std::string(iconStr) + '|' + numberTo<std::string>(maxSize);
+}
 }
 
 
@@ -222,6 +271,25 @@ FileIconHolder fff::getFileManagerIcon(int maxSize) //throw SysError
 
 FileIconHolder fff::getFileIcon(const Zstring& filePath, int maxSize) //throw SysError
 {
+    //perf: g_file_query_info() is slow (file I/O + content sniffing) => skip if file name alone is conclusive and its icon is buffered already
+    gboolean uncertain = TRUE;
+    if (gchar* const contentType = ::g_content_type_guess(filePath.c_str(), //const gchar* filename
+                                                          nullptr,          //const guchar* data
+                                                          0,                //gsize data_size
+                                                          &uncertain))      //gboolean* result_uncertain
+    {
+        ZEN_ON_SCOPE_EXIT(::g_free(contentType));
+
+        if (!uncertain)
+            if (GIcon* const guessIcon = ::g_content_type_get_icon(contentType))
+            {
+                if (iconCacheContains(getIconCacheKey(*guessIcon, maxSize)))
+                    return FileIconHolder(guessIcon /*pass ownership*/, maxSize);
+
+                ::g_object_unref(guessIcon);
+            }
+    }
+
     GFile* file = ::g_file_new_for_path(filePath.c_str()); //documented to "never fail"
     ZEN_ON_SCOPE_EXIT(::g_object_unref(file));
 
@@ -260,6 +328,11 @@ ImageHolder fff::getThumbnailImage(const Zstring& filePath, int maxSize) //throw
     if (!S_ISREG(fileInfo.st_mode)) //skip blocking file types, e.g. named pipes, see file_io.cpp
         throw SysError(_("Unsupported item type.") + L" [" + printNumber<std::wstring>(L"0%06o", fileInfo.st_mode & S_IFMT) + L']');
 
+    const std::string cacheKey = "thumb|" + utfTo<std::string>(filePath) + '|' + numberTo<std::string>(fileInfo.st_mtime) + '|' +
+                                 numberTo<std::string>(fileInfo.st_size) + '|' + numberTo<std::string>(maxSize);
+    if (ImageHolder img = iconCacheGet(cacheKey))
+        return img;
+
     GError* error = nullptr;
     ZEN_ON_SCOPE_EXIT(if (error) ::g_error_free(error));
 
@@ -268,8 +341,9 @@ ImageHolder fff::getThumbnailImage(const Zstring& filePath, int maxSize) //throw
         throw SysError(formatGlibError("gdk_pixbuf_new_from_file", error));
     ZEN_ON_SCOPE_EXIT(::g_object_unref(pixBuf));
 
-    return copyToImageHolder(*pixBuf, maxSize); //throw SysError
-
+    ImageHolder img = copyToImageHolder(*pixBuf, maxSize); //throw SysError
+    iconCacheSet(cacheKey, img);
+    return img;
 }
 
 
@@ -300,7 +374,17 @@ wxImage fff::extractWxImage(zen::FileIconHolder&& fih)
     if (GIcon* gicon = fih.gicon.get())
         try
         {
-            img = extractWxImage(imageHolderFromGicon(*gicon, fih.maxSize)); //throw SysError
+            updateIconThemeKey();
+            const std::string cacheKey = getIconCacheKey(*gicon, fih.maxSize);
+
+            ImageHolder ih = cacheKey.empty() ? ImageHolder() : iconCacheGet(cacheKey);
+            if (!ih)
+            {
+                ih = imageHolderFromGicon(*gicon, fih.maxSize); //throw SysError
+                if (!cacheKey.empty())
+                    iconCacheSet(cacheKey, ih);
+            }
+            img = extractWxImage(std::move(ih));
         }
         catch (SysError&) {} //might fail if icon theme is missing a MIME type!
 
@@ -215,22 +215,43 @@ struct TraverserConfig
     std::unordered_map<Zstring, Zstringc>& failedDirReads;
     std::unordered_map<Zstring, Zstringc>& failedItemReads;
 
+    const FolderChanges* const changes; //optional: incremental scan
+
     AsyncCallback& acb;
     const int threadIdx;
     std::chrono::steady_clock::time_point& lastReportTime; //thread-level
 };
 
 
+bool containsSubPath(const std::set<Zstring>& relPaths, const Zstring& relPath)
+{
+    const Zstring relPathPf = relPath + FILE_NAME_SEPARATOR;
+    auto it = relPaths.lower_bound(relPathPf); //sub paths are sorted contiguously after relPathPf
+    return it != relPaths.end() && startsWith(*it, relPathPf);
+}
+
+
+//=> folder needs to be listed, although the unchanged part of its sub folders may be taken from last known state
+bool folderContainsChanges(const FolderChanges& changes, const Zstring& relPath)
+{
+    return changes.staleFolders.contains(relPath) ||
+           containsSubPath(changes.staleFolders, relPath) ||
+           containsSubPath(changes.changedItems, relPath);
+}
+
+
 class DirCallback : public AFS::TraverserCallback
 {
 public:
     DirCallback(TraverserConfig& cfg,
                 Zstring&& parentRelPathPf, //postfixed with FILE_NAME_SEPARATOR (or empty!)
                 FolderContainer& output,
+                const FolderContainer* lastKnown, //optional: incremental scan
                 int level) :
         cfg_(cfg),
         parentRelPathPf_(std::move(parentRelPathPf)),
         output_(output),
+        lastKnown_(lastKnown),
         level_(level) {} //MUST NOT use cfg_ during construction! see BaseDirCallback()
 
     virtual void                               onFile   (const AFS::FileInfo&    fi) override; //
@@ -243,9 +264,13 @@ public:
 private:
     HandleError reportError(const ErrorInfo& errorInfo, const Zstring& itemName /*optional*/); //throw ThreadStopRequest
 
+    const FolderContainer* getUnchangedLastKnown(const AFS::FolderInfo& fi, const Zstring& relPath) const;
+    void addLastKnownState(const FolderContainer& lastKnown, const Zstring& parentRelPathPf, FolderContainer& output); //throw ThreadStopRequest
+
     TraverserConfig& cfg_;
     const Zstring parentRelPathPf_;
     FolderContainer& output_;
+    const FolderContainer* const lastKnown_;
     const int level_;
 };
 
@@ -253,9 +278,10 @@ private:
 class BaseDirCallback : public DirCallback
 {
 public:
-    BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output,
+    BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output, const FolderChanges* changes,
                     AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
-        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont, 0 /*level*/),
+        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont,
+                    changes ? &changes->lastKnownState.ref() : nullptr, 0 /*level*/), //base folder is always listed
         travCfg_
         {
             baseFolderKey.folderPath,
@@ -263,6 +289,7 @@ public:
             baseFolderKey.handleSymlinks,
             output.failedFolderReads,
             output.failedItemReads,
+            changes,
             acb,
             threadIdx,
             lastReportTime,
@@ -327,6 +354,14 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
     if (passFilter)
         cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 
+    //------------------------------------------------------------------------------------
+    const FolderContainer* lastKnownSub = getUnchangedLastKnown(fi, relPath);
+    if (lastKnownSub && !folderContainsChanges(*cfg_.changes, relPath))
+    {
+        addLastKnownState(*lastKnownSub, relPath + FILE_NAME_SEPARATOR, subFolder); //throw ThreadStopRequest
+        return nullptr; //nothing changed since last sync => no need to traverse
+    }
+
     //------------------------------------------------------------------------------------
     if (level_ > FOLDER_TRAVERSAL_LEVEL_MAX) //Win32 traverser: stack overflow approximately at level 1000
         //check after FolderContainer::addFolder()
@@ -340,7 +375,61 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
                     return nullptr;
             }
 
-    return std::make_shared<DirCallback>(cfg_, std::move(relPath += FILE_NAME_SEPARATOR), subFolder, level_ + 1);
+    return std::make_shared<DirCallback>(cfg_, std::move(relPath += FILE_NAME_SEPARATOR), subFolder, lastKnownSub, level_ + 1);
+}
+
+
+const FolderContainer* DirCallback::getUnchangedLastKnown(const AFS::FolderInfo& fi, const Zstring& relPath) const
+{
+    if (!lastKnown_ || fi.isFollowedSymlink) //changes of symlink targets are not reported
+        return nullptr;
+
+    if (cfg_.changes->changedItems.contains(relPath)) //e.g. folder was replaced => last known state is worthless
+        return nullptr;
+
+    if (auto it = lastKnown_->folders.find(fi.itemName);
+        it != lastKnown_->folders.end())
+        return &it->second.second;
+
+    return nullptr; //new folder
+}
+
+
+void DirCallback::addLastKnownState(const FolderContainer& lastKnown, const Zstring& parentRelPathPf, FolderContainer& output) //throw ThreadStopRequest
+{
+    interruptionPoint(); //throw ThreadStopRequest
+
+    //apply current filter: might have changed since last sync
+    for (const auto& [fileName, attr] : lastKnown.files)
+        if (cfg_.filter.ref().passFileFilter(parentRelPathPf + fileName))
+        {
+            output.addFile(fileName, attr);
+            cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+        }
+
+    if (cfg_.handleSymlinks == SymLinkHandling::asLink)
+        for (const auto& [linkName, attr] : lastKnown.symlinks)
+            if (cfg_.filter.ref().passFileFilter(parentRelPathPf + linkName))
+            {
+                output.addSymlink(linkName, attr);
+                cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+            }
+
+    for (const auto& [folderName, attrAndSub] : lastKnown.folders)
+    {
+        const Zstring& relPath = parentRelPathPf + folderName;
+
+        bool childItemMightMatch = true;
+        const bool passFilter = cfg_.filter.ref().passDirFilter(relPath, &childItemMightMatch);
+        if (!passFilter && !childItemMightMatch)
+            continue;
+
+        FolderContainer& subFolder = output.addFolder(folderName, attrAndSub.first);
+        if (passFilter)
+            cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
+
+        addLastKnownState(attrAndSub.second, relPath + FILE_NAME_SEPARATOR, subFolder); //throw ThreadStopRequest
+    }
 }
 
 
@@ -402,10 +491,32 @@ DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, co
     }
     return handleErr;
 }
+
+
+//save round-trips during synchronization, e.g. FTP: AFS::itemExistsBuffered() before versioning
+void bufferItemTypes(const AbstractPath& folderPath, const FolderContainer& folderCont)
+{
+    for (const auto& [fileName, attr] : folderCont.files)
+        if (!attr.isFollowedSymlink) //AFS::getItemType() does not follow symlinks
+            AFS::bufferItemType(AFS::appendRelPath(folderPath, fileName), AFS::ItemType::file);
+
+    for (const auto& [linkName, attr] : folderCont.symlinks)
+        AFS::bufferItemType(AFS::appendRelPath(folderPath, linkName), AFS::ItemType::symlink);
+
+    for (const auto& [folderName, attrAndSub] : folderCont.folders)
+    {
+        const AbstractPath subFolderPath = AFS::appendRelPath(folderPath, folderName);
+        if (!attrAndSub.first.isFollowedSymlink)
+            AFS::bufferItemType(subFolderPath, AFS::ItemType::folder);
+
+        bufferItemTypes(subFolderPath, attrAndSub.second);
+    }
+}
 }
 
 
 std::map<DirectoryKey, DirectoryValue> fff::parallelFolderScan(const std::set<DirectoryKey>& foldersToRead,
+                                                               const std::map<DirectoryKey, FolderChanges>& folderChanges,
                                                                const TravErrorCb& onError, const TravStatusCb& onStatusUpdate,
                                                                std::chrono::milliseconds cbInterval)
 {
@@ -420,6 +531,9 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelFolderScan(const std::set<Di
     for (const DirectoryKey& key : foldersToRead)
         perDeviceFolders[key.folderPath.afsDevice].insert(key);
 
+    for (const auto& [afsDevice, dirKeys] : perDeviceFolders)
+        AFS::clearItemTypeBuffer(afsDevice); //buffer is refilled below
+
     //communication channel used by threads
     AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
 
@@ -435,10 +549,14 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelFolderScan(const std::set<Di
                              utfTo<Zstring>(AFS::getDisplayPath({afsDevice, AfsPath()}));
 
         const size_t parallelOps = 1;
-        std::map<DirectoryKey, DirectoryValue*> workload;
+        std::map<DirectoryKey, std::pair<DirectoryValue*, const FolderChanges*>> workload;
 
         for (const DirectoryKey& key : dirKeys)
-            workload.emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
+        {
+            auto itChanges = folderChanges.find(key);
+            workload.emplace(key, std::pair(&output[key], //=> DirectoryValue* unshared for lock-free worker-thread access
+                                            itChanges != folderChanges.end() ? &itChanges->second : nullptr));
+        }
 
         worker.emplace_back([afsDevice, workload, threadIdx, &acb, parallelOps, threadName = std::move(threadName)] mutable
         {
@@ -451,15 +569,25 @@ std::map<DirectoryKey, DirectoryValue> fff::parallelFolderScan(const std::set<Di
 
             AFS::TraverserWorkload travWorkload;
 
-            for (auto& [folderKey, folderVal] : workload)
+            for (auto& [folderKey, folderValAndChanges] : workload)
             {
                 assert(folderKey.folderPath.afsDevice == afsDevice);
-                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime));
+                auto& [folderVal, changes] = folderValAndChanges;
+                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, changes, acb, threadIdx, lastReportTime));
             }
             AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadStopRequest
         });
     }
     acb.waitUntilDone(onError, onStatusUpdate); //throw X
 
+    for (const auto& [folderKey, folderVal] : output)
+        if (AFS::hasSlowItemAccess(folderKey.folderPath.afsDevice))
+        {
+            if (!folderVal.failedFolderReads.contains(Zstring()))
+                AFS::bufferItemType(folderKey.folderPath, AFS::ItemType::folder);
+
+            bufferItemTypes(folderKey.folderPath, folderVal.folderCont);
+        }
+
     return output;
 }
@@ -40,6 +40,15 @@ struct DirectoryValue
 };
 
 
+//incremental scan: traverse changed folders only, take the unchanged ones from the last known state (e.g. sync.ffs_db)
+struct FolderChanges
+{
+    zen::SharedRef<const FolderContainer> lastKnownState;
+    std::set<Zstring> changedItems; //relative paths (never empty): traverse completely (if folder) + list parent folder
+    std::set<Zstring> staleFolders; //relative paths (never empty): list again, but unchanged subfolders may still be taken from last known state
+};
+
+
 //Attention: 1. ensure directory filtering is applied later to exclude filtered folders which have been kept as parent folders
 //           2. remove folder aliases (e.g. case differences) *before* calling this function!!!
 
@@ -47,6 +56,7 @@ using TravErrorCb  = std::function<PhaseCallback::Response(const PhaseCallback::
 using TravStatusCb = std::function<void(const std::wstring& statusLine, int itemsTotal)>;
 
 std::map<DirectoryKey, DirectoryValue> parallelFolderScan(const std::set<DirectoryKey>& foldersToRead,
+                                                          const std::map<DirectoryKey, FolderChanges>& folderChanges, //optional: incremental scan
                                                           const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //NOT optional
                                                           std::chrono::milliseconds cbInterval);
 }
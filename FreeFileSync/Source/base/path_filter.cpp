@@ -109,6 +109,18 @@ void NameFilter::MaskMatcher::insert(const Zstring& mask)
 }
 
 
+void NameFilter::MaskMatcher::addToHash(XXHash64& hash) const
+{
+    for (const std::set<Zstring>* masks : {&realMasks_, &relPathsCmp_})
+    {
+        for (const Zstring& mask : *masks)
+            hash.add(mask.c_str(), (mask.size() + 1) * sizeof(mask[0])); //include 0-termination as separator
+
+        hash.add("", sizeof(Zchar)); //empty item: end of list
+    }
+}
+
+
 namespace
 {
 template <bool allowParentMatch>
@@ -314,6 +326,18 @@ bool NameFilter::isNull() const
 }
 
 
+uint64_t NameFilter::getFingerprint() const
+{
+    XXHash64 hash;
+    for (const FilterSet* filterSet : {&includeFilter, &excludeFilter})
+    {
+        filterSet->fileMasks  .addToHash(hash);
+        filterSet->folderMasks.addToHash(hash);
+    }
+    return hash.get();
+}
+
+
 std::strong_ordering NameFilter::compareSameType(const PathFilter& other) const
 {
     assert(typeid(*this) == typeid(other)); //always given in this context!
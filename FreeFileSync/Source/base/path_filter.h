@@ -9,6 +9,7 @@
 
 #include <unordered_set>
 #include <zen/zstring.h>
+#include <zen/xxhash.h>
 
 
 namespace fff
@@ -44,6 +45,8 @@ public:
 
     virtual FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const = 0;
 
+    virtual uint64_t getFingerprint() const = 0; //equal filters => equal fingerprints; e.g. detect filter changes since last sync (sync.ffs_db)
+
 private:
     friend std::strong_ordering operator<=>(const FilterRef& lhs, const FilterRef& rhs);
 
@@ -62,6 +65,7 @@ public:
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
     bool isNull() const override { return true; }
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
+    uint64_t getFingerprint() const override { return 0; }
 
 private:
     std::strong_ordering compareSameType(const PathFilter& other) const override { assert(typeid(*this) == typeid(other)); return std::strong_ordering::equal; }
@@ -81,6 +85,7 @@ public:
     bool isNull() const override;
     static bool isNull(const Zstring& includePhrase, const Zstring& excludePhrase); //*fast* check without expensive NameFilter construction!
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
+    uint64_t getFingerprint() const override;
 
 private:
     friend class CombinedFilter;
@@ -95,6 +100,8 @@ private:
         bool matches(const ZstringView relPath) const;
         bool matchesBegin(const ZstringView relPath) const;
 
+        void addToHash(zen::XXHash64& hash) const;
+
         inline friend std::strong_ordering operator<=>(const MaskMatcher& lhs, const MaskMatcher& rhs)
         {
             return std::tie(lhs.realMasks_, lhs.relPathsCmp_) <=>
@@ -137,6 +144,7 @@ public:
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
     bool isNull() const override;
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
+    uint64_t getFingerprint() const override;
 
 private:
     std::strong_ordering compareSameType(const PathFilter& other) const override;
@@ -217,6 +225,17 @@ FilterRef CombinedFilter::copyFilterAddingExclusion(const Zstring& excludePhrase
 }
 
 
+inline
+uint64_t CombinedFilter::getFingerprint() const
+{
+    const uint64_t fp[] = {first_.getFingerprint(), second_.getFingerprint()};
+
+    zen::XXHash64 hash;
+    hash.add(fp, sizeof(fp));
+    return hash.get();
+}
+
+
 inline
 std::strong_ordering CombinedFilter::compareSameType(const PathFilter& other) const
 {
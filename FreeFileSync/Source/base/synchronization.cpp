@@ -656,20 +656,25 @@ void flushFileBuffers(const Zstring& nativeFilePath) //throw FileError
 
     if (::fsync(fdFile) != 0)
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativeFilePath)), "fsync");
+
+    //pages are clean after fsync() => can be dropped: subsequent read hits the disk rather than the page cache
+    //no error handling: just a hint, verification still works (though less strictly) without
+    ::posix_fadvise(fdFile, 0 /*offset*/, 0 /*len*/, POSIX_FADV_DONTNEED); //"len == 0" means "end of the file"
 }
 
 
-void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+//sourceHash: optional (0 if unknown), computed while copying => no need to read source again
+void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, uint64_t sourceHash, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
     try
     {
-        //do like "copy /v": 1. flush target file buffers, 2. read again as usual (using OS buffers)
-        // => it seems OS buffers are not invalidated by this: snake oil???
+        //do like "copy /v": 1. flush target file buffers, 2. read again (native: bypass OS buffers)
         if (const Zstring& targetPathNative = getNativeItemPath(targetPath);
             !targetPathNative.empty())
             flushFileBuffers(targetPathNative); //throw FileError
 
-        if (!filesHaveSameContent(sourcePath, targetPath, notifyUnbufferedIO)) //throw FileError, X
+        if (sourceHash != 0 ? getFileContentHash(targetPath, notifyUnbufferedIO) != sourceHash : //throw FileError, X
+            !filesHaveSameContent(sourcePath, targetPath, notifyUnbufferedIO)) //throw FileError, X
             throw FileError(replaceCpy(replaceCpy(_("%x and %y have different content."),
                                                   L"%x", L'\n' + fmtPath(AFS::getDisplayPath(sourcePath))),
                                        L"%y", L'\n' + fmtPath(AFS::getDisplayPath(targetPath))));
@@ -711,8 +716,8 @@ void moveAndRenameItem(const AbstractPath& pathFrom, const AbstractPath& pathTo,
 { parallelScope([pathFrom, pathTo] { AFS::moveAndRenameItem(pathFrom, pathTo); /*throw FileError, ErrorMoveUnsupported*/ }, singleThread); }
 
 inline
-AbstractPath getSymlinkResolvedPath(const AbstractPath& linkPath, std::mutex& singleThread) //throw FileError
-{ return parallelScope([linkPath] { return AFS::getSymlinkResolvedPath(linkPath); /*throw FileError*/ }, singleThread); }
+AbstractPath getSymlinkResolvedPathBuffered(const AbstractPath& linkPath, std::mutex& singleThread) //throw FileError
+{ return parallelScope([linkPath] { return AFS::getSymlinkResolvedPathBuffered(linkPath); /*throw FileError*/ }, singleThread); }
 
 inline
 void copySymlink(const AbstractPath& sourcePath, const AbstractPath& targetPath, bool copyFilePermissions, std::mutex& singleThread) //throw FileError
@@ -778,8 +783,8 @@ void revisionFolder(FileVersioner& versioner,
 { parallelScope([=, &versioner] { versioner.revisionFolder(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 inline
-void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
-{ parallelScope([=] { ::verifyFiles(sourcePath, targetPath, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, uint64_t sourceHash, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
+{ parallelScope([=] { ::verifyFiles(sourcePath, targetPath, sourceHash, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 }
 
@@ -1802,6 +1807,7 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                                           result.targetFilePrint,
                                           result.sourceFilePrint,
                                           false, file.isFollowedSymlink<sideSrc>());
+                file.setContentHash(result.contentHash);
 
                 if (result.errorModTime) //log only; no popup
                     acb_.logMessage(result.errorModTime->toString(), PhaseCallback::MsgType::warning); //throw ThreadStopRequest
@@ -1890,7 +1896,7 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
             AbstractPath targetPathResolvedOld = file.getAbstractPath<sideTrg>(); //support change in case when syncing to case-sensitive SFTP on Windows!
             AbstractPath targetPathResolvedNew = targetPathLogical;
             if (file.isFollowedSymlink<sideTrg>()) //follow link when updating file rather than delete it and replace with regular file!!!
-                targetPathResolvedOld = targetPathResolvedNew = parallel::getSymlinkResolvedPath(file.getAbstractPath<sideTrg>(), singleThread_); //throw FileError
+                targetPathResolvedOld = targetPathResolvedNew = parallel::getSymlinkResolvedPathBuffered(file.getAbstractPath<sideTrg>(), singleThread_); //throw FileError
 
             const std::wstring& statusMsg = replaceCpy(txtUpdatingFile_, L"%x", fmtPath(AFS::getDisplayPath(targetPathResolvedOld)));
             reportInfo(std::wstring(statusMsg), acb_); //throw ThreadStopRequest
@@ -1934,6 +1940,7 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                                       result.sourceFilePrint,
                                       file.isFollowedSymlink<sideTrg>(),
                                       file.isFollowedSymlink<sideSrc>());
+            file.setContentHash(result.contentHash);
 
             if (result.errorModTime) //log only; no popup
                 acb_.logMessage(result.errorModTime->toString(), PhaseCallback::MsgType::warning); //throw ThreadStopRequest
@@ -2193,10 +2200,8 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
 
                 //attention when fixing statistics due to missing folder: child items may be scheduled for move, so deletion will have move-references flip back to copy + delete!
                 const SyncStatistics statsBefore(folder.base()); //=> don't bother considering individual move operations, just calculate over the whole tree
-                folder.clearFiles();          //
-                folder.clearSymlinks();       //update FolderPair
-                folder.clearSubfolders();     //
-                folder.removeItem<sideSrc>(); //
+                folder.removeItem<sideSrc>(); //update FolderPair (including child items)
+                //don't destroy the now empty child items here: GUI reads the hierarchy concurrently (ObjectIdTable) => see removeDoubleEmpty() on main thread
                 const SyncStatistics statsAfter(folder.base());
 
                 acb_.updateDataProcessed(1, 0); //even if the source item does not exist anymore, significant I/O work was done => report
@@ -2220,10 +2225,7 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
 
             //TODO: implement parallel folder deletion
 
-            folder.clearFiles();          //
-            folder.clearSymlinks();       //update FolderPair
-            folder.clearSubfolders();     //
-            folder.removeItem<sideTrg>(); //
+            folder.removeItem<sideTrg>(); //update FolderPair (including child items): destroyed by removeDoubleEmpty() on main thread
         }
         break;
 
@@ -2310,7 +2312,8 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
             //callback runs *outside* singleThread_ lock! => fine
             auto verifyCallback = [&](int64_t bytesDelta) { interruptionPoint(); }; //throw ThreadStopRequest
 
-            parallel::verifyFiles(sourcePathTmp, targetPath, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
+            //source was hashed during copy => only re-read target
+            parallel::verifyFiles(sourcePathTmp, targetPath, result.contentHash, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
         }
         //#################### /Verification #############################
 
@@ -2433,6 +2436,9 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
     if (syncConfig.size() != folderCmp.size())
         throw std::logic_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Contract violation!");
 
+    //item types buffered by comparison are only valid until the following sync => don't leak into next run
+    ZEN_ON_SCOPE_EXIT(AFS::clearItemTypeBuffer());
+
     //aggregate basic information
     std::vector<SyncStatistics> folderPairStats;
     {
@@ -199,7 +199,7 @@ void FileVersioner::revisionFile(const FileDescriptor& fileDescr, const Zstring&
 {
     checkPathConflict(fileDescr.path, relativePath); //throw FileError
 
-    if (const std::optional<AFS::ItemType> type = AFS::getItemTypeIfExists(fileDescr.path)) //throw FileError
+    if (const std::optional<AFS::ItemType> type = AFS::getItemTypeIfExistsBuffered(fileDescr.path)) //throw FileError
     {
         assert(*type != AFS::ItemType::symlink);
 
@@ -242,7 +242,7 @@ void FileVersioner::revisionSymlink(const AbstractPath& linkPath, const Zstring&
 {
     checkPathConflict(linkPath, relativePath); //throw FileError
 
-    if (AFS::itemExists(linkPath)) //throw FileError
+    if (AFS::itemExistsBuffered(linkPath)) //throw FileError
         revisionSymlinkImpl(linkPath, relativePath, nullptr /*onBeforeMove*/); //throw FileError
     //else -> missing source item is not an error => check BEFORE deleting target
 }
@@ -269,7 +269,7 @@ void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring
     checkPathConflict(folderPath, relativePath); //throw FileError
 
     //no error situation if directory is not existing! manual deletion relies on it!
-    if (const std::optional<AFS::ItemType> type = AFS::getItemTypeIfExists(folderPath)) //throw FileError
+    if (const std::optional<AFS::ItemType> type = AFS::getItemTypeIfExistsBuffered(folderPath)) //throw FileError
     {
         assert(*type != AFS::ItemType::symlink);
 
@@ -478,7 +478,7 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         callback.updateStatus(textScanning + statusLine); //throw X
     };
 
-    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelFolderScan(foldersToRead,
+    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelFolderScan(foldersToRead, {} /*folderChanges*/,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); } /*throw X*/,
     onStatusUpdate /*throw X*/, UI_UPDATE_INTERVAL / 2); //every ~25 ms
 
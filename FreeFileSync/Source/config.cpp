@@ -1450,6 +1450,16 @@ void readConfig(const XmlIn& in, GlobalConfig& cfg, int formatVer)
         cfg.soundFileAlertPending    = resolvePortablePath(cfg.soundFileAlertPending);
     }
 
+    in["BlockSizeTuning"].visitChildren([&](const XmlIn& inDevice)
+    {
+        assert(*inDevice.getName() == "Device");
+        Zstring deviceKey;
+        size_t factor = 1;
+        if (inDevice.attribute("Path",   deviceKey) &&
+            inDevice.attribute("Factor", factor))
+            cfg.blockSizeFactors.emplace(deviceKey, factor);
+    });
+
     XmlIn inMainWin = in["MainDialog"];
 
     //TODO: remove old parameter after migration! 2020-12-03
@@ -2180,6 +2190,13 @@ void writeConfig(const GlobalConfig& cfg, XmlOut& out)
     out["Sounds"]["SyncFinished"   ].attribute("Path", makePortablePath(cfg.soundFileSyncFinished));
     out["Sounds"]["AlertPending"   ].attribute("Path", makePortablePath(cfg.soundFileAlertPending));
 
+    for (const auto& [deviceKey, factor] : cfg.blockSizeFactors)
+    {
+        XmlOut outDevice = out["BlockSizeTuning"].addChild("Device");
+        outDevice.attribute("Path",   deviceKey);
+        outDevice.attribute("Factor", factor);
+    }
+
     //gui specific global settings (optional)
     XmlOut outMainWin = out["MainDialog"];
 
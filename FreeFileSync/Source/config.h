@@ -164,6 +164,8 @@ struct GlobalConfig
     Zstring soundFileSyncFinished;
     Zstring soundFileAlertPending;
 
+    std::map<Zstring, size_t> blockSizeFactors; //device key (e.g. mount point) => tuned I/O block size factor: see AFS::getBlockSizeFactor()
+
     ConfirmationDialogs confirmDlgs;
     WarningDialogs warnDlgs;
 
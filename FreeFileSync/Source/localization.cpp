@@ -8,11 +8,15 @@
 #include <clocale> //setlocale
 #include <zen/file_traverser.h>
 #include <zen/file_io.h>
+#include <zen/serialize.h>
+#include <zen/extra_log.h>
 #include <wx/zipstrm.h>
 #include <wx/mstream.h>
 #include <wx/uilocale.h>
 #include "parse_lng.h"
 
+    #include <sys/stat.h>
+
 using namespace zen;
 using namespace fff;
 
@@ -27,7 +31,7 @@ const TranslationInfo transInfoDefault
     .translatorName = L"Zenju",
     .languageFlag   = "flag_usa",
     .lngFileName    = Zstr(""),
-    .lngStream      = "",
+    .lngZipEntry    = "",
 };
 
 
@@ -100,96 +104,264 @@ FFSTranslation::FFSTranslation(const std::string& lngStream, bool haveRtlLayout)
 }
 
 
-std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw FileError
+std::optional<TranslationInfo> getTranslationInfo(const lng::TransHeader& lngHeader, const Zstring& lngFileName, const std::string& lngZipEntry)
 {
-    std::vector<std::pair<Zstring /*file path*/, std::string /*byte stream*/>> streams;
-    [&]
+    assert(!lngHeader.languageName  .empty());
+    assert(!lngHeader.translatorName.empty());
+    assert(!lngHeader.locale        .empty());
+    assert(!lngHeader.flagFile      .empty());
+
+    const wxLanguageInfo* lngInfo = wxUILocale::FindLanguageInfo(utfTo<wxString>(lngHeader.locale));
+    assert(lngInfo && lngInfo->CanonicalName == utfTo<wxString>(lngHeader.locale));
+    if (!lngInfo)
+        return {};
+
+    return TranslationInfo
     {
-        std::string rawStream;
-        try //to load from ZIP first:
-        {
-            rawStream = getFileContent(zipPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-        }
-        catch (FileError&) //fall back to folder: dev build (only!?)
-        {
-            const Zstring fallbackFolder = beforeLast(zipPath, Zstr(".zip"), IfNotFoundReturn::none);
-            if (!itemExists(fallbackFolder)) //throw FileError
-                throw;
-
-            traverseFolder(fallbackFolder, [&](const FileInfo& fi)
-            {
-                if (endsWith(fi.fullPath, Zstr(".lng")))
-                {
-                    std::string stream = getFileContent(fi.fullPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-                    streams.emplace_back(fi.fullPath, std::move(stream));
-                }
-            }, nullptr, nullptr); //throw FileError
+        .languageID     = static_cast<wxLanguage>(lngInfo->Language),
+        .locale         = lngHeader.locale,
+        .languageName   = utfTo<std::wstring>(lngHeader.languageName),
+        .translatorName = utfTo<std::wstring>(lngHeader.translatorName),
+        .languageFlag   = lngHeader.flagFile,
+        .lngFileName    = lngFileName,
+        .lngZipEntry    = lngZipEntry,
+    };
+}
+
+
+std::wstring formatLngParsingError(const lng::ParsingError& e, const Zstring& lngFileName)
+{
+    return replaceCpy(replaceCpy(replaceCpy(_("Error parsing file %x, row %y, column %z."),
+                                            L"%x", fmtPath(lngFileName)),
+                                 L"%y", formatNumber(e.row + 1)),
+                      L"%z", formatNumber(e.col + 1))
+           + L"\n\n" + e.msg;
+}
+
+
+void sortTranslations(std::vector<TranslationInfo>& translations)
+{
+    std::sort(translations.begin(), translations.end(), [](const TranslationInfo& lhs, const TranslationInfo& rhs)
+    {
+        return LessNaturalSort()(utfTo<Zstring>(lhs.languageName),
+                                 utfTo<Zstring>(rhs.languageName)); //"natural" sort: ignore case and diacritics
+    });
+}
+
+//--------------------------------------------------------------------------------------------------------------
+
+/* translation index: avoid decompressing and parsing all .lng files on each startup just to list the available languages
+   - language headers + ZIP entry names, built after first run (or whenever Languages.zip changes)
+   - selected language is then read from ZIP via its entry name => only one .lng file is decompressed and parsed      */
+const char TRANSLATION_INDEX_FILE_DESCR[] = "FreeFileSync Translation Index";
+const int TRANSLATION_INDEX_FILE_VERSION = 1;
+
+struct ZipFingerprint
+{
+    int64_t fileSize    = 0;
+    int64_t modTimeSec  = 0;
+    int64_t modTimeNsec = 0;
+    bool operator==(const ZipFingerprint&) const = default;
+};
+
+
+ZipFingerprint getZipFingerprint(const Zstring& zipPath) //throw FileError
+{
+    struct stat fileInfo = {};
+    if (::stat(zipPath.c_str(), &fileInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(zipPath)), "stat");
+
+    return {fileInfo.st_size, fileInfo.st_mtim.tv_sec, fileInfo.st_mtim.tv_nsec};
+}
+
+
+std::vector<TranslationInfo> loadTranslationIndex(const Zstring& indexFilePath, const Zstring& zipPath, const ZipFingerprint& zipFp) //throw FileError, SysError
+{
+    const std::string byteStream = getFileContent(indexFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    MemoryStreamIn streamIn(byteStream);
+
+    char formatDescr[sizeof(TRANSLATION_INDEX_FILE_DESCR)] = {};
+    readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+    if (!std::equal(std::begin(formatDescr), std::end(formatDescr), std::begin(TRANSLATION_INDEX_FILE_DESCR)))
+        throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+    const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+    if (version != TRANSLATION_INDEX_FILE_VERSION)
+        throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+    ZipFingerprint indexFp;
+    indexFp.fileSize    = readNumber<int64_t>(streamIn); //
+    indexFp.modTimeSec  = readNumber<int64_t>(streamIn); //throw SysErrorUnexpectedEos
+    indexFp.modTimeNsec = readNumber<int64_t>(streamIn); //
+    if (indexFp != zipFp)
+        throw SysError(L"Outdated translation index."); //=> rebuild
+
+    std::vector<TranslationInfo> translations{transInfoDefault};
+
+    for (uint32_t itemCount = readNumber<uint32_t>(streamIn); itemCount-- > 0;) //throw SysErrorUnexpectedEos
+    {
+        const std::string lngZipEntry = readContainer<std::string>(streamIn); //
+        lng::TransHeader lngHeader;                                           //
+        lngHeader.locale         = readContainer<std::string>(streamIn);      //throw SysErrorUnexpectedEos
+        lngHeader.languageName   = readContainer<std::string>(streamIn);      //
+        lngHeader.translatorName = readContainer<std::string>(streamIn);      //
+        lngHeader.flagFile       = readContainer<std::string>(streamIn);      //
+
+        if (std::optional<TranslationInfo> ti = getTranslationInfo(lngHeader, zipPath + Zstr(':') + utfTo<Zstring>(lngZipEntry), lngZipEntry))
+            translations.push_back(std::move(*ti));
+    }
+    sortTranslations(translations);
+    return translations;
+}
+
+
+void saveTranslationIndex(const std::vector<TranslationInfo>& translations, const Zstring& indexFilePath, const ZipFingerprint& zipFp) //throw FileError
+{
+    MemoryStreamOut streamOut;
+    writeArray(streamOut, TRANSLATION_INDEX_FILE_DESCR, sizeof(TRANSLATION_INDEX_FILE_DESCR));
+    writeNumber<int32_t>(streamOut, TRANSLATION_INDEX_FILE_VERSION);
+
+    writeNumber<int64_t>(streamOut, zipFp.fileSize);
+    writeNumber<int64_t>(streamOut, zipFp.modTimeSec);
+    writeNumber<int64_t>(streamOut, zipFp.modTimeNsec);
+
+    std::vector<const TranslationInfo*> zipTranslations;
+    for (const TranslationInfo& ti : translations)
+        if (!ti.lngZipEntry.empty()) //skip default translation
+            zipTranslations.push_back(&ti);
+
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(zipTranslations.size()));
+    for (const TranslationInfo* ti : zipTranslations)
+    {
+        writeContainer(streamOut, ti->lngZipEntry);
+        writeContainer(streamOut, ti->locale);
+        writeContainer(streamOut, utfTo<std::string>(ti->languageName));
+        writeContainer(streamOut, utfTo<std::string>(ti->translatorName));
+        writeContainer(streamOut, ti->languageFlag);
+    }
+
+    setFileContent(indexFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+template <class Function>
+void traverseLngZip(const Zstring& zipPath, Function onLngEntry /*bool(const wxZipEntry& entry, wxZipInputStream& zipStream): return "false" to stop*/) //throw FileError
+{
+    const std::string rawStream = getFileContent(zipPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    wxMemoryInputStream byteStream(rawStream.c_str(), rawStream.size()); //does not take ownership
+    wxZipInputStream zipStream(byteStream, wxConvUTF8);
+
+    while (const auto& entry = std::unique_ptr<wxZipEntry>(zipStream.GetNextEntry())) //take ownership!
+    {
+        if (entry->IsDir()) //e.g. translators accidentally ZIPing "Languages" directory
+            throw FileError(replaceCpy(replaceCpy<std::wstring>(L"ZIP file %x contains unexpected sub directory %y.",
+                                                                L"%x", fmtPath(zipPath)),
+                                       L"%y", fmtPath(utfTo<std::wstring>(entry->GetName()))));
+
+        if (!onLngEntry(*entry, zipStream)) //entry data is skipped unless read => no decompression needed
             return;
-        }
-        //-------------------------------------------------------------
+    }
+}
 
-        wxMemoryInputStream byteStream(rawStream.c_str(), rawStream.size()); //does not take ownership
-        wxZipInputStream zipStream(byteStream, wxConvUTF8);
 
-        while (const auto& entry = std::unique_ptr<wxZipEntry>(zipStream.GetNextEntry())) //take ownership!
-        {
-            if (entry->IsDir()) //e.g. translators accidentally ZIPing "Languages" directory
-                throw FileError(replaceCpy(replaceCpy<std::wstring>(L"ZIP file %x contains unexpected sub directory %y.",
-                                                                    L"%x", fmtPath(zipPath)),
-                                           L"%y", fmtPath(utfTo<std::wstring>(entry->GetName()))));
-
-            if (std::string stream(entry->GetSize(), '\0');
-                zipStream.ReadAll(stream.data(), stream.size()))
-                streams.emplace_back(zipPath + Zstr(':') + utfTo<Zstring>(entry->GetName()), std::move(stream));
-            else
-                assert(false);
-        }
-    }();
-    //--------------------------------------------------------------------
+std::string readZipEntry(const wxZipEntry& entry, wxZipInputStream& zipStream)
+{
+    if (std::string stream(entry.GetSize(), '\0');
+        zipStream.ReadAll(stream.data(), stream.size()))
+        return stream;
+
+    assert(false);
+    return {};
+}
 
+
+std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath, const Zstring& indexFilePath) //throw FileError
+{
     std::vector<TranslationInfo> translations{transInfoDefault};
 
-    for (/*const*/ auto& [filePath, stream] : streams)
+    auto addTranslation = [&](const std::string& stream, const Zstring& lngFileName, const std::string& lngZipEntry) //throw FileError
+    {
         try
         {
             const lng::TransHeader lngHeader = lng::parseHeader(stream); //throw ParsingError
-            assert(!lngHeader.languageName  .empty());
-            assert(!lngHeader.translatorName.empty());
-            assert(!lngHeader.locale        .empty());
-            assert(!lngHeader.flagFile      .empty());
-
-            const wxLanguageInfo* lngInfo = wxUILocale::FindLanguageInfo(utfTo<wxString>(lngHeader.locale));
-            assert(lngInfo && lngInfo->CanonicalName == utfTo<wxString>(lngHeader.locale));
-            if (lngInfo)
-                translations.push_back(
-            {
-                .languageID     = static_cast<wxLanguage>(lngInfo->Language),
-                .locale         = lngHeader.locale,
-                .languageName   = utfTo<std::wstring>(lngHeader.languageName),
-                .translatorName = utfTo<std::wstring>(lngHeader.translatorName),
-                .languageFlag   = lngHeader.flagFile,
-                .lngFileName    = filePath,
-                .lngStream      = std::move(stream),
-            });
+            if (std::optional<TranslationInfo> ti = getTranslationInfo(lngHeader, lngFileName, lngZipEntry))
+                translations.push_back(std::move(*ti));
         }
-        catch (const lng::ParsingError& e)
+        catch (const lng::ParsingError& e) { throw FileError(formatLngParsingError(e, lngFileName)); }
+    };
+
+    std::optional<ZipFingerprint> zipFp;
+    try
+    {
+        zipFp = getZipFingerprint(zipPath); //throw FileError
+    }
+    catch (FileError&) //fall back to folder: dev build (only!?) => no index
+    {
+        const Zstring fallbackFolder = beforeLast(zipPath, Zstr(".zip"), IfNotFoundReturn::none);
+        if (!itemExists(fallbackFolder)) //throw FileError
+            throw;
+
+        traverseFolder(fallbackFolder, [&](const FileInfo& fi)
         {
-            throw FileError(replaceCpy(replaceCpy(replaceCpy(_("Error parsing file %x, row %y, column %z."),
-                                                             L"%x", fmtPath(filePath)),
-                                                  L"%y", formatNumber(e.row + 1)),
-                                       L"%z", formatNumber(e.col + 1))
-                            + L"\n\n" + e.msg);
-        }
+            if (endsWith(fi.fullPath, Zstr(".lng")))
+                addTranslation(getFileContent(fi.fullPath, nullptr /*notifyUnbufferedIO*/), fi.fullPath, "" /*lngZipEntry*/); //throw FileError
+        }, nullptr, nullptr); //throw FileError
 
-    std::sort(translations.begin(), translations.end(), [](const TranslationInfo& lhs, const TranslationInfo& rhs)
+        sortTranslations(translations);
+        return translations;
+    }
+    //-------------------------------------------------------------
+
+    try
     {
-        return LessNaturalSort()(utfTo<Zstring>(lhs.languageName),
-                                 utfTo<Zstring>(rhs.languageName)); //"natural" sort: ignore case and diacritics
+        return loadTranslationIndex(indexFilePath, zipPath, *zipFp); //throw FileError, SysError
+    }
+    catch (FileError&) {} //not existing (yet)
+    catch (SysError&) {}  //corrupted or outdated => rebuild
+
+    traverseLngZip(zipPath, [&](const wxZipEntry& entry, wxZipInputStream& zipStream) //throw FileError
+    {
+        const std::string lngZipEntry = utfTo<std::string>(entry.GetName());
+        addTranslation(readZipEntry(entry, zipStream), zipPath + Zstr(':') + utfTo<Zstring>(lngZipEntry), lngZipEntry); //throw FileError
+        return true;
     });
+    sortTranslations(translations);
+
+    try
+    {
+        saveTranslationIndex(translations, indexFilePath, *zipFp); //throw FileError
+    }
+    catch (const FileError& e) { logExtraError(e.toString()); } //not critical in this context
+
     return translations;
 }
 
 
+std::string loadLngStream(const TranslationInfo& ti) //throw FileError
+{
+    if (ti.lngZipEntry.empty())
+        return getFileContent(ti.lngFileName, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    const Zstring zipPath = beforeLast(ti.lngFileName, Zstr(':') + utfTo<Zstring>(ti.lngZipEntry), IfNotFoundReturn::none);
+
+    std::string lngStream;
+    traverseLngZip(zipPath, [&](const wxZipEntry& entry, wxZipInputStream& zipStream) //throw FileError
+    {
+        if (utfTo<std::string>(entry.GetName()) != ti.lngZipEntry)
+            return true;
+
+        lngStream = readZipEntry(entry, zipStream);
+        return false;
+    });
+
+    if (lngStream.empty()) //Languages.zip changed after building index?
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(ti.lngFileName)), L"ZIP entry not found.");
+    return lngStream;
+}
+
+
 /* Some ISO codes are used by multiple wxLanguage IDs which can lead to incorrect mapping by wxUILocale::FindLanguageInfo()!!!
     => Identify by description, e.g. "Chinese (Traditional)". The following IDs are affected:
     - zh_TW: wxLANGUAGE_CHINESE_TAIWAN, wxLANGUAGE_CHINESE, wxLANGUAGE_CHINESE_TRADITIONAL_EXPLICIT
@@ -319,7 +491,7 @@ wxLanguage globalLang = wxLANGUAGE_UNKNOWN;
 }
 
 
-void fff::localizationInit(const Zstring& zipPath) //throw FileError
+void fff::localizationInit(const Zstring& zipPath, const Zstring& indexFilePath) //throw FileError
 {
     /*                     wxLocale          vs       wxUILocale (since wxWidgets 3.1.6)
         ------------------------------------------|--------------------
@@ -351,7 +523,7 @@ void fff::localizationInit(const Zstring& zipPath) //throw FileError
     //throw *after* mandatory initialization: setLanguage() requires wxTranslations::Get()!
 
     assert(globalTranslations.size() == 1);
-    globalTranslations = loadTranslations(zipPath); //throw FileError
+    globalTranslations = loadTranslations(zipPath, indexFilePath); //throw FileError
 
     setLanguage(getDefaultLanguage()); //throw FileError
 }
@@ -375,14 +547,15 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
     if (globalLang == lng)
         return; //support polling
 
-    //(try to) retrieve language file
+    //(try to) retrieve language file: only now load and parse the selected .lng file
     std::string lngStream;
     Zstring lngFileName;
 
     for (const TranslationInfo& e : getAvailableTranslations())
         if (e.languageID == lng)
         {
-            lngStream   = e.lngStream;
+            if (!e.lngFileName.empty()) //default translation: English (US)
+                lngStream = loadLngStream(e); //throw FileError
             lngFileName = e.lngFileName;
             break;
         }
@@ -402,14 +575,7 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
 
             setTranslator(std::make_unique<FFSTranslation>(lngStream, haveRtlLayout)); //throw lng::ParsingError, plural::ParsingError
         }
-        catch (const lng::ParsingError& e)
-        {
-            throw FileError(replaceCpy(replaceCpy(replaceCpy(_("Error parsing file %x, row %y, column %z."),
-                                                             L"%x", fmtPath(lngFileName)),
-                                                  L"%y", formatNumber(e.row + 1)),
-                                       L"%z", formatNumber(e.col + 1))
-                            + L"\n\n" + e.msg);
-        }
+        catch (const lng::ParsingError& e) { throw FileError(formatLngParsingError(e, lngFileName)); }
         catch (plural::ParsingError&)
         {
             throw FileError(L"Invalid plural form definition: " + fmtPath(lngFileName)); //user should never see this!
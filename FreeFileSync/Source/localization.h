@@ -22,7 +22,7 @@ struct TranslationInfo
     std::wstring translatorName;
     std::string languageFlag;
     Zstring lngFileName;
-    std::string lngStream;
+    std::string lngZipEntry; //empty: lngFileName is a plain file
 };
 const std::vector<TranslationInfo>& getAvailableTranslations();
 
@@ -31,7 +31,7 @@ wxLanguage getLanguage();
 
 void setLanguage(wxLanguage lng); //throw FileError
 
-void localizationInit(const Zstring& zipPath); //throw FileError
+void localizationInit(const Zstring& zipPath, const Zstring& indexFilePath /*cached language list of zipPath*/); //throw FileError
 void localizationCleanup(); //wxLocale crashes miserably on wxGTK when destructor runs during global cleanup => call in wxApp::OnExit
 //"You should delete all wxWidgets object that you created by the time OnExit() finishes. In particular, do not destroy them from application class' destructor!"
 }
@@ -7,6 +7,10 @@
 #include "log_file.h"
 #include <zen/http.h>
 #include <zen/sys_info.h>
+#include <zen/serialize.h>
+#include <zen/crc.h>
+#include <zen/guid.h>
+#include <zen/extra_log.h>
 
 using namespace zen;
 using namespace fff;
@@ -395,6 +399,7 @@ std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/,
 
 
 //write log items in blocks instead of creating one big string: memory allocation might fail; think 1 million entries!
+//=> ErrorLog::visitEntries() reads spilled entries back in bounded memory, too
 template <class Function>
 void streamToLogFile(const ProcessSummary& summary, const ErrorLog& log,
                      int logPreviewMax, int logItemsMax,
@@ -405,23 +410,25 @@ void streamToLogFile(const ProcessSummary& summary, const ErrorLog& log,
               generateLogHeaderHtml(summary, log, logPreviewMax) :
               generateLogHeaderTxt (summary, log, logPreviewMax)); //throw X
 
+    const ErrorLogStats logCount = getStats(log);
+    const int logItemsTotal = logCount.infos + logCount.warnings + logCount.errors;
+
     int itemCount = 0;
-    for (const LogEntry& entry : log)
+    log.visitEntries([&](const LogEntry& entry) //throw SysError, X
     {
-        if (itemCount++ >= logItemsMax)
-            break;
-        stringOut(logFormat == LogFileFormat::html ?
-                  formatMessageHtml(entry) :
-                  formatMessage    (entry)); //throw X
-    }
+        if (itemCount++ < logItemsMax) //ErrorLog has no early exit; entries beyond limit are only read, not formatted
+            stringOut(logFormat == LogFileFormat::html ?
+                      formatMessageHtml(entry) :
+                      formatMessage    (entry)); //throw X
+    });
 
     const std::string footer = [&]
     {
         try
         {
             return logFormat == LogFileFormat::html ?
-            generateLogFooterHtml(logFilePath, static_cast<int>(log.size()), logItemsMax): //throw FileError
-            generateLogFooterTxt (logFilePath, static_cast<int>(log.size()), logItemsMax); //
+            generateLogFooterHtml(logFilePath, logItemsTotal, logItemsMax): //throw FileError
+            generateLogFooterTxt (logFilePath, logItemsTotal, logItemsMax); //
         }
         catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); } //errors should be further enriched by context info => SysError
     }(); //caveat: don't catch exceptions thrown by stringOut()!
@@ -430,11 +437,11 @@ void streamToLogFile(const ProcessSummary& summary, const ErrorLog& log,
 }
 
 
-void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
-                    LogFileFormat logFormat,
-                    const ProcessSummary& summary,
-                    const ErrorLog& log,
-                    const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
+uint64_t /*file size*/ saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
+                                       LogFileFormat logFormat,
+                                       const ProcessSummary& summary,
+                                       const ErrorLog& log,
+                                       const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     //create logfile folder if required
     if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(logFilePath))
@@ -462,9 +469,13 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
                                                                          std::nullopt /*streamSize*/,
                                                                          std::nullopt /*modTime*/); //throw FileError
 
+    uint64_t fileSize = 0;
+
     BufferedOutputStream streamOut([&](const void* buffer, size_t bytesToWrite)
     {
-        return logFileOut->tryWrite(buffer, bytesToWrite, notifyUnbufferedIO); //throw FileError, X
+        const size_t bytesWritten = logFileOut->tryWrite(buffer, bytesToWrite, notifyUnbufferedIO); //throw FileError, X
+        fileSize += bytesWritten;
+        return bytesWritten;
     },
     logFileOut->getBlockSize());
 
@@ -482,6 +493,7 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
     streamOut.flushBuffer(); //throw FileError, X
 
     logFileOut->finalize(notifyUnbufferedIO); //throw FileError, X
+    return fileSize;
 }
 
 
@@ -492,50 +504,72 @@ const Zchar STATUS_END_TOKEN     = Zstr(']');
 
 struct LogFileInfo
 {
-    AbstractPath filePath;
-    time_t       timeStamp;
+    Zstring      fileName;
+    time_t       timeStamp = 0;
     std::wstring jobNames; //may be empty
+    std::wstring status;   //empty for success
+    uint64_t     fileSize = 0;
 };
-std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw FileError
+
+
+std::optional<LogFileInfo> parseLogFileName(const Zstring& itemName)
 {
-    std::vector<LogFileInfo> logfiles;
+    //"Backup FreeFileSync 2013-09-15 015052.123.html"
+    //"Jobname1 + Jobname2 2013-09-15 015052.123.log"
+    //"2013-09-15 015052.123 [Error].log"
+    static_assert(TIME_STAMP_LENGTH == 21);
 
-    AFS::traverseFolder(logFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
+    if (endsWith(itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
+        endsWith(itemName, Zstr(".html")))
     {
-        //"Backup FreeFileSync 2013-09-15 015052.123.html"
-        //"Jobname1 + Jobname2 2013-09-15 015052.123.log"
-        //"2013-09-15 015052.123 [Error].log"
-        static_assert(TIME_STAMP_LENGTH == 21);
+        ZstringView itemPhrase = beforeLast<ZstringView>(itemName, Zstr('.'), IfNotFoundReturn::none);
 
-        if (endsWith(fi.itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
-            endsWith(fi.itemName, Zstr(".html")))
-        {
-            ZstringView itemPhrase = beforeLast<ZstringView>(fi.itemName, Zstr('.'), IfNotFoundReturn::none);
-
-            if (endsWith(itemPhrase, STATUS_END_TOKEN))
-                itemPhrase = beforeLast(itemPhrase, STATUS_BEGIN_TOKEN, IfNotFoundReturn::all);
+        ZstringView statusPhrase;
+        if (endsWith(itemPhrase, STATUS_END_TOKEN))
+            if (const size_t pos = itemPhrase.rfind(STATUS_BEGIN_TOKEN);
+                pos != ZstringView::npos)
+            {
+                statusPhrase = itemPhrase.substr(pos + strLength(STATUS_BEGIN_TOKEN));
+                statusPhrase.remove_suffix(1);
+                itemPhrase = itemPhrase.substr(0, pos);
+            }
 
-            if (itemPhrase.size() >= TIME_STAMP_LENGTH &&
-                itemPhrase.end()[-4] == Zstr('.') &&
-                isdigit(itemPhrase.end()[-3]) &&
-                isdigit(itemPhrase.end()[-2]) &&
-                isdigit(itemPhrase.end()[-1]))
+        if (itemPhrase.size() >= TIME_STAMP_LENGTH &&
+            itemPhrase.end()[-4] == Zstr('.') &&
+            isdigit(itemPhrase.end()[-3]) &&
+            isdigit(itemPhrase.end()[-2]) &&
+            isdigit(itemPhrase.end()[-1]))
+        {
+            const TimeComp tc = parseTime(Zstr("%Y-%m-%d %H%M%S"), ZstringView(&itemPhrase.end()[-TIME_STAMP_LENGTH], 17)); //returns TimeComp() on error
+            if (const auto [localTime, timeValid] = localToTimeT(tc);
+                timeValid)
             {
-                const TimeComp tc = parseTime(Zstr("%Y-%m-%d %H%M%S"), ZstringView(&itemPhrase.end()[-TIME_STAMP_LENGTH], 17)); //returns TimeComp() on error
-                if (const auto [localTime, timeValid] = localToTimeT(tc);
-                    timeValid)
+                itemPhrase.remove_suffix(TIME_STAMP_LENGTH);
+                if (!itemPhrase.empty())
                 {
-                    itemPhrase.remove_suffix(TIME_STAMP_LENGTH);
-                    if (!itemPhrase.empty())
-                    {
-                        assert(itemPhrase.size() >= 2 && endsWith(itemPhrase, Zstr(' ')));
-                        itemPhrase = trimCpy(itemPhrase);
-                    }
-
-                    logfiles.push_back({AFS::appendRelPath(logFolderPath, fi.itemName), localTime, utfTo<std::wstring>(itemPhrase)});
+                    assert(itemPhrase.size() >= 2 && endsWith(itemPhrase, Zstr(' ')));
+                    itemPhrase = trimCpy(itemPhrase);
                 }
+
+                return LogFileInfo{itemName, localTime, utfTo<std::wstring>(itemPhrase), utfTo<std::wstring>(statusPhrase), 0};
             }
         }
+    }
+    return {};
+}
+
+
+std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw FileError
+{
+    std::vector<LogFileInfo> logfiles;
+
+    AFS::traverseFolder(logFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
+    {
+        if (std::optional<LogFileInfo> lfi = parseLogFileName(fi.itemName))
+        {
+            lfi->fileSize = fi.fileSize;
+            logfiles.push_back(std::move(*lfi));
+        }
     },
     nullptr /*onFolder*/, //traverse only one level deep
     nullptr /*onSymlink*/);
@@ -543,10 +577,121 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
     return logfiles;
 }
 
+//-------------------------------------------------------------------------------------------------------------------------------
+
+/* persistent index of the log folder: avoid full directory listing for each sync with many thousands of log files
+   - updated incrementally by each log file written
+   - full rescan if missing, corrupted, or outdated => catch up on changes not recorded in index, e.g. logs written by old versions,
+     concurrent syncs updating index at the same time, manual deletion                                                          */
+const Zchar LOG_INDEX_FILE_NAME[] = Zstr("LogIndex.ffs_db"); //must not match parseLogFileName()!
+
+const char LOG_INDEX_FILE_DESCR[] = "FreeFileSync Log Index";
+const int LOG_INDEX_FILE_VERSION = 1;
+
+const int LOG_INDEX_RESCAN_INTERVAL_SEC = 24 * 3600;
+
+struct LogIndex
+{
+    time_t lastFullScan = 0;
+    std::vector<LogFileInfo> logFiles;
+};
+
+
+LogIndex loadLogIndex(const AbstractPath& indexFilePath) //throw FileError, SysError
+{
+    const std::unique_ptr<AFS::InputStream> fileIn = AFS::getInputStream(indexFilePath); //throw FileError, ErrorFileLocked
+
+    const std::string byteStream = unbufferedLoad<std::string>([&](void* buffer, size_t bytesToRead)
+    {
+        return fileIn->tryRead(buffer, bytesToRead, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF!
+    },
+    fileIn->getBlockSize()); //throw FileError
+    //------------------------------------------------------------------------------------------------------------------------
+
+    MemoryStreamIn streamIn(byteStream);
+
+    char formatDescr[sizeof(LOG_INDEX_FILE_DESCR)] = {};
+    readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+    if (!std::equal(std::begin(formatDescr), std::end(formatDescr), std::begin(LOG_INDEX_FILE_DESCR)))
+        throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+    const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+    if (version != LOG_INDEX_FILE_VERSION)
+        throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+    //catch data corruption ASAP + don't rely on std::bad_alloc for consistency checking
+    assert(byteStream.size() >= sizeof(uint32_t)); //obviously in this context!
+    MemoryStreamOut crcStreamOut;
+    writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - sizeof(uint32_t)));
+
+    if (!endsWith(byteStream, crcStreamOut.ref()))
+        throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+    LogIndex index;
+    index.lastFullScan = readNumber<int64_t>(streamIn); //throw SysErrorUnexpectedEos
+
+    for (uint32_t itemCount = readNumber<uint32_t>(streamIn); itemCount-- > 0;) //throw SysErrorUnexpectedEos
+    {
+        LogFileInfo lfi;
+        lfi.fileName  = utfTo<Zstring     >(readContainer<std::string>(streamIn)); //
+        lfi.timeStamp =                     readNumber<int64_t>(streamIn);         //
+        lfi.jobNames  = utfTo<std::wstring>(readContainer<std::string>(streamIn)); //throw SysErrorUnexpectedEos
+        lfi.status    = utfTo<std::wstring>(readContainer<std::string>(streamIn)); //
+        lfi.fileSize  =                     readNumber<uint64_t>(streamIn);        //
+        index.logFiles.push_back(std::move(lfi));
+    }
+    return index;
+}
+
+
+void saveLogIndex(const LogIndex& index, const AbstractPath& indexFilePath) //throw FileError
+{
+    MemoryStreamOut streamOut;
+    writeArray(streamOut, LOG_INDEX_FILE_DESCR, sizeof(LOG_INDEX_FILE_DESCR));
+    writeNumber<int32_t>(streamOut, LOG_INDEX_FILE_VERSION);
+
+    writeNumber<int64_t>(streamOut, index.lastFullScan);
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(index.logFiles.size()));
+
+    for (const LogFileInfo& lfi : index.logFiles)
+    {
+        writeContainer(streamOut, utfTo<std::string>(lfi.fileName));
+        writeNumber<int64_t>(streamOut, lfi.timeStamp);
+        writeContainer(streamOut, utfTo<std::string>(lfi.jobNames));
+        writeContainer(streamOut, utfTo<std::string>(lfi.status));
+        writeNumber<uint64_t>(streamOut, lfi.fileSize);
+    }
+    writeNumber<uint32_t>(streamOut, getCrc32(streamOut.ref()));
+    //------------------------------------------------------------------------------------------------------------------------
+
+    //concurrent syncs may save at the same time => write to unique temp file, then rename: last one wins, the others' changes are caught up by the next rescan
+    const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+    const AbstractPath tmpFilePath = AFS::appendRelPath(*AFS::getParentPath(indexFilePath), AFS::getItemName(indexFilePath) + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING);
+    {
+        const std::unique_ptr<AFS::OutputStream> fileOut = AFS::getOutputStream(tmpFilePath,
+                                                                                streamOut.ref().size(),
+                                                                                std::nullopt /*modTime*/); //throw FileError
+        unbufferedSave(streamOut.ref(), [&](const void* buffer, size_t bytesToWrite)
+        {
+            return fileOut->tryWrite(buffer, bytesToWrite, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        },
+        fileOut->getBlockSize()); //throw FileError
+
+        fileOut->finalize(nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(tmpFilePath); }
+    catch (const FileError& e) { logExtraError(e.toString()); }); //after finalize(): not guarded by ~AFS::OutputStream() anymore!
+
+    AFS::removeFileIfExists(indexFilePath);              //throw FileError
+    AFS::moveAndRenameItem(tmpFilePath, indexFilePath); //throw FileError, (ErrorMoveUnsupported)
+}
+
 
 void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
                        int logfilesMaxAgeDays, //<= 0 := no limit
                        const std::set<AbstractPath>& logsToKeepPaths,
+                       const std::optional<LogFileInfo>& newLogFile,
                        const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     if (logfilesMaxAgeDays > 0)
@@ -555,7 +700,26 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
 
         if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(logFolderPath))); //throw X
 
-        std::vector<LogFileInfo> logFiles = getLogFiles(logFolderPath); //throw FileError
+        const AbstractPath indexFilePath = AFS::appendRelPath(logFolderPath, LOG_INDEX_FILE_NAME);
+        const time_t now = std::time(nullptr);
+
+        LogIndex index;
+        try
+        {
+            index = loadLogIndex(indexFilePath); //throw FileError, SysError
+        }
+        catch (FileError&) {} //=> not existing (yet): start full rescan
+        catch (SysError&) {}  //=> corrupted
+
+        if (index.lastFullScan > now || //clock was turned back?
+            index.lastFullScan + LOG_INDEX_RESCAN_INTERVAL_SEC < now)
+        {
+            index.logFiles = getLogFiles(logFolderPath); //throw FileError
+            index.lastFullScan = now;
+        }
+        else if (newLogFile &&
+                 std::none_of(index.logFiles.begin(), index.logFiles.end(), [&](const LogFileInfo& lfi) { return lfi.fileName == newLogFile->fileName; }))
+            index.logFiles.push_back(*newLogFile);
 
         const time_t lastMidnightTime = []
         {
@@ -569,18 +733,30 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
 
         std::exception_ptr firstError;
 
-        for (const LogFileInfo& lfi : logFiles)
+        std::erase_if(index.logFiles, [&](const LogFileInfo& lfi)
+        {
+            const AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, lfi.fileName);
+
             if (lfi.timeStamp < cutOffTime &&
-                !logsToKeepPaths.contains(lfi.filePath)) //don't trim latest log files corresponding to last used config files!
+                !logsToKeepPaths.contains(logFilePath)) //don't trim latest log files corresponding to last used config files!
                 //nitpicker's corner: what about path differences due to case? e.g. user-overriden log file path changed in case
             {
-                if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(lfi.filePath))); //throw X
+                if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(logFilePath))); //throw X
                 try
                 {
-                    AFS::removeFilePlain(lfi.filePath); //throw FileError
+                    AFS::removeFileIfExists(logFilePath); //throw FileError
+                    return true; //already deleted by someone else? fine, too
                 }
                 catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
             }
+            return false;
+        });
+
+        try
+        {
+            saveLogIndex(index, indexFilePath); //throw FileError
+        }
+        catch (const FileError& e) { logExtraError(e.toString()); } //not fatal: index is only a cache => next sync rescans
 
         if (firstError) //late failure!
             std::rethrow_exception(firstError);
@@ -659,9 +835,15 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                       const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
 {
     std::exception_ptr firstError;
+    std::optional<LogFileInfo> newLogFile;
     try
     {
-        saveNewLogFile(logFilePath, logFormat, summary, log, notifyStatus); //throw FileError, X
+        const uint64_t fileSize = saveNewLogFile(logFilePath, logFormat, summary, log, notifyStatus); //throw FileError, X
+
+        newLogFile = parseLogFileName(AFS::getItemName(logFilePath));
+        assert(newLogFile); //see generateLogFileName()
+        if (newLogFile)
+            newLogFile->fileSize = fileSize;
     }
     catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
@@ -669,7 +851,7 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
     {
         const std::optional<AbstractPath> logFolderPath = AFS::getParentPath(logFilePath);
         assert(logFolderPath); //else: logFilePath == device root; not possible with generateLogFilePath()
-        limitLogfileCount(*logFolderPath, logfilesMaxAgeDays, logsToKeepPaths, notifyStatus); //throw FileError, X
+        limitLogfileCount(*logFolderPath, logfilesMaxAgeDays, logsToKeepPaths, newLogFile, notifyStatus); //throw FileError, X
     }
     catch (FileError&) { if (!firstError) firstError = std::current_exception(); };
 
@@ -0,0 +1,175 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "startup_trace.h"
+#include <zen/globals.h>
+#include <zen/thread.h>
+#include <zen/file_io.h>
+#include <zen/file_path.h>
+#include <zen/extra_log.h>
+#include <zen/json.h>
+#include <zen/perf.h>
+#include "version/version.h"
+
+    #include <unistd.h> //getpid, sysconf
+    #include <time.h> //clock_gettime
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+struct StartupTrace
+{
+    StartupTrace(const Zstring& filePath, std::chrono::nanoseconds timeSinceStart) : reportFilePath(filePath), initTime(timeSinceStart) {}
+
+    const Zstring reportFilePath;
+    const std::chrono::nanoseconds initTime; //time origin: process start
+    const StopWatch stopWatch;               //started at initTime
+
+    std::chrono::nanoseconds elapsed() const { return initTime + stopWatch.elapsed(); }
+
+    struct Phase
+    {
+        const char* name = nullptr;
+        std::chrono::nanoseconds startTime{};
+        std::chrono::nanoseconds duration{};
+    };
+    std::vector<Phase> phases; //in order of completion
+};
+
+constinit Global<StartupTrace> globalStartupTrace; //only set while tracing
+
+
+int64_t toMicroSec(std::chrono::nanoseconds time) { return std::chrono::duration_cast<std::chrono::microseconds>(time).count(); }
+
+
+std::chrono::nanoseconds getTimeSinceProcessStart() //throw SysError
+{
+    //https://man7.org/linux/man-pages/man5/proc_pid_stat.5.html
+    std::string procStat;
+    try { procStat = getFileContent("/proc/self/stat", nullptr /*notifyUnbufferedIO*/); } //throw FileError
+    catch (const FileError& e) { throw SysError(replaceCpy(e.toString(), L"\n\n", L'\n')); }
+
+    //field 2 "comm" is in parentheses and may contain blanks => start parsing after last ')' with field 3
+    const std::vector<std::string> fields = splitCpy(afterLast(procStat, ')', IfNotFoundReturn::none), ' ', SplitOnEmpty::skip);
+    if (fields.size() < 20)
+        throw SysError(L"Unexpected format of /proc/self/stat");
+
+    const long ticksPerSec = ::sysconf(_SC_CLK_TCK);
+    if (ticksPerSec <= 0)
+        THROW_LAST_SYS_ERROR("sysconf(_SC_CLK_TCK)");
+
+    const uint64_t startTicks = stringTo<uint64_t>(fields[22 - 3]); //field 22 "starttime": clock ticks since boot
+
+    timespec now = {};
+    if (::clock_gettime(CLOCK_BOOTTIME, &now) != 0)
+        THROW_LAST_SYS_ERROR("clock_gettime(CLOCK_BOOTTIME)");
+
+    const auto timeSinceBoot = std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+    const auto startTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(static_cast<double>(startTicks) / ticksPerSec));
+
+    return std::max(timeSinceBoot - startTime, std::chrono::nanoseconds(0)); //clock tick resolution: ~10 ms
+}
+}
+
+
+void fff::startupTraceInit()
+{
+    assert(runningOnMainThread());
+    assert(!globalStartupTrace.get());
+
+    if (const std::optional<Zstring> reportFilePath = getEnvironmentVar("FFS_STARTUP_TRACE"))
+        if (const Zstring filePath = trimCpy(*reportFilePath);
+            !filePath.empty())
+        {
+            std::chrono::nanoseconds timeSinceStart{};
+            try { timeSinceStart = getTimeSinceProcessStart(); } //throw SysError
+            catch (const SysError& e) { logExtraError(e.toString()); } //fall back: time origin is startupTraceInit()
+
+            globalStartupTrace.set(std::make_unique<StartupTrace>(filePath, timeSinceStart));
+        }
+}
+
+
+void fff::startupTraceFinish()
+{
+    assert(runningOnMainThread());
+
+    const std::shared_ptr<StartupTrace> trace = globalStartupTrace.get();
+    if (!trace)
+        return;
+    globalStartupTrace.set(nullptr); //report once: stop recording
+
+    const int64_t processId = ::getpid();
+
+    auto makeEvent = [&](const char* name, const char* phaseType, std::chrono::nanoseconds startTime)
+    {
+        JsonValue event(JsonValue::Type::object);
+        event.objectVal.set("name", name);
+        event.objectVal.set("ph", phaseType);
+        event.objectVal.set("ts", toMicroSec(startTime));
+        event.objectVal.set("pid", processId);
+        event.objectVal.set("tid", 1);
+        return event;
+    };
+
+    std::vector<StartupTrace::Phase> phases = trace->phases;
+    std::stable_sort(phases.begin(), phases.end(), [](const StartupTrace::Phase& lhs, const StartupTrace::Phase& rhs) { return lhs.startTime < rhs.startTime; });
+
+    std::vector<JsonValue> traceEvents;
+
+    if (trace->initTime > std::chrono::nanoseconds(0))
+    {
+        JsonValue event = makeEvent("wxEntry", "X" /*complete event*/, std::chrono::nanoseconds(0)); //static init + wxWidgets/GTK init until Application::OnInit()
+        event.objectVal.set("dur", toMicroSec(trace->initTime));
+        traceEvents.push_back(std::move(event));
+    }
+
+    for (const StartupTrace::Phase& phase : phases)
+    {
+        JsonValue event = makeEvent(phase.name, "X" /*complete event*/, phase.startTime);
+        event.objectVal.set("dur", toMicroSec(phase.duration));
+        traceEvents.push_back(std::move(event));
+    }
+
+    JsonValue eventReady = makeEvent("Startup complete", "i" /*instant event*/, trace->elapsed());
+    eventReady.objectVal.set("s", "g"); //scope: global
+    traceEvents.push_back(std::move(eventReady));
+
+    JsonValue metaData(JsonValue::Type::object);
+    metaData.objectVal.set("version", ffsVersion);
+
+    JsonValue report(JsonValue::Type::object);
+    report.objectVal.set("traceEvents", std::move(traceEvents));
+    report.objectVal.set("displayTimeUnit", "ms");
+    report.objectVal.set("metadata", std::move(metaData));
+
+    try
+    {
+        setFileContent(trace->reportFilePath, serializeJson(report), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const FileError& e) { logExtraError(e.toString()); }
+}
+
+
+StartupPhase::StartupPhase(const char* name) : name_(name)
+{
+    if (const std::shared_ptr<StartupTrace> trace = globalStartupTrace.get())
+    {
+        assert(runningOnMainThread());
+        startTime_ = trace->elapsed();
+    }
+}
+
+
+StartupPhase::~StartupPhase()
+{
+    if (startTime_.count() >= 0)
+        if (const std::shared_ptr<StartupTrace> trace = globalStartupTrace.get()) //report might be written already
+            trace->phases.push_back({name_, startTime_, trace->elapsed() - startTime_});
+}
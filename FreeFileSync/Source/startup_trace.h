@@ -0,0 +1,41 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef STARTUP_TRACE_H_2093847502938475029
+#define STARTUP_TRACE_H_2093847502938475029
+
+#include <chrono>
+
+
+namespace fff
+{
+/* startup profiling: run with environment variable FFS_STARTUP_TRACE=<file path> to record the duration of named startup phases
+   => report is written in Chrome trace format: view via chrome://tracing or https://ui.perfetto.dev
+
+   - time origin is process start: static initialization and wxWidgets/GTK init show up as the time before startupTraceInit()
+   - phase names: the function being timed, e.g. "readGlobalConfig" or "MainDialog::MainDialog"
+   - nested phases show up nested in the report: close outer phases before startupTraceFinish()
+   - all functions are no-op if tracing is disabled; main thread only!      */
+void startupTraceInit();
+void startupTraceFinish(); //write report (once): main window is shown, batch mode is starting, or application exits
+
+
+class StartupPhase //RAII: records phase from construction until destruction
+{
+public:
+    explicit StartupPhase(const char* name); //name: string literal!
+    ~StartupPhase();
+
+private:
+    StartupPhase           (const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+    const char* const name_;
+    std::chrono::nanoseconds startTime_{-1}; //< 0: tracing disabled
+};
+}
+
+#endif //STARTUP_TRACE_H_2093847502938475029
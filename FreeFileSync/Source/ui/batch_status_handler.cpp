@@ -406,24 +406,8 @@ void BatchStatusHandler::reportFatalError(const std::wstring& msg)
 
 Statistics::ErrorStats BatchStatusHandler::getErrorStats() const
 {
-    //errorLog_ is an "append only" structure, so we can make getErrorStats() complexity "constant time":
-    std::for_each(errorLog_.ref().begin() + errorStatsRowsChecked_, errorLog_.ref().end(), [&](const LogEntry& entry)
-    {
-        switch (entry.type)
-        {
-            case MSG_TYPE_INFO:
-                break;
-            case MSG_TYPE_WARNING:
-                ++errorStatsBuf_.warningCount;
-                break;
-            case MSG_TYPE_ERROR:
-                ++errorStatsBuf_.errorCount;
-                break;
-        }
-    });
-    errorStatsRowsChecked_ = errorLog_.ref().size();
-
-    return errorStatsBuf_;
+    const ErrorLogStats logCount = getStats(errorLog_.ref()); //constant time
+    return {.errorCount = logCount.errors, .warningCount = logCount.warnings};
 }
 
 
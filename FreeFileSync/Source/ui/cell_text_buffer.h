@@ -0,0 +1,180 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CELL_TEXT_BUFFER_H_3480275029347502934
+#define CELL_TEXT_BUFFER_H_3480275029347502934
+
+#include <list>
+#include <variant>
+#include <unordered_map>
+#include <zen/thread.h>
+#include <zen/format_unit.h>
+#include "file_grid_attr.h"
+#include "../base/file_hierarchy.h"
+
+
+namespace fff
+{
+/* pre-formatted texts of file grid size/date columns: formatNumber() and formatUtcToLocalTime() are too slow
+   to run for every visible cell on every paint while scrolling through large grids
+
+   - LRU buffer keyed by (row handle, column)
+   - filled ahead of the visible rows by a worker thread: main thread extracts raw values, worker only formats
+   - invalidated whenever FileView::getContentUpdateId() changes, e.g. after sync direction changes or synchronization */
+class CellTextBuffer
+{
+public:
+    using RawValue = std::variant<uint64_t /*file size*/, time_t /*modification time*/>;
+
+    struct CellValue
+    {
+        ObjectId objId;
+        ColumnTypeRim colType = ColumnTypeRim::size;
+        RawValue value;
+    };
+
+    CellTextBuffer()
+    {
+        worker_ = zen::InterruptibleThread([this]
+        {
+            zen::setCurrentThreadName(Zstr("Cell Text Buffer"));
+
+            for (;;)
+            {
+                //blocks until next cell to format is retrieved:
+                const auto [cell, contentId] = extractNext(); //throw ThreadStopRequest
+
+                insert(cell.objId, cell.colType, formatValue(cell.value), contentId);
+            }
+        });
+    }
+
+    ~CellTextBuffer()
+    {
+        worker_.requestStop(); //end thread life time *before*
+        worker_.join();        //member clean up!
+    }
+
+    static std::wstring formatValue(const RawValue& value)
+    {
+        if (const uint64_t* fileSize = std::get_if<uint64_t>(&value))
+            return zen::formatNumber(*fileSize);
+        return zen::formatUtcToLocalTime(std::get<time_t>(value));
+    }
+
+    //context of main thread: returns std::nullopt if not buffered
+    std::optional<std::wstring> retrieve(ObjectId objId, ColumnTypeRim colType, uint64_t contentId)
+    {
+        assert(zen::runningOnMainThread());
+        std::lock_guard dummy(lockCells_);
+        setContentId(contentId);
+
+        auto it = cells_.find({objId, colType});
+        if (it == cells_.end())
+            return {};
+
+        lruList_.splice(lruList_.begin(), lruList_, it->second); //mark as hot
+        return it->second->second;
+    }
+
+    //called by main and worker thread:
+    void insert(ObjectId objId, ColumnTypeRim colType, std::wstring&& text, uint64_t contentId)
+    {
+        std::lock_guard dummy(lockCells_);
+        if (contentId != contentId_) //formatted for outdated content
+            return;
+
+        const auto [it, inserted] = cells_.try_emplace({objId, colType});
+        if (!inserted) //worker and main thread raced for the same cell
+            return;
+
+        lruList_.emplace_front(it->first, std::move(text));
+        it->second = lruList_.begin();
+
+        while (lruList_.size() > BUFFER_SIZE_MAX)
+        {
+            cells_.erase(lruList_.back().first); //remove least recently used
+            lruList_.pop_back();
+        }
+    }
+
+    //context of main thread: replaces previous workload; processes last elements first!
+    void setWorkload(std::vector<CellValue>&& newLoad, uint64_t contentId)
+    {
+        assert(zen::runningOnMainThread());
+        {
+            std::lock_guard dummy(lockCells_);
+            setContentId(contentId);
+
+            std::erase_if(newLoad, [&](const CellValue& cell) { return cells_.contains({cell.objId, cell.colType}); });
+            workload_.swap(newLoad);
+        }
+        conditionNewWork_.notify_all();
+    }
+
+private:
+    CellTextBuffer           (const CellTextBuffer&) = delete;
+    CellTextBuffer& operator=(const CellTextBuffer&) = delete;
+
+    static constexpr size_t BUFFER_SIZE_MAX = 10'000; //must be big enough to hold visible cells + preload buffer of both columns!
+
+    //context of worker thread, blocking:
+    std::pair<CellValue, uint64_t> extractNext() //throw ThreadStopRequest
+    {
+        assert(!zen::runningOnMainThread());
+        std::unique_lock dummy(lockCells_);
+
+        zen::interruptibleWait(conditionNewWork_, dummy, [this] { return !workload_.empty(); }); //throw ThreadStopRequest
+
+        CellValue cell = workload_.back();
+        /**/             workload_.pop_back();
+        return {cell, contentId_};
+    }
+
+    //call while holding lock:
+    void setContentId(uint64_t contentId)
+    {
+        if (contentId != contentId_)
+        {
+            contentId_ = contentId;
+            cells_   .clear();
+            lruList_ .clear();
+            workload_.clear();
+        }
+    }
+
+    struct CellKey
+    {
+        ObjectId objId;
+        ColumnTypeRim colType = ColumnTypeRim::size;
+        bool operator==(const CellKey&) const = default;
+    };
+
+    struct CellKeyHash
+    {
+        size_t operator()(const CellKey& key) const
+        {
+            zen::FNV1aHash<size_t> hash;
+            hash.add(key.objId.slot);
+            hash.add(key.objId.generation);
+            hash.add(static_cast<size_t>(key.colType));
+            return hash.get();
+        }
+    };
+
+    std::mutex              lockCells_;
+    std::condition_variable conditionNewWork_; //signal event: data for processing available
+
+    uint64_t contentId_ = 0;
+    std::list<std::pair<CellKey, std::wstring>> lruList_; //most recently used first
+    std::unordered_map<CellKey, decltype(lruList_)::iterator, CellKeyHash> cells_;
+    std::vector<CellValue> workload_; //ObjectId is only used as a key: never dereferenced by worker thread!
+
+    zen::InterruptibleThread worker_;
+};
+}
+
+#endif //CELL_TEXT_BUFFER_H_3480275029347502934
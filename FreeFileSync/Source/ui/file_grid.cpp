@@ -16,6 +16,7 @@
 #include <wx+/image_tools.h>
 #include <wx+/image_resources.h>
 #include <wx+/std_button_layout.h>
+#include "cell_text_buffer.h"
 #include "../base/file_hierarchy.h"
 
 using namespace zen;
@@ -539,15 +540,15 @@ private:
 
                     case ColumnTypeRim::size:
                         visitFSObject(*fsObj, [&](const FolderPair& folder) { /*value = L'<' + _("Folder") + L'>'; -> redundant!? */ },
-                        [&](const FilePair& file) { value = formatNumber(file.getFileSize<side>()); },
+                        [&](const FilePair& file) { value = getCellTextBuffered(row, ColumnTypeRim::size, file.getFileSize<side>()); },
                         //[&](const FilePair& file) { value = numberTo<std::wstring>(file.getFilePrint<side>()); }, // -> test file id
                         [&](const SymlinkPair& symlink) { value = L'<' + _("Symlink") + L'>'; });
                         break;
 
                     case ColumnTypeRim::date:
                         visitFSObject(*fsObj, [](const FolderPair& folder) {},
-                        [&](const FilePair&       file) { value = formatUtcToLocalTime(file   .getLastWriteTime<side>()); },
-                        [&](const SymlinkPair& symlink) { value = formatUtcToLocalTime(symlink.getLastWriteTime<side>()); });
+                        [&](const FilePair&       file) { value = getCellTextBuffered(row, ColumnTypeRim::date, file   .getLastWriteTime<side>()); },
+                        [&](const SymlinkPair& symlink) { value = getCellTextBuffered(row, ColumnTypeRim::date, symlink.getLastWriteTime<side>()); });
                         break;
 
                     case ColumnTypeRim::extension:
@@ -561,6 +562,79 @@ private:
         return {};
     }
 
+    std::wstring getCellTextBuffered(size_t row, ColumnTypeRim colType, const CellTextBuffer::RawValue& value) const
+    {
+        const ObjectId objId = getDataView().getObjectId(row);
+        const uint64_t contentId = getDataView().getContentUpdateId();
+
+        if (std::optional<std::wstring> text = cellTextBuf_.retrieve(objId, colType, contentId))
+            return std::move(*text);
+
+        std::wstring text = CellTextBuffer::formatValue(value);
+        cellTextBuf_.insert(objId, colType, std::wstring(text), contentId);
+        return text;
+    }
+
+    static std::optional<CellTextBuffer::RawValue> getCellRawValue(const FileSystemObject& fsObj, ColumnTypeRim colType)
+    {
+        std::optional<CellTextBuffer::RawValue> value;
+        visitFSObject(fsObj, [](const FolderPair& folder) {},
+        [&](const FilePair& file)
+        {
+            if (colType == ColumnTypeRim::size)
+                value = file.getFileSize<side>();
+            else if (colType == ColumnTypeRim::date)
+                value = file.getLastWriteTime<side>();
+        },
+        [&](const SymlinkPair& symlink)
+        {
+            if (colType == ColumnTypeRim::date)
+                value = symlink.getLastWriteTime<side>();
+        });
+        return value;
+    }
+
+    //format size/date cells ahead of the visible rows, e.g. for "next page": only when visible range or content has changed
+    void prefetchCellTexts()
+    {
+        const auto& [rowFirst, rowLast] = refGrid().getVisibleRows(refGrid().getMainWin().GetClientSize());
+        const PrefetchPos pos{rowFirst, rowLast, getDataView().getObjectId(rowFirst), getDataView().getContentUpdateId()};
+        if (pos == prefetchPosLast_)
+            return;
+        prefetchPosLast_ = pos;
+
+        std::vector<ColumnTypeRim> colTypes;
+        for (const Grid::ColAttributes& ca : refGrid().getColumnConfig())
+            if (ca.visible)
+                switch (static_cast<ColumnTypeRim>(ca.type))
+                {
+                    case ColumnTypeRim::size:
+                    case ColumnTypeRim::date:
+                        colTypes.push_back(static_cast<ColumnTypeRim>(ca.type));
+                        break;
+                    case ColumnTypeRim::path:
+                    case ColumnTypeRim::extension:
+                        break;
+                }
+
+        const ptrdiff_t visibleRowCount = rowLast - rowFirst;
+        const ptrdiff_t preloadSize = 2 * std::max<ptrdiff_t>(20, visibleRowCount); //same as for icons: see getUnbufferedIconsForPreload()
+        const ptrdiff_t rowCount = visibleRowCount + preloadSize;
+
+        std::vector<CellTextBuffer::CellValue> newLoad;
+        for (ptrdiff_t i = 0; i < rowCount; ++i)
+        {
+            const ptrdiff_t currentRow = rowFirst - (preloadSize + 1) / 2 + getAlternatingPos(i, rowCount); //insert least-important items on outer rim first
+
+            if (const FileSystemObject* fsObj = getFsObject(currentRow))
+                if (!fsObj->isEmpty<side>())
+                    for (const ColumnTypeRim colType : colTypes)
+                        if (const std::optional<CellTextBuffer::RawValue> value = getCellRawValue(*fsObj, colType))
+                            newLoad.push_back({getDataView().getObjectId(currentRow), colType, *value});
+        }
+        cellTextBuf_.setWorkload(std::move(newLoad), pos.contentId);
+    }
+
     void renderRowBackgound(wxDC& dc, const wxRect& rect, size_t row, bool enabled, bool selected, HoverArea rowHover) override
     {
         if (!enabled || !selected)
@@ -1155,6 +1229,8 @@ private:
                 case ColumnTypeRim::date:
                 case ColumnTypeRim::extension:
                 {
+                    prefetchCellTexts();
+
                     drawRectangleBorder(dc, rect, borderCol, dipToWxsize(1), wxBOTTOM);
 
                     wxRect rectTmp = rect;
@@ -1348,6 +1424,17 @@ private:
 
     std::vector<int> groupItemNamesWidthBuf_; //buffer! groupItemNamesWidths essentially only depends on (groupIdx, side)
     uint64_t viewUpdateIdLast_ = 0;           //
+
+    struct PrefetchPos
+    {
+        ptrdiff_t rowFirst = 0;
+        ptrdiff_t rowLast  = 0;
+        ObjectId objIdFirst; //detect view filter changes
+        uint64_t contentId = 0;
+        bool operator==(const PrefetchPos&) const = default;
+    };
+    PrefetchPos prefetchPosLast_;
+    mutable CellTextBuffer cellTextBuf_; //buffer formatted size/date texts: getValue() is const
 };
 
 
@@ -5,7 +5,7 @@
 // *****************************************************************************
 
 #include "file_view.h"
-#include <span>
+#include <bit>
 #include <zen/stl_tools.h>
 #include <zen/thread.h>
 
@@ -15,17 +15,17 @@ using namespace fff;
 
 namespace
 {
-void serializeHierarchy(ContainerObject& conObj, std::vector<std::weak_ptr<FileSystemObject>>& output)
+void serializeHierarchy(const ContainerObject& conObj, std::vector<ObjectId>& output)
 {
-    for (FilePair& file : conObj.files())
-        output.push_back(file.weak_from_this());
+    for (const FilePair& file : conObj.files())
+        output.push_back(file.getId());
 
-    for (SymlinkPair& symlink : conObj.symlinks())
-        output.push_back(symlink.weak_from_this());
+    for (const SymlinkPair& symlink : conObj.symlinks())
+        output.push_back(symlink.getId());
 
-    for (FolderPair& folder : conObj.subfolders())
+    for (const FolderPair& folder : conObj.subfolders())
     {
-        output.push_back(folder.weak_from_this());
+        output.push_back(folder.getId());
         serializeHierarchy(folder, output); //add recursion here to list sub-objects directly below parent!
     }
 
@@ -56,60 +56,55 @@ void serializeHierarchy(ContainerObject& conObj, std::vector<std::weak_ptr<FileS
 
 FileView::FileView(FolderComparison& folderCmp)
 {
+    if (!folderCmp.empty())
+        objectIds_ = folderCmp[0].ref().getObjectIdsRef();
+
     for (BaseFolderPair& baseObj : asRange(folderCmp))
         //remove truly empty folder pairs as early as this: we want to distinguish single/multiple folder pair cases by looking at "folderPairs_"
         if (!AFS::isNullPath(baseObj.getAbstractPath<SelectSide::left >()) ||
             !AFS::isNullPath(baseObj.getAbstractPath<SelectSide::right>()))
         {
+            assert(&baseObj.getObjectIds() == &objectIds_.ref());
             serializeHierarchy(baseObj, sortedRef_);
 
             folderPairs_.emplace_back(&baseObj,
                                       baseObj.getAbstractPath<SelectSide::left >(),
                                       baseObj.getAbstractPath<SelectSide::right>());
         }
+
+    resetCategories();
 }
 
 
-template <class Predicate>
-void FileView::updateView(Predicate pred)
+void FileView::updateView(const std::vector<const CategoryRows*>& shownCategories)
 {
     viewRef_               .clear();
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
 
     static uint64_t globalViewUpdateId;
     viewUpdateId_ = ++globalViewUpdateId;
     assert(runningOnMainThread());
 
-    std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
     const ContainerObject* groupStartObj = nullptr;
 
-    for (const std::weak_ptr<FileSystemObject>& objRef : sortedRef_)
-        if (const FileSystemObject* fsObj = objRef.lock().get())
-            if (pred(*fsObj))
-            {
-                const size_t row = viewRef_.size();
-
-                //save row position for direct random access to FilePair or FolderPair
-                rowPositions_.emplace(fsObj, row); //costs: 0.28 µs per call - MSVC based on std::set
+    const size_t wordCount = (sortedRef_.size() + 63) / 64;
 
-                parentsBuf.clear();
-                for (const FileSystemObject* fsObj2 = fsObj;;)
-                {
-                    const ContainerObject& parent = fsObj2->parent();
-                    parentsBuf.push_back(&parent);
+    for (size_t wordIdx = 0; wordIdx < wordCount; ++wordIdx)
+    {
+        uint64_t rowBits = 0;
+        for (const CategoryRows* catRows : shownCategories)
+            rowBits |= catRows->rowBits[wordIdx];
 
-                    fsObj2 = dynamic_cast<const FolderPair*>(&parent);
-                    if (!fsObj2)
-                        break;
-                }
+        for (; rowBits != 0; rowBits &= rowBits - 1) //sorted order: iterate set bits from lowest to highest
+        {
+            const ObjectId objId = sortedRef_[wordIdx * 64 + std::countr_zero(rowBits)];
 
-                //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
-                for (const ContainerObject* parent : parentsBuf)
-                    if (const auto [it, inserted] = rowPositionsFirstChild_.emplace(parent, row);
-                        !inserted) //=> parents further up in hierarchy already inserted!
-                        break;
+            if (const FileSystemObject* fsObj = objectIds_.ref().get(objId))
+            {
+                const size_t row = viewRef_.size();
 
                 //------ save info to aggregate rows by parent folders ------
                 if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
@@ -125,13 +120,50 @@ void FileView::updateView(Predicate pred)
                 assert(!groupDetails_.empty());
                 const size_t groupIdx = groupDetails_.size() - 1;
                 //-----------------------------------------------------------
-                viewRef_.push_back({objRef, groupIdx});
+                viewRef_.push_back({objId, groupIdx});
             }
+        }
+    }
+}
+
+
+void FileView::updateRowPositions() const
+{
+    if (rowPositionsValid_)
+        return;
+    rowPositionsValid_ = true;
+
+    std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
+
+    for (size_t row = 0; row < viewRef_.size(); ++row)
+        if (const FileSystemObject* fsObj = objectIds_.ref().get(viewRef_[row].objId))
+        {
+            //save row position for direct random access to FilePair or FolderPair
+            rowPositions_.emplace(fsObj, row); //costs: 0.28 µs per call - MSVC based on std::set
+
+            parentsBuf.clear();
+            for (const FileSystemObject* fsObj2 = fsObj;;)
+            {
+                const ContainerObject& parent = fsObj2->parent();
+                parentsBuf.push_back(&parent);
+
+                fsObj2 = dynamic_cast<const FolderPair*>(&parent);
+                if (!fsObj2)
+                    break;
+            }
+
+            //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
+            for (const ContainerObject* parent : parentsBuf)
+                if (const auto [it, inserted] = rowPositionsFirstChild_.emplace(parent, row);
+                    !inserted) //=> parents further up in hierarchy already inserted!
+                    break;
+        }
 }
 
 
 ptrdiff_t FileView::findRowDirect(const FileSystemObject* fsObj) const
 {
+    updateRowPositions();
     auto it = rowPositions_.find(fsObj);
     return it != rowPositions_.end() ? it->second : -1;
 }
@@ -139,6 +171,7 @@ ptrdiff_t FileView::findRowDirect(const FileSystemObject* fsObj) const
 
 ptrdiff_t FileView::findRowFirstChild(const ContainerObject* conObj) const
 {
+    updateRowPositions();
     auto it = rowPositionsFirstChild_.find(conObj);
     return it != rowPositionsFirstChild_.end() ? it->second : -1;
 }
@@ -181,6 +214,255 @@ void addNumbers(const FileSystemObject& fsObj, ViewStats& stats)
             ++stats.fileStatsRight.fileCount;
     });
 }
+
+
+void addFileStats(FileView::FileStats& stats, const FileView::FileStats& delta)
+{
+    stats.fileCount   += delta.fileCount;
+    stats.folderCount += delta.folderCount;
+    stats.bytes       += delta.bytes;
+}
+
+
+void subtractFileStats(FileView::FileStats& stats, const FileView::FileStats& delta)
+{
+    stats.fileCount   -= delta.fileCount;
+    stats.folderCount -= delta.folderCount;
+    stats.bytes       -= delta.bytes;
+}
+
+
+enum DiffCategory //view filter buttons for FileView::applyDifferenceFilter()
+{
+    DIFF_LEFT_ONLY,
+    DIFF_RIGHT_ONLY,
+    DIFF_LEFT_NEWER,
+    DIFF_RIGHT_NEWER,
+    DIFF_DIFFERENT,
+    DIFF_EQUAL,
+    DIFF_CONFLICT,
+    DIFF_CATEGORY_COUNT
+};
+
+
+enum ActionCategory //view filter buttons for FileView::applyActionFilter()
+{
+    ACTION_CREATE_LEFT,
+    ACTION_CREATE_RIGHT,
+    ACTION_DELETE_LEFT,
+    ACTION_DELETE_RIGHT,
+    ACTION_UPDATE_LEFT,
+    ACTION_MOVE_LEFT, //two rows per move operation
+    ACTION_UPDATE_RIGHT,
+    ACTION_MOVE_RIGHT, //
+    ACTION_DO_NOTHING,
+    ACTION_EQUAL,
+    ACTION_CONFLICT,
+    ACTION_CATEGORY_COUNT
+};
+
+
+DiffCategory getDiffCategory(CompareFileResult cmpResult)
+{
+    switch (cmpResult)
+    {
+        case FILE_LEFT_ONLY:
+            return DIFF_LEFT_ONLY;
+        case FILE_RIGHT_ONLY:
+            return DIFF_RIGHT_ONLY;
+        case FILE_LEFT_NEWER:
+            return DIFF_LEFT_NEWER;
+        case FILE_RIGHT_NEWER:
+            return DIFF_RIGHT_NEWER;
+        case FILE_DIFFERENT_CONTENT:
+            return DIFF_DIFFERENT;
+        case FILE_EQUAL:
+            return DIFF_EQUAL;
+        case FILE_RENAMED:
+        case FILE_CONFLICT:
+        case FILE_TIME_INVALID:
+            return DIFF_CONFLICT;
+    }
+    assert(false);
+    return DIFF_CONFLICT;
+}
+
+
+ActionCategory getActionCategory(SyncOperation syncOp)
+{
+    switch (syncOp) //evaluate comparison result and sync direction
+    {
+        case SO_CREATE_LEFT:
+            return ACTION_CREATE_LEFT;
+        case SO_CREATE_RIGHT:
+            return ACTION_CREATE_RIGHT;
+        case SO_DELETE_LEFT:
+            return ACTION_DELETE_LEFT;
+        case SO_DELETE_RIGHT:
+            return ACTION_DELETE_RIGHT;
+        case SO_OVERWRITE_LEFT:
+        case SO_RENAME_LEFT:
+            return ACTION_UPDATE_LEFT;
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_LEFT_TO:
+            return ACTION_MOVE_LEFT;
+        case SO_OVERWRITE_RIGHT:
+        case SO_RENAME_RIGHT:
+            return ACTION_UPDATE_RIGHT;
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_RIGHT_TO:
+            return ACTION_MOVE_RIGHT;
+        case SO_DO_NOTHING:
+            return ACTION_DO_NOTHING;
+        case SO_EQUAL:
+            return ACTION_EQUAL;
+        case SO_UNRESOLVED_CONFLICT:
+            return ACTION_CONFLICT;
+    }
+    assert(false);
+    return ACTION_CONFLICT;
+}
+
+
+inline size_t getCategoryIdx(size_t category, bool active) { return 2 * category + (active ? 1 : 0); }
+
+
+template <class Category>
+struct ViewFilterInput
+{
+    Category category;
+    bool show;
+    int* categoryCount;
+};
+
+
+template <class CategoryRows, class Category, size_t filterCount, class ViewStats>
+std::vector<const CategoryRows*> applyViewFilter(const std::vector<CategoryRows>& categories, //in
+                                                 const ViewFilterInput<Category> (&filters)[filterCount], //in
+                                                 bool showExcluded, ViewStats& stats) //in, out
+{
+    std::vector<const CategoryRows*> shownCategories;
+
+    for (const ViewFilterInput<Category>& filter : filters)
+        for (const bool active : {true, false})
+        {
+            const CategoryRows& catRows = categories[getCategoryIdx(filter.category, active)];
+            if (!active)
+            {
+                stats.excluded += catRows.rowCount;
+                if (!showExcluded)
+                    continue;
+            }
+            *filter.categoryCount += catRows.rowCount;
+            if (!filter.show)
+                continue;
+
+            //total number of bytes for each side
+            addFileStats(stats.fileStatsLeft,  catRows.fileStatsLeft);
+            addFileStats(stats.fileStatsRight, catRows.fileStatsRight);
+
+            if (catRows.rowCount > 0)
+                shownCategories.push_back(&catRows);
+        }
+    return shownCategories;
+}
+
+
+uint64_t getNextContentUpdateId()
+{
+    static uint64_t globalContentUpdateId;
+    assert(runningOnMainThread());
+    return ++globalContentUpdateId;
+}
+}
+
+
+void FileView::resetCategories()
+{
+    contentUpdateId_ = getNextContentUpdateId();
+
+    const size_t wordCount = (sortedRef_.size() + 63) / 64;
+
+    diffCategories_  .assign(2 * DIFF_CATEGORY_COUNT,   CategoryRows{std::vector<uint64_t>(wordCount)});
+    actionCategories_.assign(2 * ACTION_CATEGORY_COUNT, CategoryRows{std::vector<uint64_t>(wordCount)});
+
+    rowCategories_.clear();
+    rowCategories_.reserve(sortedRef_.size());
+
+    for (size_t row = 0; row < sortedRef_.size(); ++row)
+    {
+        RowCategories rowCat;
+        if (const FileSystemObject* fsObj = objectIds_.ref().get(sortedRef_[row]))
+        {
+            rowCat.diffIdx   = static_cast<unsigned char>(getCategoryIdx(getDiffCategory  (fsObj->getCategory     ()), fsObj->isActive()));
+            rowCat.actionIdx = static_cast<unsigned char>(getCategoryIdx(getActionCategory(fsObj->getSyncOperation()), fsObj->isActive()));
+
+            for (CategoryRows* catRows : {&diffCategories_[rowCat.diffIdx], &actionCategories_[rowCat.actionIdx]})
+            {
+                catRows->rowBits[row / 64] |= uint64_t(1) << (row % 64);
+                ++catRows->rowCount;
+                addNumbers(*fsObj, *catRows);
+            }
+        }
+        //else: deleted meanwhile => not part of any category
+        rowCategories_.push_back(rowCat);
+    }
+}
+
+
+void FileView::updateCategories()
+{
+    assert(rowCategories_.size() == sortedRef_.size());
+    contentUpdateId_ = getNextContentUpdateId();
+
+    for (size_t row = 0; row < sortedRef_.size(); ++row)
+    {
+        RowCategories& rowCat = rowCategories_[row];
+
+        if (const FileSystemObject* fsObj = objectIds_.ref().get(sortedRef_[row]))
+        {
+            const RowCategories rowCatNew
+            {
+                static_cast<unsigned char>(getCategoryIdx(getDiffCategory  (fsObj->getCategory     ()), fsObj->isActive())),
+                static_cast<unsigned char>(getCategoryIdx(getActionCategory(fsObj->getSyncOperation()), fsObj->isActive())),
+            };
+            if (rowCatNew != rowCat)
+            {
+                if (rowCat == RowCategories()) //not indexed?
+                    return resetCategories();
+
+                //item sizes are unchanged => subtract the same numbers that were added
+                struct
+                {
+                    FileStats fileStatsLeft;
+                    FileStats fileStatsRight;
+                } rowStats;
+                addNumbers(*fsObj, rowStats);
+
+                auto moveRow = [&](std::vector<CategoryRows>& categories, size_t idxOld, size_t idxNew)
+                {
+                    if (idxOld == idxNew)
+                        return;
+                    CategoryRows& catRowsOld = categories[idxOld];
+                    CategoryRows& catRowsNew = categories[idxNew];
+
+                    catRowsOld.rowBits[row / 64] &= ~(uint64_t(1) << (row % 64));
+                    catRowsNew.rowBits[row / 64] |=   uint64_t(1) << (row % 64);
+                    --catRowsOld.rowCount;
+                    ++catRowsNew.rowCount;
+                    subtractFileStats(catRowsOld.fileStatsLeft,  rowStats.fileStatsLeft);
+                    subtractFileStats(catRowsOld.fileStatsRight, rowStats.fileStatsRight);
+                    addFileStats     (catRowsNew.fileStatsLeft,  rowStats.fileStatsLeft);
+                    addFileStats     (catRowsNew.fileStatsRight, rowStats.fileStatsRight);
+                };
+                moveRow(diffCategories_,   rowCat.diffIdx,   rowCatNew.diffIdx);
+                moveRow(actionCategories_, rowCat.actionIdx, rowCatNew.actionIdx);
+                rowCat = rowCatNew;
+            }
+        }
+        else if (rowCat != RowCategories()) //deleted meanwhile: numbers to subtract are unknown
+            return resetCategories();
+    }
 }
 
 
@@ -195,47 +477,19 @@ FileView::DifferenceViewStats FileView::applyDifferenceFilter(bool showExcluded,
 {
     DifferenceViewStats stats;
 
-    updateView([&](const FileSystemObject& fsObj)
+    const ViewFilterInput<DiffCategory> filters[] =
     {
-        auto categorize = [&](bool showCategory, int& categoryCount)
-        {
-            if (!fsObj.isActive())
-            {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
-            }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
-
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
-
-        switch (fsObj.getCategory())
-        {
-            case FILE_LEFT_ONLY:
-                return categorize(showLeftOnly, stats.leftOnly);
-            case FILE_RIGHT_ONLY:
-                return categorize(showRightOnly, stats.rightOnly);
-            case FILE_LEFT_NEWER:
-                return categorize(showLeftNewer, stats.leftNewer);
-            case FILE_RIGHT_NEWER:
-                return categorize(showRightNewer, stats.rightNewer);
-            case FILE_DIFFERENT_CONTENT:
-                return categorize(showDifferent, stats.different);
-            case FILE_EQUAL:
-                return categorize(showEqual, stats.equal);
-            case FILE_RENAMED:
-            case FILE_CONFLICT:
-            case FILE_TIME_INVALID:
-                return categorize(showConflict, stats.conflict);
-        }
-        assert(false);
-        return true;
-    });
+        {DIFF_LEFT_ONLY,   showLeftOnly,   &stats.leftOnly},
+        {DIFF_RIGHT_ONLY,  showRightOnly,  &stats.rightOnly},
+        {DIFF_LEFT_NEWER,  showLeftNewer,  &stats.leftNewer},
+        {DIFF_RIGHT_NEWER, showRightNewer, &stats.rightNewer},
+        {DIFF_DIFFERENT,   showDifferent,  &stats.different},
+        {DIFF_EQUAL,       showEqual,      &stats.equal},
+        {DIFF_CONFLICT,    showConflict,   &stats.conflict},
+    };
+    static_assert(std::size(filters) == DIFF_CATEGORY_COUNT);
 
+    updateView(applyViewFilter(diffCategories_, filters, showExcluded, stats));
     return stats;
 }
 
@@ -256,56 +510,23 @@ FileView::ActionViewStats FileView::applyActionFilter(bool showExcluded, //maps
     int moveLeft  = 0;
     int moveRight = 0;
 
-    updateView([&](const FileSystemObject& fsObj)
+    const ViewFilterInput<ActionCategory> filters[] =
     {
-        auto categorize = [&](bool showCategory, int& categoryCount)
-        {
-            if (!fsObj.isActive())
-            {
-                ++stats.excluded;
-                if (!showExcluded)
-                    return false;
-            }
-            ++categoryCount;
-            if (!showCategory)
-                return false;
-
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
-            return true;
-        };
+        {ACTION_CREATE_LEFT,  showCreateLeft,  &stats.createLeft},
+        {ACTION_CREATE_RIGHT, showCreateRight, &stats.createRight},
+        {ACTION_DELETE_LEFT,  showDeleteLeft,  &stats.deleteLeft},
+        {ACTION_DELETE_RIGHT, showDeleteRight, &stats.deleteRight},
+        {ACTION_UPDATE_LEFT,  showUpdateLeft,  &stats.updateLeft},
+        {ACTION_MOVE_LEFT,    showUpdateLeft,  &moveLeft},
+        {ACTION_UPDATE_RIGHT, showUpdateRight, &stats.updateRight},
+        {ACTION_MOVE_RIGHT,   showUpdateRight, &moveRight},
+        {ACTION_DO_NOTHING,   showDoNothing,   &stats.updateNone},
+        {ACTION_EQUAL,        showEqual,       &stats.equal},
+        {ACTION_CONFLICT,     showConflict,    &stats.conflict},
+    };
+    static_assert(std::size(filters) == ACTION_CATEGORY_COUNT);
 
-        switch (fsObj.getSyncOperation()) //evaluate comparison result and sync direction
-        {
-            case SO_CREATE_LEFT:
-                return categorize(showCreateLeft, stats.createLeft);
-            case SO_CREATE_RIGHT:
-                return categorize(showCreateRight, stats.createRight);
-            case SO_DELETE_LEFT:
-                return categorize(showDeleteLeft, stats.deleteLeft);
-            case SO_DELETE_RIGHT:
-                return categorize(showDeleteRight, stats.deleteRight);
-            case SO_OVERWRITE_LEFT:
-            case SO_RENAME_LEFT:
-                return categorize(showUpdateLeft, stats.updateLeft);
-            case SO_MOVE_LEFT_FROM:
-            case SO_MOVE_LEFT_TO:
-                return categorize(showUpdateLeft, moveLeft);
-            case SO_OVERWRITE_RIGHT:
-            case SO_RENAME_RIGHT:
-                return categorize(showUpdateRight, stats.updateRight);
-            case SO_MOVE_RIGHT_FROM:
-            case SO_MOVE_RIGHT_TO:
-                return categorize(showUpdateRight, moveRight);
-            case SO_DO_NOTHING:
-                return categorize(showDoNothing, stats.updateNone);
-            case SO_EQUAL:
-                return categorize(showEqual, stats.equal);
-            case SO_UNRESOLVED_CONFLICT:
-                return categorize(showConflict, stats.conflict);
-        }
-        assert(false);
-        return true;
-    });
+    updateView(applyViewFilter(actionCategories_, filters, showExcluded, stats));
 
     assert(moveLeft % 2 == 0 && moveRight % 2 == 0);
     stats.updateLeft  += moveLeft  / 2; //count move operations as single update
@@ -323,8 +544,8 @@ std::vector<FileSystemObject*> FileView::getAllFileRef(const std::vector<size_t>
 
     for (size_t pos : rows)
         if (pos < viewSize)
-            if (const std::shared_ptr<FileSystemObject> fsObj = viewRef_[pos].objRef.lock())
-                output.push_back(fsObj.get());
+            if (FileSystemObject* fsObj = objectIds_.ref().get(viewRef_[pos].objId))
+                output.push_back(fsObj);
 
     return output;
 }
@@ -342,7 +563,7 @@ FileView::PathDrawInfo FileView::getDrawInfo(size_t row)
         const size_t groupLastRow = groupIdx + 1 < groupDetails_.size() ?
                                     groupDetails_[groupIdx + 1].groupFirstRow :
                                     viewRef_.size();
-        FileSystemObject* fsObj = viewRef_[row].objRef.lock().get();
+        FileSystemObject* fsObj = objectIds_.ref().get(viewRef_[row].objId);
 
         FolderPair* folderGroupObj = dynamic_cast<FolderPair*>(fsObj);
         if (fsObj && !folderGroupObj)
@@ -358,12 +579,14 @@ FileView::PathDrawInfo FileView::getDrawInfo(size_t row)
 void FileView::removeInvalidRows()
 {
     //remove rows that have been deleted meanwhile
-    std::erase_if(sortedRef_, [&](const std::weak_ptr<FileSystemObject>& objRef) { return objRef.expired(); });
+    std::erase_if(sortedRef_, [&](ObjectId objId) { return !objectIds_.ref().get(objId); });
 
     viewRef_               .clear();
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+
+    resetCategories(); //also for remaining rows: item sizes have changed after synchronization
 }
 
 
@@ -385,391 +608,393 @@ bool isDirectoryPair(const FileSystemObject& fsObj)
 }
 
 
-template <SortDirection sortDir, SelectSide side> inline
-bool lessFileName(const FileSystemObject& lhs, const FileSystemObject& rhs)
+/* sorting millions of rows: comparing rows directly means table lookups, dynamic_casts and Unicode normalization for *each* comparison
+   => calculate a compact sort key once per row (in parallel), stable-sort chunks of (key, row) pairs in parallel, merge pairwise, then apply the permutation  */
+template <class Key>
+struct RowSortKey
 {
-    //sort order: first files/symlinks, then directories then empty rows
+    Key key;
+    size_t row = 0; //position in sortedRef_
+};
 
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
+constexpr size_t SORT_ROWS_PER_THREAD_MIN = 50'000; //don't bother starting threads for small lists
 
-    //directories after files/symlinks:
-    if (isDirectoryPair(lhs))
-    {
-        if (!isDirectoryPair(rhs))
-            return false;
-    }
-    else if (isDirectoryPair(rhs))
-        return true;
 
-    return isLessFor<sortDir>(LessNaturalSort() /*even on Linux*/, lhs.getItemName<side>(), rhs.getItemName<side>());
-}
+enum class KeyAccess
+{
+    parallel,
+    sequential, //getKey() is not thread-safe: e.g. FolderPair::getSyncOperation() lazily fills its buffer
+};
 
 
-template <SortDirection sortDir, SelectSide side>  inline
-bool lessFilePath(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs,
-                  const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos,
-                  std::vector<const FolderPair*>& tempBuf)
+template <class GetKey, class LessKey>
+void sortRows(std::vector<ObjectId>& rows, const ObjectIdTable& objectIds, GetKey getKey, LessKey lessKey, KeyAccess keyAccess = KeyAccess::parallel)
 {
-    const FileSystemObject* fsObjL = lhs.lock().get();
-    const FileSystemObject* fsObjR = rhs.lock().get();
-    if (!fsObjL) //invalid rows shall appear at the end
-        return false;
-    else if (!fsObjR)
-        return true;
+    using Key = decltype(getKey(static_cast<const FileSystemObject*>(nullptr)));
 
-    //------- presort by folder pair ----------
-    {
-        auto itL = sortedPos.find(&fsObjL->base());
-        auto itR = sortedPos.find(&fsObjR->base());
-        assert(itL != sortedPos.end() && itR != sortedPos.end());
-        if (itL == sortedPos.end()) //invalid rows shall appear at the end
-            return false;
-        else if (itR == sortedPos.end())
-            return true;
-
-        const size_t basePosL = itL->second;
-        const size_t basePosR = itR->second;
-
-        if (basePosL != basePosR)
-            return isLessFor<sortDir>(std::less(), basePosL, basePosR);
-    }
+    std::vector<RowSortKey<Key>> sortKeys(rows.size());
 
-    //------- sort component-wise ----------
-    const auto folderL = dynamic_cast<const FolderPair*>(fsObjL);
-    const auto folderR = dynamic_cast<const FolderPair*>(fsObjR);
+    const auto lessRow = [&](const RowSortKey<Key>& lhs, const RowSortKey<Key>& rhs) { return lessKey(lhs.key, rhs.key); };
 
-    std::vector<const FolderPair*>& parentsBuf = tempBuf; //from bottom to top of hierarchy, excluding base
-    parentsBuf.clear();
+    const size_t threadCount = std::clamp<size_t>(rows.size() / SORT_ROWS_PER_THREAD_MIN, 1, std::max(std::thread::hardware_concurrency(), 1U));
 
-    const auto collectParents = [&](const FileSystemObject* fsObj)
+    std::vector<size_t> chunkBegin; //chunk i: [chunkBegin[i], chunkBegin[i + 1])
+    for (size_t i = 0; i <= threadCount; ++i)
+        chunkBegin.push_back(rows.size() * i / threadCount);
+
+    const auto calcKeys = [&](size_t rowBegin, size_t rowEnd)
     {
-        for (;;)
-            if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj->parent())) //perf: most expensive part of this function!
-            {
-                parentsBuf.push_back(folder);
-                fsObj = folder;
-            }
-            else
-                break;
+        for (size_t row = rowBegin; row < rowEnd; ++row)
+            sortKeys[row] = {getKey(objectIds.get(rows[row])), row};
     };
-    if (folderL)
-        parentsBuf.push_back(folderL);
-    collectParents(fsObjL);
-    const size_t parentsSizeL = parentsBuf.size();
 
-    if (folderR)
-        parentsBuf.push_back(folderR);
-    collectParents(fsObjR);
+    if (keyAccess == KeyAccess::sequential)
+        calcKeys(0, rows.size());
 
-    const std::span<const FolderPair*> parentsL(parentsBuf.data(), parentsSizeL); //no construction via iterator (yet): https://github.com/cplusplus/draft/pull/3456
-    const std::span<const FolderPair*> parentsR(parentsBuf.data() + parentsSizeL, parentsBuf.size() - parentsSizeL);
+    const auto sortChunk = [&](size_t chunkIdx)
+    {
+        if (keyAccess == KeyAccess::parallel)
+            calcKeys(chunkBegin[chunkIdx], chunkBegin[chunkIdx + 1]);
+
+        std::stable_sort(sortKeys.begin() + chunkBegin[chunkIdx], sortKeys.begin() + chunkBegin[chunkIdx + 1], lessRow);
+    };
 
-    const auto& [itL, itR] = std::mismatch(parentsL.rbegin(), parentsL.rend(),
-                                           parentsR.rbegin(), parentsR.rend());
-    if (itL == parentsL.rend())
+    if (threadCount == 1)
+        sortChunk(0);
+    else
     {
-        if (itR == parentsR.rend())
-        {
-            //make folders always appear before contained files
-            if (folderR)
-                return false;
-            else if (folderL)
-                return true;
+        ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Sort File List"));
+
+        for (size_t i = 0; i < threadCount; ++i)
+            tg.run([&, i] { sortChunk(i); });
+        tg.wait();
 
-            return isLessFor<sortDir>(LessNaturalSort(), fsObjL->getItemName<side>(), fsObjR->getItemName<side>());
+        //merge neighboring chunks: result is stable, since chunks are in original row order
+        for (size_t width = 1; width < threadCount; width *= 2)
+        {
+            for (size_t i = 0; i + width < threadCount; i += 2 * width)
+                tg.run([&, i, width]
+                {
+                    std::inplace_merge(sortKeys.begin() + chunkBegin[i],
+                                       sortKeys.begin() + chunkBegin[i + width],
+                                       sortKeys.begin() + chunkBegin[std::min(i + 2 * width, threadCount)], lessRow);
+                });
+            tg.wait();
         }
-        else
-            return true;
     }
-    else if (itR == parentsR.rend())
-        return false;
 
-    //different components...
-    if (const std::weak_ordering cmp = compareNatural((*itL)->getItemName<side>(), (*itR)->getItemName<side>());
-        cmp != std::weak_ordering::equivalent)
-    {
-        if constexpr (sortDir == SortDirection::ascending)
-            return std::is_lt(cmp);
-        else
-            return std::is_gt(cmp);
-    }
-    //return isLessFor<sortDir>(std::less(), rv, 0);
+    std::vector<ObjectId> rowsSorted;
+    rowsSorted.reserve(rows.size());
+
+    for (const RowSortKey<Key>& sk : sortKeys)
+        rowsSorted.push_back(rows[sk.row]);
 
-    /*...with equivalent names:
-        1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
-        2. ensure stable sort order                                                            */
-    return *itL < *itR;
+    rows.swap(rowsSorted);
 }
 
+//-------------------------------------------------------------------------------------------------------
 
-template <SortDirection sortDir, SelectSide side> inline
-bool lessFilesize(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <class Value>
+struct SortKey
 {
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
+    unsigned char rank = 0; //sort order independent from sort direction, e.g. empty rows always last
+    Value value{};
+};
+
+constexpr unsigned char RANK_INVALID_ROW = 0xff; //invalid rows shall appear at the end
 
-    //directories second last
-    if (isDirectoryPair(lhs))
-        return false;
-    else if (isDirectoryPair(rhs))
-        return true;
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
+template <SortDirection sortDir>
+struct LessSortKey
+{
+    template <class Value>
+    bool operator()(const SortKey<Value>& lhs, const SortKey<Value>& rhs) const
+    {
+        if (lhs.rank != rhs.rank)
+            return lhs.rank < rhs.rank;
+
+        return isLessFor<sortDir>(std::less(), lhs.value, rhs.value);
+    }
+};
 
-    //then symlinks
-    if (!fileL)
-        return false;
-    else if (!fileR)
-        return true;
 
-    //return list beginning with largest files first
-    return isLessFor<sortDir>(std::less(), fileL->getFileSize<side>(), fileR->getFileSize<side>());
+template <SelectSide side>
+SortKey<std::string> getFileNameKey(const FileSystemObject* fsObj)
+{
+    //sort order: first files/symlinks, then directories then empty rows
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
+
+    if (fsObj->isEmpty<side>())
+        return {2};
+
+    return {static_cast<unsigned char>(isDirectoryPair(*fsObj) ? 1 : 0), getNaturalSortKey(fsObj->getItemName<side>()) /*even on Linux*/};
 }
 
 
-template <SortDirection sortDir, SelectSide side> inline
-bool lessFiletime(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <SelectSide side>
+SortKey<std::string> getExtensionKey(const FileSystemObject* fsObj)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
+
+    if (fsObj->isEmpty<side>())
+        return {2}; //empty rows always last
+
+    if (isDirectoryPair(*fsObj))
+        return {1}; //directories last
+
+    return {0, getNaturalSortKey(afterLast(fsObj->getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none)) /*even on Linux*/};
+}
+
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
+template <SelectSide side>
+SortKey<uint64_t> getFileSizeKey(const FileSystemObject* fsObj)
+{
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
 
-    const SymlinkPair* symlinkL = dynamic_cast<const SymlinkPair*>(&lhs);
-    const SymlinkPair* symlinkR = dynamic_cast<const SymlinkPair*>(&rhs);
+    if (fsObj->isEmpty<side>())
+        return {3}; //empty rows always last
 
-    if (!fileL && !symlinkL)
-        return false; //directories last
-    else if (!fileR && !symlinkR)
-        return true; //directories last
+    if (isDirectoryPair(*fsObj))
+        return {2}; //directories second last
 
-    const int64_t dateL = fileL ? fileL->getLastWriteTime<side>() : symlinkL->getLastWriteTime<side>();
-    const int64_t dateR = fileR ? fileR->getLastWriteTime<side>() : symlinkR->getLastWriteTime<side>();
+    if (const FilePair* file = dynamic_cast<const FilePair*>(fsObj))
+        return {0, file->getFileSize<side>()};
 
-    //return list beginning with newest files first
-    return isLessFor<sortDir>(std::less(), dateL, dateR);
+    return {1}; //then symlinks
 }
 
 
-template <SortDirection sortDir, SelectSide side> inline
-bool lessExtension(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <SelectSide side>
+SortKey<int64_t> getFileTimeKey(const FileSystemObject* fsObj)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
 
-    if (dynamic_cast<const FolderPair*>(&lhs))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&rhs))
-        return true; //directories last
+    if (fsObj->isEmpty<side>())
+        return {2}; //empty rows always last
 
-    auto getExtension = [](const FileSystemObject& fsObj)
-    {
-        return afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none);
-    };
+    if (const FilePair* file = dynamic_cast<const FilePair*>(fsObj))
+        return {0, file->getLastWriteTime<side>()};
 
-    return isLessFor<sortDir>(LessNaturalSort() /*even on Linux*/, getExtension(lhs), getExtension(rhs));
+    if (const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(fsObj))
+        return {0, symlink->getLastWriteTime<side>()};
+
+    return {1}; //directories last
 }
 
 
-template <SortDirection sortDir> inline
-bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
+SortKey<int> getCmpResultKey(const FileSystemObject* fsObj)
 {
-    return isLessFor<sortDir>([](CompareFileResult lhs2, CompareFileResult rhs2)
-    {
-        //presort: equal shall appear at end of list
-        if (lhs2 == FILE_EQUAL)
-            return false;
-        if (rhs2 == FILE_EQUAL)
-            return true;
-        return lhs2 < rhs2;
-    },
-    lhs.getCategory(), rhs.getCategory());
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
+
+    const CompareFileResult cmpResult = fsObj->getCategory();
+    return {0, cmpResult == FILE_EQUAL ? std::numeric_limits<int>::max() : static_cast<int>(cmpResult)}; //presort: equal shall appear at end of list
 }
 
 
-template <SortDirection sortDir> inline
-bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
+SortKey<SyncOperation> getSyncDirectionKey(const FileSystemObject* fsObj)
 {
-    return isLessFor<sortDir>(std::less(), lhs.getSyncOperation(), rhs.getSyncOperation());
+    if (!fsObj)
+        return {RANK_INVALID_ROW};
+
+    return {0, fsObj->getSyncOperation()};
 }
 
+//-------------------------------------------------------------------------------------------------------
+
+/* sort by path: component-wise natural sort order, files before sibling folders, folders before their contents
+   => equivalent to pre-order traversal with sorted siblings: rank each folder once, then sort rows by (base folder, parent folder rank, item name) */
+struct PathSortKey
+{
+    bool invalidRow = false;
+    size_t basePos = 0;   //position of base folder pair
+    size_t groupRank = 0; //folder: own rank, file/symlink: rank of parent folder; 0: base folder
+    bool isFolder = false;
+    std::string itemName; //files/symlinks only: natural sort key
+};
 
-template <SortDirection sortDir, SelectSide side>
-struct LessFullPath
+
+template <SortDirection sortDir>
+struct LessPathSortKey
 {
-    LessFullPath(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
+    bool operator()(const PathSortKey& lhs, const PathSortKey& rhs) const
     {
-        //calculate positions of base folders sorted by name
-        std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
-        {
-            const auto& [baseObjA, basePathLA, basePathRA] = a;
-            const auto& [baseObjB, basePathLB, basePathRB] = b;
+        if (lhs.invalidRow != rhs.invalidRow)
+            return rhs.invalidRow; //invalid rows shall appear at the end
 
-            const AbstractPath& basePathA = selectParam<side>(basePathLA, basePathRA);
-            const AbstractPath& basePathB = selectParam<side>(basePathLB, basePathRB);
+        if (lhs.basePos != rhs.basePos)
+            return isLessFor<sortDir>(std::less(), lhs.basePos, rhs.basePos);
 
-            return LessNaturalSort()/*even on Linux*/(utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
-                                                      utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
-        });
+        if (lhs.groupRank != rhs.groupRank)
+            return lhs.groupRank < rhs.groupRank; //sort direction already considered by folder ranks
 
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            shared_.ref().sortedPos.emplace(baseObj, pos++);
-    }
+        if (lhs.isFolder != rhs.isFolder)
+            return lhs.isFolder; //make folders always appear before contained files
 
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
-    {
-        return lessFilePath<sortDir, side>(lhs, rhs, shared_.ref().sortedPos, shared_.ref().tempBuf);
+        return isLessFor<sortDir>(std::less(), lhs.itemName, rhs.itemName);
     }
-
-private:
-    struct Shared
-    {
-        std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> sortedPos;
-        mutable std::vector<const FolderPair*> tempBuf; //avoid repeated memory allocation in lessFilePath()
-    };
-    SharedRef<Shared> shared_ = makeSharedRef<Shared>(); //std::sort makes lots of predicate copies during its "divide and conquer"
 };
 
 
 template <SortDirection sortDir, SelectSide side>
-struct LessRelativeFolder
+std::unordered_map<const FolderPair*, size_t /*rank*/> getFolderRanks(const std::vector<ObjectId>& rows, const ObjectIdTable& objectIds)
 {
-    LessRelativeFolder(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
+    struct FolderInfo
     {
-        size_t pos = 0; //take over positions of base folders as set up by user
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            shared_.ref().sortedPos.emplace(baseObj, pos++);
-    }
+        const FolderPair* folder = nullptr;
+        std::string nameKey;
+        std::vector<size_t> subfolders;
+    };
+    std::vector<FolderInfo> folders;
+    std::unordered_map<const FolderPair*, size_t /*index into "folders"*/> folderIdxs;
+    std::unordered_map<const void* /*BaseFolderPair*/, std::vector<size_t>> topFolders;
 
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
+    std::vector<const FolderPair*> parentsBuf; //from bottom to top of hierarchy
+    const auto addFolder = [&](const FolderPair* folder)
     {
-        return lessFilePath<sortDir, side>(lhs, rhs, shared_.ref().sortedPos, shared_.ref().tempBuf);
-    }
+        parentsBuf.clear();
+        for (; folder && !folderIdxs.contains(folder); folder = dynamic_cast<const FolderPair*>(&folder->parent()))
+            parentsBuf.push_back(folder);
 
-private:
-    struct Shared
-    {
-        std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> sortedPos;
-        mutable std::vector<const FolderPair*> tempBuf; //avoid repeated memory allocation in lessFilePath()
+        for (auto it = parentsBuf.rbegin(); it != parentsBuf.rend(); ++it)
+        {
+            const size_t folderIdx = folders.size();
+            folders.push_back({*it, getNaturalSortKey((*it)->getItemName<side>()) /*even on Linux*/});
+            folderIdxs.emplace(*it, folderIdx);
+
+            if (const auto parentFolder = dynamic_cast<const FolderPair*>(&(*it)->parent()))
+                folders[folderIdxs.find(parentFolder)->second].subfolders.push_back(folderIdx);
+            else
+                topFolders[&(*it)->base()].push_back(folderIdx);
+        }
     };
-    SharedRef<Shared> shared_ = makeSharedRef<Shared>(); //std::sort makes lots of predicate copies during its "divide and conquer"
-};
 
+    for (const ObjectId row : rows)
+        if (const FileSystemObject* fsObj = objectIds.get(row))
+        {
+            if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
+                addFolder(folder);
+            else
+                addFolder(dynamic_cast<const FolderPair*>(&fsObj->parent()));
+        }
 
-template <SortDirection sortDir, SelectSide side>
-struct LessFileName
-{
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
+    const auto sortSiblings = [&](std::vector<size_t>& siblings)
     {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessFileName<sortDir, side>(*fsObjL, *fsObjR);
-    }
-};
+        std::sort(siblings.begin(), siblings.end(), [&](size_t lhs, size_t rhs)
+        {
+            if (const int cmp = folders[lhs].nameKey.compare(folders[rhs].nameKey);
+                cmp != 0)
+                return isLessFor<sortDir>(std::less(), cmp, 0);
+
+            /*...with equivalent names:
+                1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
+                2. ensure stable sort order                                                            */
+            return std::less()(folders[lhs].folder, folders[rhs].folder);
+        });
+    };
 
+    std::unordered_map<const FolderPair*, size_t> folderRanks;
 
-template <SortDirection sortDir, SelectSide side>
-struct LessFilesize
-{
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
+    for (auto& [baseObj, folderIdxsTop] : topFolders)
     {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessFilesize<sortDir, side>(*fsObjL, *fsObjR);
-    }
-};
+        size_t rank = 0; //0: items directly below base folder
 
+        std::vector<size_t> pending; //pre-order traversal
+        sortSiblings(folderIdxsTop);
+        pending.assign(folderIdxsTop.rbegin(), folderIdxsTop.rend());
 
-template <SortDirection sortDir, SelectSide side>
-struct LessFiletime
-{
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
-    {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessFiletime<sortDir, side>(*fsObjL, *fsObjR);
+        while (!pending.empty())
+        {
+            FolderInfo& fi = folders[pending.back()];
+            pending.pop_back();
+
+            folderRanks.emplace(fi.folder, ++rank);
+
+            sortSiblings(fi.subfolders);
+            pending.insert(pending.end(), fi.subfolders.rbegin(), fi.subfolders.rend());
+        }
     }
-};
+    return folderRanks;
+}
 
 
 template <SortDirection sortDir, SelectSide side>
-struct LessExtension
+void sortRowsByPath(std::vector<ObjectId>& rows, const ObjectIdTable& objectIds, ItemPathFormat pathFmt,
+                    std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
 {
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
-    {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessExtension<sortDir, side>(*fsObjL, *fsObjR);
-    }
-};
+    if (pathFmt == ItemPathFormat::full) //calculate positions of base folders sorted by name
+        std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
+        {
+            const auto& [baseObjA, basePathLA, basePathRA] = a;
+            const auto& [baseObjB, basePathLB, basePathRB] = b;
 
+            const AbstractPath& basePathA = selectParam<side>(basePathLA, basePathRA);
+            const AbstractPath& basePathB = selectParam<side>(basePathLB, basePathRB);
 
-template <SortDirection sortDir>
-struct LessCmpResult
-{
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
+            return LessNaturalSort()/*even on Linux*/(utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
+                                                      utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
+        });
+    //else: take over positions of base folders as set up by user
+
+    std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> basePositions;
+    size_t pos = 0;
+    for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
+        basePositions.emplace(baseObj, pos++);
+
+    const std::unordered_map<const FolderPair*, size_t> folderRanks = getFolderRanks<sortDir, side>(rows, objectIds);
+
+    sortRows(rows, objectIds, [&](const FileSystemObject* fsObj) //concurrent read access only
     {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessCmpResult<sortDir>(*fsObjL, *fsObjR);
-    }
-};
+        if (!fsObj)
+            return PathSortKey{.invalidRow = true};
 
+        const auto itBase = basePositions.find(&fsObj->base());
+        assert(itBase != basePositions.end());
+        if (itBase == basePositions.end())
+            return PathSortKey{.invalidRow = true};
 
-template <SortDirection sortDir>
-struct LessSyncDirection
+        if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
+            return PathSortKey{.basePos = itBase->second, .groupRank = folderRanks.find(folder)->second, .isFolder = true};
+
+        const auto parentFolder = dynamic_cast<const FolderPair*>(&fsObj->parent());
+        return PathSortKey
+        {
+            .basePos   = itBase->second,
+            .groupRank = parentFolder ? folderRanks.find(parentFolder)->second : 0,
+            .itemName  = getNaturalSortKey(fsObj->getItemName<side>()) /*even on Linux*/,
+        };
+    },
+    LessPathSortKey<sortDir>());
+}
+
+
+template <SortDirection sortDir, SelectSide side>
+void sortRowsRim(std::vector<ObjectId>& rows, const ObjectIdTable& objectIds, ColumnTypeRim type, ItemPathFormat pathFmt,
+                 const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
 {
-    bool operator()(const std::weak_ptr<FileSystemObject>& lhs, const std::weak_ptr<FileSystemObject>& rhs) const
+    switch (type)
     {
-        const std::shared_ptr<FileSystemObject> fsObjL = lhs.lock();
-        const std::shared_ptr<FileSystemObject> fsObjR = rhs.lock();
-        if (!fsObjL) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjR)
-            return true;
-
-        return lessSyncDirection<sortDir>(*fsObjL, *fsObjR);
+        case ColumnTypeRim::path:
+            if (pathFmt == ItemPathFormat::name)
+                sortRows(rows, objectIds, getFileNameKey<side>, LessSortKey<sortDir>());
+            else
+                sortRowsByPath<sortDir, side>(rows, objectIds, pathFmt, folderPairs);
+            break;
+        case ColumnTypeRim::size:
+            sortRows(rows, objectIds, getFileSizeKey<side>, LessSortKey<sortDir>());
+            break;
+        case ColumnTypeRim::date:
+            sortRows(rows, objectIds, getFileTimeKey<side>, LessSortKey<sortDir>());
+            break;
+        case ColumnTypeRim::extension:
+            sortRows(rows, objectIds, getExtensionKey<side>, LessSortKey<sortDir>());
+            break;
     }
-};
+}
 }
 
 //-------------------------------------------------------------------------------------------------------
@@ -780,55 +1005,15 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
     currentSort_ = SortInfo({type, onLeft, ascending});
 
-    switch (type)
-    {
-        case ColumnTypeRim::path:
-            switch (pathFmt)
-            {
-                case ItemPathFormat::name:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<SortDirection::ascending,  SelectSide::left >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<SortDirection::ascending,  SelectSide::right>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<SortDirection::descending, SelectSide::left >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<SortDirection::descending, SelectSide::right>());
-                    break;
-
-                case ItemPathFormat::relative:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<SortDirection::ascending,  SelectSide::left >(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<SortDirection::ascending,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<SortDirection::descending, SelectSide::left >(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<SortDirection::descending, SelectSide::right>(folderPairs_));
-                    break;
-
-                case ItemPathFormat::full:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<SortDirection::ascending,  SelectSide::left >(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<SortDirection::ascending,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<SortDirection::descending, SelectSide::left >(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<SortDirection::descending, SelectSide::right>(folderPairs_));
-                    break;
-            }
-            break;
+    if      ( ascending &&  onLeft) sortRowsRim<SortDirection::ascending,  SelectSide::left >(sortedRef_, objectIds_.ref(), type, pathFmt, folderPairs_);
+    else if ( ascending && !onLeft) sortRowsRim<SortDirection::ascending,  SelectSide::right>(sortedRef_, objectIds_.ref(), type, pathFmt, folderPairs_);
+    else if (!ascending &&  onLeft) sortRowsRim<SortDirection::descending, SelectSide::left >(sortedRef_, objectIds_.ref(), type, pathFmt, folderPairs_);
+    else if (!ascending && !onLeft) sortRowsRim<SortDirection::descending, SelectSide::right>(sortedRef_, objectIds_.ref(), type, pathFmt, folderPairs_);
 
-        case ColumnTypeRim::size:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<SortDirection::ascending,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<SortDirection::ascending,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<SortDirection::descending, SelectSide::left >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<SortDirection::descending, SelectSide::right>());
-            break;
-        case ColumnTypeRim::date:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<SortDirection::ascending,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<SortDirection::ascending,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<SortDirection::descending, SelectSide::left >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<SortDirection::descending, SelectSide::right>());
-            break;
-        case ColumnTypeRim::extension:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<SortDirection::ascending,  SelectSide::left >());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<SortDirection::ascending,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<SortDirection::descending, SelectSide::left >());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<SortDirection::descending, SelectSide::right>());
-            break;
-    }
+    resetCategories(); //row bitmaps refer to sortedRef_ positions
 }
 
 
@@ -838,6 +1023,7 @@ void FileView::sortView(ColumnTypeCenter type, bool ascending)
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
     currentSort_ = SortInfo({type, false, ascending});
 
     switch (type)
@@ -846,12 +1032,14 @@ void FileView::sortView(ColumnTypeCenter type, bool ascending)
             assert(false);
             break;
         case ColumnTypeCenter::difference:
-            if      ( ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessCmpResult<SortDirection::ascending>());
-            else if (!ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessCmpResult<SortDirection::descending>());
+            if      ( ascending) sortRows(sortedRef_, objectIds_.ref(), getCmpResultKey, LessSortKey<SortDirection::ascending >());
+            else if (!ascending) sortRows(sortedRef_, objectIds_.ref(), getCmpResultKey, LessSortKey<SortDirection::descending>());
             break;
         case ColumnTypeCenter::action:
-            if      ( ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessSyncDirection<SortDirection::ascending>());
-            else if (!ascending) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessSyncDirection<SortDirection::descending>());
+            if      ( ascending) sortRows(sortedRef_, objectIds_.ref(), getSyncDirectionKey, LessSortKey<SortDirection::ascending >(), KeyAccess::sequential);
+            else if (!ascending) sortRows(sortedRef_, objectIds_.ref(), getSyncDirectionKey, LessSortKey<SortDirection::descending>(), KeyAccess::sequential);
             break;
     }
+
+    resetCategories(); //row bitmaps refer to sortedRef_ positions
 }
@@ -20,16 +20,18 @@ namespace fff
 class FileView //grid view of FolderComparison
 {
 public:
-    FileView() {}
+    FileView() { resetCategories(); }
     explicit FileView(FolderComparison& folderCmp); //takes weak (non-owning) references
 
     size_t rowsOnView() const { return viewRef_  .size(); } //only visible elements
     size_t rowsTotal () const { return sortedRef_.size(); } //total rows available
 
     //returns nullptr if object is not found; complexity: constant!
-    const FileSystemObject* getFsObject(size_t row) const { return row < viewRef_.size() ? viewRef_[row].objRef.lock().get() : nullptr; }
+    const FileSystemObject* getFsObject(size_t row) const { return row < viewRef_.size() ? objectIds_.ref().get(viewRef_[row].objId) : nullptr; }
     /**/  FileSystemObject* getFsObject(size_t row)       { return const_cast<FileSystemObject*>(static_cast<const FileView&>(*this).getFsObject(row)); } //see Meyers Effective C++
 
+    ObjectId getObjectId(size_t row) const { return row < viewRef_.size() ? viewRef_[row].objId : ObjectId(); } //stable row handle, e.g. for render buffers
+
     //references to FileSystemObject: no nullptr-check needed! everything is bound
     std::vector<FileSystemObject*> getAllFileRef(const std::vector<size_t>& rows);
 
@@ -104,6 +106,12 @@ public:
 
     void removeInvalidRows(); //remove references to rows that have been deleted meanwhile: call after manual deletion and synchronization!
 
+    //category index: call after changing sync directions, active status or categories; changing the view filter alone needs no update
+    void updateCategories(); //incremental: re-index rows with changed category only; assumes unchanged item sizes
+    void resetCategories();  //full rebuild: e.g. after swapping sides
+
+    uint64_t getContentUpdateId() const { return contentUpdateId_; } //help clients detect stale cell texts: changes with each (re-)categorization
+
     //sorting...
     void sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft, bool ascending); //always call these; never sort externally!
     void sortView(ColumnTypeCenter type, bool ascending);                                   //
@@ -127,12 +135,32 @@ private:
     FileView           (const FileView&) = delete;
     FileView& operator=(const FileView&) = delete;
 
-    template <class Predicate> void updateView(Predicate pred);
+    struct CategoryRows
+    {
+        std::vector<uint64_t> rowBits; //one bit per row of sortedRef_
+        int rowCount = 0;
+        FileStats fileStatsLeft;
+        FileStats fileStatsRight;
+    };
+    void updateView(const std::vector<const CategoryRows*>& shownCategories);
+    void updateRowPositions() const;
 
+    //rows of sortedRef_ indexed by (category, active): view filter => union of row bitmaps, view stats => sum over categories
+    struct RowCategories
+    {
+        unsigned char diffIdx   = 0xff; //index into diffCategories_;   0xff: not indexed (row deleted meanwhile)
+        unsigned char actionIdx = 0xff; //index into actionCategories_; 
+        bool operator==(const RowCategories&) const = default;
+    };
+    std::vector<RowCategories> rowCategories_; //same size as sortedRef_
+    std::vector<CategoryRows> diffCategories_;
+    std::vector<CategoryRows> actionCategories_;
 
-    std::unordered_map<const void* /*FileSystemObject*/, size_t> rowPositions_; //find row positions on viewRef_ directly
-    std::unordered_map<const void* /*ContainerObject*/,  size_t> rowPositionsFirstChild_; //find first child on sortedRef of a container object
+    //built lazily: only needed for findRowDirect()/findRowFirstChild()
+    mutable std::unordered_map<const void* /*FileSystemObject*/, size_t> rowPositions_; //find row positions on viewRef_ directly
+    mutable std::unordered_map<const void* /*ContainerObject*/,  size_t> rowPositionsFirstChild_; //find first child on sortedRef of a container object
     //void* instead of ContainerObject*: these pointers should *never be dereferenced*!
+    mutable bool rowPositionsValid_ = false;
 
     struct GroupDetail
     {
@@ -141,19 +169,22 @@ private:
     std::vector<GroupDetail> groupDetails_;
 
     uint64_t viewUpdateId_ = 0; //help clients detect invalid buffers after updateView()
+    uint64_t contentUpdateId_ = 0; //... after resetCategories()/updateCategories()
 
     struct ViewRow
     {
-        std::weak_ptr<FileSystemObject> objRef;
+        ObjectId objId;
         size_t groupIdx = 0; //...into groupDetails_
     };
     std::vector<ViewRow> viewRef_; //partial view on sortedRef_
     /*             /|\
                     | (applyFilterBy...)      */
-    std::vector<std::weak_ptr<FileSystemObject>> sortedRef_; //flat view of weak pointers on folderCmp; may be sorted
+    std::vector<ObjectId> sortedRef_; //flat view of weak references on folderCmp; may be sorted
     /*             /|\
                     | (constructor)
            FolderComparison folderCmp         */
+    zen::SharedRef<ObjectIdTable> objectIds_ = zen::makeSharedRef<ObjectIdTable>(); //resolve ObjectId of folderCmp: shared ownership => view may outlive folderCmp
+
     std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs_;
 
     std::optional<SortInfo> currentSort_;
@@ -53,8 +53,6 @@ private:
 
     MainDialog& mainDlg_;
     zen::ErrorLog errorLog_;
-    mutable Statistics::ErrorStats errorStatsBuf_{};
-    mutable size_t errorStatsRowsChecked_ = 0;
     const bool ignoreErrors_;
     const size_t autoRetryCount_;
     const std::chrono::seconds autoRetryDelay_;
@@ -120,8 +118,6 @@ private:
     const Zstring soundFileAlertPending_;
     SyncProgressDialog* progressDlg_; //managed to have the same lifetime as this handler!
     zen::SharedRef<zen::ErrorLog> errorLog_ = zen::makeSharedRef<zen::ErrorLog>();
-    mutable Statistics::ErrorStats errorStatsBuf_{};
-    mutable size_t errorStatsRowsChecked_ = 0;
     std::optional<TaskResult> syncResult_;
 };
 }
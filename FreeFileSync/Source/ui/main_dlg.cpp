@@ -48,6 +48,7 @@
 #include "../base/icon_loader.h"
 #include "../ffs_paths.h"
 #include "../localization.h"
+#include "../startup_trace.h"
 #include "../version/version.h"
 #include "../afs/gdrive.h"
 
@@ -527,6 +528,7 @@ void MainDialog::create(const GlobalConfig& globalCfg, const Zstring& globalCfgF
     if (!cfgFilePaths.empty())
         try
         {
+            StartupPhase phase("readAnyConfig");
             std::wstring warningMsg;
             std::tie(guiCfg, warningMsg) = readAnyConfig(cfgFilePaths); //throw FileError
 
@@ -548,7 +550,11 @@ void MainDialog::create(const FfsGuiConfig& guiCfg, const std::vector<Zstring>&
                         const GlobalConfig& globalCfg, const Zstring& globalCfgFilePath,
                         bool startComparison)
 {
-    MainDialog* mainDlg = new MainDialog(guiCfg, cfgFilePaths, globalCfg, globalCfgFilePath);
+    MainDialog* mainDlg = [&]
+    {
+        StartupPhase phase("MainDialog::MainDialog");
+        return new MainDialog(guiCfg, cfgFilePaths, globalCfg, globalCfgFilePath);
+    }();
 
     //avoid Windows 10 white flash when showing dark mode window: https://chromium-review.googlesource.com/c/chromium/src/+/6092335
 #if 0 //variant 1: works, but no fade-in animation
@@ -575,6 +581,9 @@ void MainDialog::create(const FfsGuiConfig& guiCfg, const std::vector<Zstring>&
 
     mainDlg->Show();
 
+    //time to first window: report after initial layout and paint events were processed
+    mainDlg->CallAfter([] { startupTraceFinish(); });
+
     //------------------------------------------------------------------------------------------
     //construction complete! trigger special events:
     //------------------------------------------------------------------------------------------
@@ -1246,23 +1255,26 @@ void MainDialog::setGlobalCfgOnInit(const GlobalConfig& globalCfg)
 
     //--------------------------------------------------------------------------------
     //load list of configuration files
-    cfggrid::getDataView(*m_gridCfgHistory).set(globalCfg.mainDlg.config.fileHistory);
+    {
+        StartupPhase phase("ConfigView::set");
+        cfggrid::getDataView(*m_gridCfgHistory).set(globalCfg.mainDlg.config.fileHistory);
 
-    //globalCfg.mainDlg.cfgGridTopRowPos => defer evaluation until later within MainDialog constructor
-    m_gridCfgHistory->setColumnConfig(convertColAttributes(layout.configColumnAttribs, getCfgGridDefaultColAttribs()));
-    cfggrid::getDataView(*m_gridCfgHistory).setSortDirection(globalCfg.mainDlg.config.lastSortColumn, globalCfg.mainDlg.config.lastSortAscending);
-    cfggrid::setSyncOverdueDays(*m_gridCfgHistory, globalCfg.mainDlg.config.syncOverdueDays);
-    //m_gridCfgHistory->Refresh(); <- implicit in last call
+        //globalCfg.mainDlg.cfgGridTopRowPos => defer evaluation until later within MainDialog constructor
+        m_gridCfgHistory->setColumnConfig(convertColAttributes(layout.configColumnAttribs, getCfgGridDefaultColAttribs()));
+        cfggrid::getDataView(*m_gridCfgHistory).setSortDirection(globalCfg.mainDlg.config.lastSortColumn, globalCfg.mainDlg.config.lastSortAscending);
+        cfggrid::setSyncOverdueDays(*m_gridCfgHistory, globalCfg.mainDlg.config.syncOverdueDays);
+        //m_gridCfgHistory->Refresh(); <- implicit in last call
 
-    //remove non-existent items: sufficient to call once at startup
-    std::vector<Zstring> cfgFilePaths;
-    for (const ConfigFileItem& item : globalCfg.mainDlg.config.fileHistory)
-        cfgFilePaths.push_back(item.cfgFilePath);
+        //remove non-existent items: sufficient to call once at startup
+        std::vector<Zstring> cfgFilePaths;
+        for (const ConfigFileItem& item : globalCfg.mainDlg.config.fileHistory)
+            cfgFilePaths.push_back(item.cfgFilePath);
 
-    cfgHistoryRemoveObsolete(cfgFilePaths);
+        cfgHistoryRemoveObsolete(cfgFilePaths);
 
-    //are we spawning too many async jobs, considering cfgHistoryRemoveObsolete()!?
-    cfgHistoryUpdateNotes(cfgFilePaths);
+        //are we spawning too many async jobs, considering cfgHistoryRemoveObsolete()!?
+        cfgHistoryUpdateNotes(cfgFilePaths);
+    }
     //--------------------------------------------------------------------------------
 
     //load list of last used folders
@@ -1328,6 +1340,8 @@ GlobalConfig MainDialog::getGlobalCfgBeforeExit()
 
     globalSettings.programLanguage = getLanguage();
 
+    globalSettings.blockSizeFactors = AFS::getBlockSizeFactors();
+
     //retrieve column attributes
     globalSettings.dpiLayouts[getDpiScalePercent()].fileColumnAttribsLeft  = convertColAttributes<ColAttributesRim>(m_gridMainL->getColumnConfig());
     globalSettings.dpiLayouts[getDpiScalePercent()].fileColumnAttribsRight = convertColAttributes<ColAttributesRim>(m_gridMainR->getColumnConfig());
@@ -4446,7 +4460,7 @@ void MainDialog::onToggleViewButton(wxCommandEvent& event)
     if (auto button = dynamic_cast<ToggleButton*>(event.GetEventObject()))
     {
         button->toggle();
-        updateGui();
+        updateGridViewData(); //view filter only: neither categories nor statistics have changed
 
         //consistency: toggling view buttons should *always* clear selections, not only implicitly when row count changes:
         //
@@ -4612,6 +4626,7 @@ void MainDialog::onCompare(wxCommandEvent& event)
                              globalCfg_.createLockFile,
                              dirLocks,
                              fpCfgList,
+                             nullptr /*changeJournal*/,
                              statusHandler); //throw CancelProcess
     }
     catch (CancelProcess&) {}
@@ -4670,6 +4685,8 @@ void MainDialog::onCompare(wxCommandEvent& event)
 
 void MainDialog::updateGui()
 {
+    filegrid::getDataView(*m_gridMainC).updateCategories(); //sync directions or active status may have changed
+
     updateGridViewData(); //update gridDataView and write status information
 
     const SyncStatistics st(folderCmp_);
@@ -5500,6 +5517,8 @@ void MainDialog::swapSides()
 
         const StatusHandlerTemporaryPanel::Result r = statusHandler.prepareResult(); //noexcept
         setLastOperationLog(r.summary, r.errorLog.ptr());
+
+        filegrid::getDataView(*m_gridMainC).resetCategories(); //left/right sizes swapped: incremental update not applicable
     }
 
     updateGui(); //e.g. unsaved changes
@@ -6,6 +6,7 @@
 
 #include "tree_grid.h"
 #include <wx/settings.h>
+#include <wx/timer.h>
 #include <zen/i18n.h>
 #include <zen/utf.h>
 #include <zen/stl_tools.h>
@@ -27,6 +28,11 @@ namespace
 const int PERCENTAGE_BAR_WIDTH_DIP = 60;
 const int TREE_GRID_GAP_SIZE_DIP   = 4;
 
+//render quickly even for huge comparisons: aggregate remaining folders progressively, see TreeView::refineView()
+constexpr std::chrono::milliseconds TREE_AGGREGATION_TIME_INITIAL(100);
+constexpr std::chrono::milliseconds TREE_REFINE_TIME_SLICE(30);
+const int TREE_REFINE_INTERVAL_MS = 50; //leave the UI responsive in between
+
 inline wxColor getColorPercentBorder    () { return {198, 198, 198}; }
 inline wxColor getColorPercentBackground() { return {0xf8, 0xf8, 0xf8}; }
 
@@ -52,80 +58,113 @@ TreeView::TreeView(FolderComparison& folderCmp, const SortInfo& si) : currentSor
 }
 
 
-inline
-void TreeView::compressNode(Container& cont) //remove single-element sub-trees -> gain clarity + usability (call *after* inclusion check!!!)
+//remove single-element sub-trees -> gain clarity + usability
+bool TreeView::showFilesNode(const Container& cont)
 {
-    if (cont.subDirs.empty()) //single files node
-        cont.showFilesNode = false;
-
-#if 0 //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
-    if (!cont.showFilesNode &&      //single dir node...
-        cont.subDirs.size() == 1 && //
-        !cont.subDirs[0].showFilesNode && //...that is empty
-        cont.subDirs[0].subDirs.empty())  //
-        cont.subDirs.clear();
-#endif
+    //single files node => don't show
+    return cont.itemCountNet > 0 && std::any_of(cont.subDirs.begin(), cont.subDirs.end(), [](const Container& subDir) { return subDir.itemCountGross > 0; });
+    //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
 }
 
 
-template <class Function> //(const FileSystemObject&) -> bool
-void TreeView::extractVisibleSubtree(ContainerObject& conObj, //in
-                                     TreeView::Container& cont, //out
-                                     Function pred)
+void TreeView::aggregateFolder(Container& cont) //aggregate a single level, then propagate to all parents
 {
-    auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
+    assert(!cont.aggregated);
+    cont.aggregated = true;
+
+    int itemCountIncluded = 0;
+    int foldersPendingDelta = -1; //"cont" itself
+
+    if (ContainerObject* conObj = cont.containerRef.lock().get())
     {
-#if 0 //give accumulated bytes the semantics of a sync preview?
-        switch (getEffectiveSyncDir(file.getSyncOperation()))
+        auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
         {
-            case SyncDirection::none: break;
-            case SyncDirection::left:  return file.getFileSize<SelectSide::right>();
-            case SyncDirection::right: return file.getFileSize<SelectSide::left>();
-        }
+#if 0 //give accumulated bytes the semantics of a sync preview?
+            switch (getEffectiveSyncDir(file.getSyncOperation()))
+            {
+                case SyncDirection::none: break;
+                case SyncDirection::left:  return file.getFileSize<SelectSide::right>();
+                case SyncDirection::right: return file.getFileSize<SelectSide::left>();
+            }
 #endif
-        //prefer file-browser semantics over sync preview (=> always show useful numbers, even for SyncDirection::none)
-        //discussion: https://freefilesync.org/forum/viewtopic.php?t=1595
-        return std::max(file.isEmpty<SelectSide::left >() ? 0 : file.getFileSize<SelectSide::left>(),
-                        file.isEmpty<SelectSide::right>() ? 0 : file.getFileSize<SelectSide::right>());
-    };
+            //prefer file-browser semantics over sync preview (=> always show useful numbers, even for SyncDirection::none)
+            //discussion: https://freefilesync.org/forum/viewtopic.php?t=1595
+            return std::max(file.isEmpty<SelectSide::left >() ? 0 : file.getFileSize<SelectSide::left>(),
+                            file.isEmpty<SelectSide::right>() ? 0 : file.getFileSize<SelectSide::right>());
+        };
 
-    for (FilePair& file : conObj.files())
-        if (pred(file))
+        for (FilePair& file : conObj->files())
+            if (lastViewFilterPred_(file))
+            {
+                cont.bytesNet += getBytes(file);
+                ++cont.itemCountNet;
+            }
+
+        for (SymlinkPair& symlink : conObj->symlinks())
+            if (lastViewFilterPred_(symlink))
+                ++cont.itemCountNet;
+
+        itemCountIncluded = cont.itemCountNet;
+
+        cont.subDirs.reserve(conObj->subfolders().size()); //avoid expensive reallocations! + keep "parent" pointers valid
+
+        for (FolderPair& folder : conObj->subfolders())
         {
-            cont.bytesNet += getBytes(file);
-            ++cont.itemCountNet;
+            Container& subDirCont = cont.subDirs.emplace_back();
+            subDirCont.parent = &cont;
+            subDirCont.containerRef = std::static_pointer_cast<FolderPair>(folder.shared_from_this());
+
+            if (lastViewFilterPred_(folder))
+            {
+                subDirCont.itemCountGross = 1;
+                ++itemCountIncluded;
+            }
+            ++foldersPendingDelta;
+            pendingFolders_.push_back(&subDirCont);
         }
+    }
 
-    for (SymlinkPair& symlink : conObj.symlinks())
-        if (pred(symlink))
-            ++cont.itemCountNet;
+    //bottom-up: parents' gross values = sum over all aggregated sub folders
+    for (Container* c = &cont; c; c = c->parent)
+    {
+        c->bytesGross     += cont.bytesNet;
+        c->itemCountGross += itemCountIncluded;
+        c->foldersPending += foldersPendingDelta;
+    }
+}
 
-    cont.showFilesNode = cont.itemCountNet > 0;
 
-    cont.bytesGross     += cont.bytesNet;
-    cont.itemCountGross += cont.itemCountNet;
+void TreeView::aggregateSubtree(Container& cont) //complete all numbers below "cont" *now*
+{
+    std::vector<Container*> stack{&cont};
+    while (!stack.empty())
+    {
+        Container& c = *stack.back();
+        stack.pop_back();
 
-    cont.subDirs.reserve(conObj.subfolders().size()); //avoid expensive reallocations!
+        if (!c.aggregated)
+            aggregateFolder(c);
 
-    for (FolderPair& folder : conObj.subfolders())
-    {
-        const bool included = pred(folder);
+        for (Container& subDir : c.subDirs)
+            if (subDir.foldersPending > 0)
+                stack.push_back(&subDir);
+    }
+}
 
-        cont.subDirs.emplace_back(); //
-        auto& subDirCont = cont.subDirs.back();
-        TreeView::extractVisibleSubtree(folder, subDirCont, pred);
-        if (included)
-            ++subDirCont.itemCountGross;
 
-        cont.bytesGross     += subDirCont.bytesGross;
-        cont.itemCountGross += subDirCont.itemCountGross;
+void TreeView::aggregatePending(std::chrono::steady_clock::time_point stopTime)
+{
+    while (!pendingFolders_.empty())
+    {
+        Container& cont = *pendingFolders_.front();
+        pendingFolders_.pop_front();
 
-        if (!included && subDirCont.subDirs.empty() && !subDirCont.showFilesNode)
-            cont.subDirs.pop_back();
-        else
+        if (!cont.aggregated) //might have been aggregated early by expandNode()
         {
-            subDirCont.containerRef = std::static_pointer_cast<FolderPair>(folder.shared_from_this());
-            compressNode(subDirCont);
+            aggregateFolder(cont);
+
+            if (std::chrono::steady_clock::now() >= stopTime)
+                break;
         }
     }
 }
@@ -270,19 +309,20 @@ void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview
 }
 
 
-void TreeView::getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output)
+void TreeView::getChildren(Container& cont, unsigned int level, std::vector<TreeLine>& output)
 {
     output.clear();
     output.reserve(cont.subDirs.size() + 1); //keep pointers in "workList" valid
     std::vector<std::pair<uint64_t, int*>> workList;
 
-    for (const Container& subDir : cont.subDirs)
-    {
-        output.push_back({level, 0, &subDir, NodeType::folder});
-        workList.emplace_back(subDir.bytesGross, &output.back().percent);
-    }
+    for (Container& subDir : cont.subDirs)
+        if (subDir.itemCountGross > 0) //else: not (yet) known to contain anything on view
+        {
+            output.push_back({level, 0, &subDir, NodeType::folder});
+            workList.emplace_back(subDir.bytesGross, &output.back().percent);
+        }
 
-    if (cont.showFilesNode)
+    if (showFilesNode(cont))
     {
         output.push_back({level, 0, &cont, NodeType::files});
         workList.emplace_back(cont.bytesNet, &output.back().percent);
@@ -331,7 +371,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 
     if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!) do NOT use folderCmpView for this check!
     {
-        if (!folderCmpView_.empty()) //possibly empty!
+        if (!folderCmpView_.empty())
             getChildren(folderCmpView_[0], 0, flatTree_); //do not show root
     }
     else
@@ -342,11 +382,12 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
         flatTree_.reserve(folderCmpView_.size()); //keep pointers in "workList" valid
         std::vector<std::pair<uint64_t, int*>> workList;
 
-        for (const RootNodeImpl& root : folderCmpView_)
-        {
-            flatTree_.push_back({0, 0, &root, NodeType::root});
-            workList.emplace_back(root.bytesGross, &flatTree_.back().percent);
-        }
+        for (RootNodeImpl& root : folderCmpView_)
+            if (root.itemCountGross > 0)
+            {
+                flatTree_.push_back({0, 0, &root, NodeType::root});
+                workList.emplace_back(root.bytesGross, &flatTree_.back().percent);
+            }
 
         calcPercentage(workList);
 
@@ -373,38 +414,56 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 }
 
 
-template <class Predicate>
-void TreeView::updateView(Predicate pred)
+void TreeView::updateView(const std::function<bool(const FileSystemObject& fsObj)>& pred)
 {
+    lastViewFilterPred_ = pred;
+    pendingFolders_.clear(); //bound to old view!
+
     //update view on full data
     std::vector<RootNodeImpl> newView;
-    newView.reserve(folderCmp_.size()); //avoid expensive reallocations!
+    newView.reserve(folderCmp_.size()); //avoid expensive reallocations! + keep "pendingFolders_" pointers valid
 
     for (const std::weak_ptr<BaseFolderPair>& baseObjRef : folderCmp_)
         if (BaseFolderPair* baseObj = baseObjRef.lock().get())
         {
-            newView.emplace_back();
-            RootNodeImpl& root = newView.back();
-            this->extractVisibleSubtree(*baseObj, root, pred); //"this->" is bogus for a static method, but GCC screws this one up
-
-            //warning: the following lines are almost 1:1 copy from extractVisibleSubtree, adapted for BaseFolderPair:
-            if (root.subDirs.empty() && !root.showFilesNode)
-                newView.pop_back();
-            else
-            {
-                root.containerRef = baseObjRef;
-                root.displayName = getShortDisplayNameForFolderPair(baseObj->getAbstractPath<SelectSide::left >(),
-                                                                    baseObj->getAbstractPath<SelectSide::right>());
-
-                this->compressNode(root); //"this->" required by two-pass lookup as enforced by GCC 4.7
-            }
+            RootNodeImpl& root = newView.emplace_back();
+            root.containerRef = baseObjRef;
+            root.displayName = getShortDisplayNameForFolderPair(baseObj->getAbstractPath<SelectSide::left >(),
+                                                                baseObj->getAbstractPath<SelectSide::right>());
+            pendingFolders_.push_back(&root);
         }
 
-    lastViewFilterPred_ = pred;
+    aggregatePending(std::chrono::steady_clock::now() + TREE_AGGREGATION_TIME_INITIAL);
+
     applySubView(std::move(newView));
 }
 
 
+std::vector<std::optional<size_t>> TreeView::refineView(std::chrono::milliseconds timeMax, const std::vector<size_t>& rowsToTrack)
+{
+    //Container nodes are never reallocated: identify rows by (node, type) across the view update
+    std::map<std::pair<const Container*, NodeType>, std::vector<size_t> /*rowsToTrack index*/> linesToTrack;
+    for (size_t i = 0; i < rowsToTrack.size(); ++i)
+        if (const size_t row = rowsToTrack[i];
+            row < flatTree_.size())
+            linesToTrack[{flatTree_[row].node, flatTree_[row].type}].push_back(i);
+
+    aggregatePending(std::chrono::steady_clock::now() + timeMax);
+
+    //re-sort, update percentages and show folders that turned out to be non-empty
+    applySubView(std::move(folderCmpView_));
+
+    std::vector<std::optional<size_t>> rowsNew(rowsToTrack.size());
+    if (!linesToTrack.empty())
+        for (size_t row = 0; row < flatTree_.size(); ++row)
+            if (auto it = linesToTrack.find({flatTree_[row].node, flatTree_[row].type});
+                it != linesToTrack.end())
+                for (const size_t i : it->second)
+                    rowsNew[i] = row;
+    return rowsNew;
+}
+
+
 void TreeView::setSortDirection(ColumnTypeOverview colType, bool ascending) //apply permanently!
 {
     currentSort_ = SortInfo{colType, ascending};
@@ -426,7 +485,14 @@ TreeView::NodeStatus TreeView::getStatus(size_t row) const
         {
             case NodeType::root:
             case NodeType::folder:
-                return flatTree_[row].node->showFilesNode || !flatTree_[row].node->subDirs.empty() ? NodeStatus::reduced : NodeStatus::empty;
+            {
+                const Container& cont = *flatTree_[row].node;
+                if (cont.foldersPending > 0) //not yet known => assume children: aggregated on demand by expandNode()
+                    return NodeStatus::reduced;
+
+                return showFilesNode(cont) || std::any_of(cont.subDirs.begin(), cont.subDirs.end(), [](const Container& subDir) { return subDir.itemCountGross > 0; }) ?
+                       NodeStatus::reduced : NodeStatus::empty;
+            }
 
             case NodeType::files:
                 return NodeStatus::empty;
@@ -452,6 +518,7 @@ void TreeView::expandNode(size_t row)
         {
             case NodeType::root:
             case NodeType::folder:
+                aggregateSubtree(*flatTree_[row].node); //user wants to see *final* numbers of the children
                 getChildren(*flatTree_[row].node, flatTree_[row].level + 1, newLines);
                 break;
             case NodeType::files:
@@ -698,6 +765,8 @@ public:
         grid.Bind(EVENT_GRID_MOUSE_LEFT_DOUBLE,     [this](GridClickEvent& event) { onMouseLeftDouble(event); });
         grid.Bind(EVENT_GRID_COL_LABEL_MOUSE_RIGHT, [this](GridLabelClickEvent& event) { onGridLabelContext  (event); });
         grid.Bind(EVENT_GRID_COL_LABEL_MOUSE_LEFT,  [this](GridLabelClickEvent& event) { onGridLabelLeftClick(event); });
+
+        refineTimer_.Bind(wxEVT_TIMER, [this](wxTimerEvent& event) { onRefineTimer(event); });
     }
 
     void setData(FolderComparison& folderCmp)
@@ -768,6 +837,8 @@ private:
 
     void renderColumnLabel(wxDC& dc, const wxRect& rect, ColumnType colType, bool enabled, bool highlighted) override
     {
+        startRefinement(); //column labels are rendered even if there are no rows (yet)
+
         const auto colTypeTree = static_cast<ColumnTypeOverview>(colType);
 
         const wxRect rectInner = drawColumnLabelBackground(dc, rect, highlighted);
@@ -1142,6 +1213,46 @@ private:
         grid_.clearSelection(GridEventPolicy::allow);
     }
 
+    //hierarchy is not thread-safe (e.g. FolderPair::getSyncOperation() buffer) => aggregate on main thread in time slices instead
+    //only while the grid is being drawn: don't waste time if overview panel is hidden
+    void startRefinement()
+    {
+        if (getDataView().refinementPending() && !refineTimer_.IsRunning())
+            refineTimer_.Start(TREE_REFINE_INTERVAL_MS);
+    }
+
+    void onRefineTimer(wxTimerEvent& event)
+    {
+        //rows move on each refinement => keep selection, cursor and scroll position bound to their nodes
+        std::vector<size_t> rowsToTrack = grid_.getSelectedRows();
+        const size_t selectionCount = rowsToTrack.size();
+        rowsToTrack.push_back(grid_.getGridCursor());
+        rowsToTrack.push_back(std::max<ptrdiff_t>(grid_.getVisibleRows(grid_.getMainWin().GetClientRect()).first, 0));
+
+        //clear *before* row count changes: Grid::Refresh() would otherwise clear the selection and notify the main dialog
+        if (selectionCount > 0)
+            grid_.clearSelection(GridEventPolicy::deny);
+
+        const std::vector<std::optional<size_t>> rowsNew = getDataView().refineView(TREE_REFINE_TIME_SLICE, rowsToTrack);
+        grid_.Refresh();
+
+        if (selectionCount > 0) //same nodes selected => no selection event
+        {
+            if (const std::optional<size_t> cursorRow = rowsNew[selectionCount])
+                grid_.setGridCursor(*cursorRow, GridEventPolicy::deny);
+
+            for (size_t i = 0; i < selectionCount; ++i)
+                if (rowsNew[i])
+                    grid_.selectRow(*rowsNew[i], GridEventPolicy::deny);
+        }
+
+        if (const std::optional<size_t> topRow = rowsNew[selectionCount + 1])
+            grid_.scrollTo(*topRow);
+
+        if (!getDataView().refinementPending())
+            refineTimer_.Stop();
+    }
+
     void expandNode(size_t row)
     {
         getDataView().expandNode(row);
@@ -1175,6 +1286,7 @@ private:
 
     Grid& grid_;
     bool showPercentBar_ = true;
+    wxTimer refineTimer_;
 };
 }
 
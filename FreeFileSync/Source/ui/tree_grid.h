@@ -7,6 +7,8 @@
 #ifndef TREE_VIEW_H_841703190201835280256673425
 #define TREE_VIEW_H_841703190201835280256673425
 
+#include <deque>
+#include <chrono>
 #include <functional>
 #include <wx+/grid.h>
 #include "tree_grid_attr.h"
@@ -105,19 +107,27 @@ public:
     void setSortDirection(ColumnTypeOverview colType, bool ascending); //apply permanently!
     SortInfo getSortConfig() { return currentSort_; }
 
+    //aggregation is incremental: folder sizes and item counts are filled in level by level, in time slices
+    bool refinementPending() const { return !pendingFolders_.empty(); }
+    //update aggregates for at most "timeMax", then rebuild view (preserving expanded nodes)
+    //=> rows are re-sorted and inserted: returns new positions of "rowsToTrack" (nullopt if not found)
+    std::vector<std::optional<size_t>> refineView(std::chrono::milliseconds timeMax, const std::vector<size_t>& rowsToTrack);
+
 private:
     TreeView           (const TreeView&) = delete;
     TreeView& operator=(const TreeView&) = delete;
 
     struct Container
     {
-        uint64_t bytesGross = 0;
+        uint64_t bytesGross = 0; //gross values grow monotonically while sub folders are being aggregated
         uint64_t bytesNet   = 0; //bytes for files on view in this directory only
         int itemCountGross  = 0;
         int itemCountNet    = 0; //number of files on view in this directory only
+        int foldersPending  = 1; //number of folders in this sub-tree (including this one) not yet aggregated
+        bool aggregated = false; //bytesNet, itemCountNet and subDirs are final
 
-        std::vector<Container> subDirs;
-        bool showFilesNode = false; //"compress" algorithm may hide file nodes for directories with a single included file, i.e. itemCountGross == itemCountNet == 1
+        std::vector<Container> subDirs; //all sub folders, visible if itemCountGross > 0; never reallocated: "parent" pointers are bound!
+        Container* parent = nullptr;
         std::weak_ptr<ContainerObject> containerRef; //-> BaseFolderPair if NodeType::root,
         //FolderPair if NodeType::folder, and parent ContainerObject if NodeType::files
     };
@@ -138,15 +148,16 @@ private:
     {
         unsigned int level = 0;
         int percent = 0; //[0, 100]
-        const Container* node = nullptr; //
+        Container* node = nullptr;       //
         NodeType type = NodeType::root;  //increase size of "flatTree" using C-style types rather than have a polymorphic "folderCmpView"
     };
 
-    static void compressNode(Container& cont);
-    template <class Function>
-    static void extractVisibleSubtree(ContainerObject& conObj, Container& cont, Function includeObject);
-    void getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output);
-    template <class Predicate> void updateView(Predicate pred);
+    static bool showFilesNode(const Container& cont);
+    void aggregateFolder(Container& cont);
+    void aggregateSubtree(Container& cont);
+    void aggregatePending(std::chrono::steady_clock::time_point stopTime);
+    void getChildren(Container& cont, unsigned int level, std::vector<TreeLine>& output);
+    void updateView(const std::function<bool(const FileSystemObject& fsObj)>& pred);
     void applySubView(std::vector<RootNodeImpl>&& newView);
 
     template <zen::SortDirection sortDir> static void sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview columnType);
@@ -157,6 +168,7 @@ private:
                     | (update...)             */
     std::vector<RootNodeImpl> folderCmpView_; //partial view on folderCmp -> unsorted (cannot be, because files are not a separate entity)
     std::function<bool(const FileSystemObject& fsObj)> lastViewFilterPred_; //buffer view filter predicate for lazy evaluation of files/symlinks corresponding to a TYPE_FILES node
+    std::deque<Container*> pendingFolders_; //breadth-first: aggregate top levels first; may contain already aggregated folders (see expandNode())
     /*             /|\
                     | (update...)             */
     std::vector<std::weak_ptr<BaseFolderPair>> folderCmp_; //full raw data
@@ -11,28 +11,209 @@
 
     #include <map>
     #include <sys/inotify.h>
-    #include <fcntl.h> //fcntl
-    #include <unistd.h> //close
-    #include <limits.h> //NAME_MAX
+    #include <sys/fanotify.h>
+    #include <fcntl.h> //fcntl, open_by_handle_at
+    #include <unistd.h> //close, readlink
+    #include <limits.h> //NAME_MAX, PATH_MAX
     #include "file_traverser.h"
 
 
 using namespace zen;
 
 
+namespace
+{
+//"parentPath" is "itemPath" or one of its parent folders?
+bool isSameOrParentPath(const Zstring& parentPath, const Zstring& itemPath)
+{
+    return itemPath == parentPath || startsWith(itemPath, appendSeparator(parentPath));
+}
+}
+
+
 struct DirWatcher::Impl
 {
     int notifDescr = 0;
-    std::unordered_map<int, Zstring> watchedPaths; //watch descriptor and (sub-)directory paths -> owned by "notifDescr"
+    std::unordered_map<int, Zstring> watchedPaths; //inotify: watch descriptor and (sub-)directory paths -> owned by "notifDescr"
+
+    void addWatches   (const Zstring& dirPath); //throw FileError: inotify: watch folder including subfolders
+    void removeWatches(const Zstring& dirPath); //noexcept
+
+    /* fanotify: one mark for the whole file system instead of one inotify watch per folder => constant setup time and memory
+       requires Linux 5.9, CAP_SYS_ADMIN (fanotify_init) and CAP_DAC_READ_SEARCH (open_by_handle_at)
+       caveat: unlike inotify, doesn't cross into file systems mounted below the base folder
+       cost: the kernel can't filter by subtree => every write on the file system wakes up the caller's poll(),
+             fetchChanges() then drops unrelated events via (buffered) parent folder lookup and returns empty    */
+    bool useFanotify = false;
+    int mountDescr = -1; //file system reference for open_by_handle_at()
+    Zstring resolvedBaseDirPath; //as reported by /proc/self/fd: may differ from base folder path, e.g. symlink or bind mount in path
+    std::unordered_map<std::string, Zstring> dirPathByHandle; //buffer resolution of parent folder handles (including folders outside base folder!)
+    static constexpr size_t DIR_PATH_BUFFER_MAX = 10'000; //=> bounded memory despite file-system-wide events
+
+    bool initFanotify(const Zstring& baseDirPath); //noexcept
+    std::optional<Zstring> getDirPath(const file_handle& fh); //noexcept; none if folder is gone
+    std::vector<Change> fetchChangesFanotify(const Zstring& baseDirPath); //throw FileError
 };
 
 
-DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
-    baseDirPath_(dirPath),
-    pimpl_(std::make_unique<Impl>())
+bool DirWatcher::Impl::initFanotify(const Zstring& baseDirPath) //noexcept
+{
+    //EPERM: missing CAP_SYS_ADMIN, EINVAL: FAN_REPORT_DFID_NAME not supported (Linux < 5.9)
+    const int fanDescr = ::fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE);
+    if (fanDescr == -1)
+        return false;
+    bool success = false;
+    ZEN_ON_SCOPE_EXIT(if (!success) ::close(fanDescr));
+
+    //e.g. ENODEV/EXDEV: file system without fsid (FUSE, some network shares)
+    if (::fanotify_mark(fanDescr, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                        FAN_CREATE      |
+                        FAN_MODIFY      |
+                        FAN_CLOSE_WRITE |
+                        FAN_DELETE      |
+                        FAN_MOVED_FROM  |
+                        FAN_MOVED_TO    |
+                        FAN_ONDIR, AT_FDCWD, baseDirPath.c_str()) != 0)
+        return false;
+
+    const int dirDescr = ::open(baseDirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirDescr == -1)
+        return false;
+    ZEN_ON_SCOPE_EXIT
+    (
+        if (!success)
+        {
+            ::close(dirDescr);
+            mountDescr = -1; //don't close twice in ~DirWatcher(): fd number might already be reused by inotify fallback!
+            dirPathByHandle.clear();
+        }
+    )
+
+    mountDescr = dirDescr;
+
+    //test-resolve base folder: fails with EPERM without CAP_DAC_READ_SEARCH
+    alignas(file_handle) std::byte handleBuf[sizeof(file_handle) + MAX_HANDLE_SZ] = {};
+    file_handle& fh = reinterpret_cast<file_handle&>(handleBuf);
+    fh.handle_bytes = MAX_HANDLE_SZ;
+
+    int mountId = 0;
+    if (::name_to_handle_at(AT_FDCWD, baseDirPath.c_str(), &fh, &mountId, 0) != 0)
+        return false;
+
+    const std::optional<Zstring> resolvedPath = getDirPath(fh);
+    if (!resolvedPath)
+        return false;
+
+    resolvedBaseDirPath = *resolvedPath; //events report resolved paths => map back to base folder path
+    notifDescr = fanDescr;
+    useFanotify = success = true;
+    return true;
+}
+
+
+std::optional<Zstring> DirWatcher::Impl::getDirPath(const file_handle& fh) //noexcept
+{
+    const std::string handleKey(reinterpret_cast<const char*>(&fh), sizeof(file_handle) + fh.handle_bytes);
+
+    if (auto it = dirPathByHandle.find(handleKey);
+        it != dirPathByHandle.end())
+        return it->second;
+
+    const int fd = ::open_by_handle_at(mountDescr, const_cast<file_handle*>(&fh), O_PATH | O_CLOEXEC);
+    if (fd == -1) //ESTALE: folder was deleted in the meantime => parent folder reports deletion
+        return std::nullopt;
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    char buf[PATH_MAX] = {};
+    const ssize_t bytesWritten = ::readlink(("/proc/self/fd/" + numberTo<std::string>(fd)).c_str(), buf, sizeof(buf));
+    if (bytesWritten <= 0 || bytesWritten >= static_cast<ssize_t>(sizeof(buf)))
+        return std::nullopt;
+
+    const Zstring dirPath(buf, bytesWritten);
+    if (endsWith(dirPath, Zstr(" (deleted)")))
+        return std::nullopt;
+
+    if (dirPathByHandle.size() >= DIR_PATH_BUFFER_MAX)
+        dirPathByHandle.clear(); //simple and good enough: re-resolving is cheap compared to unbounded growth
+
+    dirPathByHandle.emplace(handleKey, dirPath);
+    return dirPath;
+}
+
+
+std::vector<DirWatcher::Change> DirWatcher::Impl::fetchChangesFanotify(const Zstring& baseDirPath) //throw FileError
+{
+    std::vector<std::byte> buf(256 * 1024);
+    std::vector<Change> output;
+
+    for (;;) //fanotify reports the whole file system => drain queue to keep up
+    {
+        ssize_t bytesRead = 0;
+        do
+        {
+            //non-blocking call, see FAN_NONBLOCK
+            bytesRead = ::read(notifDescr, buf.data(), buf.size());
+        }
+        while (bytesRead < 0 && errno == EINTR); //"Interrupted function call; When this happens, you should try the call again."
+
+        if (bytesRead < 0)
+        {
+            if (errno == EAGAIN)
+                return output;
+
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)), "read");
+        }
+
+        for (auto md = reinterpret_cast<const fanotify_event_metadata*>(buf.data()); FAN_EVENT_OK(md, bytesRead); md = FAN_EVENT_NEXT(md, bytesRead))
+        {
+            if (md->vers != FANOTIFY_METADATA_VERSION)
+                throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)),
+                                formatSystemError("fanotify", L"", L"Unexpected metadata version: " + numberTo<std::wstring>(md->vers)));
+
+            if (md->mask & FAN_Q_OVERFLOW) //events were lost => report base folder as changed
+            {
+                output.push_back({ChangeType::update, baseDirPath});
+                continue;
+            }
+
+            const auto& fid = *reinterpret_cast<const fanotify_event_info_fid*>(md + 1);
+            if (md->event_len < sizeof(*md) + sizeof(fid) ||
+                fid.hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+                continue;
+
+            const file_handle& fh = *reinterpret_cast<const file_handle*>(fid.handle);
+            const char* itemName = reinterpret_cast<const char*>(fh.f_handle + fh.handle_bytes);
+
+            if (std::string_view(itemName) == ".") //exclude case: event on "self", already reported by parent directory (consistent with inotify)
+                continue;
+
+            if ((md->mask & FAN_ONDIR) && (md->mask & (FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO)))
+                dirPathByHandle.clear(); //buffered paths of sub folders are now outdated
+
+            if (const std::optional<Zstring> dirPath = getDirPath(fh))
+                if (isSameOrParentPath(resolvedBaseDirPath, *dirPath)) //filter changes of the rest of the file system
+                {
+                    const size_t basePathPfLen = appendSeparator(resolvedBaseDirPath).size();
+                    const Zstring relDirPath = dirPath->size() > basePathPfLen ? Zstring(dirPath->begin() + basePathPfLen, dirPath->end()) : Zstring();
+
+                    const Zstring itemPath = appendPath(appendPath(baseDirPath, relDirPath), itemName);
+
+                    if (md->mask & (FAN_CREATE | FAN_MOVED_TO))
+                        output.push_back({ChangeType::create, itemPath});
+                    else if (md->mask & (FAN_MODIFY | FAN_CLOSE_WRITE))
+                        output.push_back({ChangeType::update, itemPath});
+                    else if (md->mask & (FAN_DELETE | FAN_MOVED_FROM))
+                        output.push_back({ChangeType::remove, itemPath});
+                }
+        }
+    }
+}
+
+
+void DirWatcher::Impl::addWatches(const Zstring& dirPath) //throw FileError
 {
     //get all subdirectories
-    std::vector<Zstring> fullFolderList {baseDirPath_};
+    std::vector<Zstring> fullFolderList {dirPath};
     {
         auto traverse = [&fullFolderList](this const auto& self, const Zstring& path) -> void //throw FileError
         {
@@ -45,28 +226,12 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
             nullptr /*don't traverse into symlinks (analog to Windows)*/); //throw FileError
         };
 
-        traverse(baseDirPath_); //throw FileError
+        traverse(dirPath); //throw FileError
     }
 
-    //init
-    pimpl_->notifDescr  = ::inotify_init();
-    if (pimpl_->notifDescr == -1)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "inotify_init");
-
-    ZEN_ON_SCOPE_FAIL( ::close(pimpl_->notifDescr); );
-
-    //set non-blocking mode
-    const int flags = ::fcntl(pimpl_->notifDescr, F_GETFL);
-    if (flags == -1)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "fcntl(F_GETFL)");
-
-    if (::fcntl(pimpl_->notifDescr, F_SETFL, flags | O_NONBLOCK) != 0)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "fcntl(F_SETFL, O_NONBLOCK)");
-
-    //add watches
     for (const Zstring& subDirPath : fullFolderList)
     {
-        int wd = ::inotify_add_watch(pimpl_->notifDescr, subDirPath.c_str(),
+        int wd = ::inotify_add_watch(notifDescr, subDirPath.c_str(),
                                      IN_ONLYDIR     | //"Only watch pathname if it is a directory."
                                      IN_DONT_FOLLOW | //don't follow symbolic links
                                      IN_CREATE      |
@@ -88,19 +253,72 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
             throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(subDirPath)), formatSystemError("inotify_add_watch", ec));
         }
 
-        pimpl_->watchedPaths.emplace(wd, subDirPath);
+        watchedPaths.insert_or_assign(wd, subDirPath); //same wd if already watched (e.g. moved folder)
     }
 }
 
 
+void DirWatcher::Impl::removeWatches(const Zstring& dirPath) //noexcept
+{
+    std::erase_if(watchedPaths, [&](const auto& item)
+    {
+        const auto& [wd, subDirPath] = item;
+        if (!isSameOrParentPath(dirPath, subDirPath))
+            return false;
+
+        ::inotify_rm_watch(notifDescr, wd); //IN_IGNORED is reported afterwards
+        return true;
+    });
+}
+
+
+DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
+    baseDirPath_(dirPath),
+    pimpl_(std::make_unique<Impl>())
+{
+    if (pimpl_->initFanotify(baseDirPath_)) //fall back to inotify if not supported or not permitted
+        return;
+
+    //init
+    pimpl_->notifDescr  = ::inotify_init();
+    if (pimpl_->notifDescr == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "inotify_init");
+
+    ZEN_ON_SCOPE_FAIL( ::close(pimpl_->notifDescr); );
+
+    //set non-blocking mode
+    const int flags = ::fcntl(pimpl_->notifDescr, F_GETFL);
+    if (flags == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "fcntl(F_GETFL)");
+
+    if (::fcntl(pimpl_->notifDescr, F_SETFL, flags | O_NONBLOCK) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "fcntl(F_SETFL, O_NONBLOCK)");
+
+    //add watches
+    pimpl_->addWatches(baseDirPath_); //throw FileError
+}
+
+
 DirWatcher::~DirWatcher()
 {
     ::close(pimpl_->notifDescr); //associated watches are removed automatically!
+
+    if (pimpl_->mountDescr != -1)
+        ::close(pimpl_->mountDescr);
+}
+
+
+int DirWatcher::getNotifyDescriptor() const
+{
+    return pimpl_->notifDescr; //non-blocking for both inotify and fanotify
 }
 
 
 std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval) //throw FileError
 {
+    if (pimpl_->useFanotify)
+        return pimpl_->fetchChangesFanotify(baseDirPath_); //throw FileError
+
     std::vector<std::byte> buf(512 * (sizeof(inotify_event) + NAME_MAX + 1));
 
     ssize_t bytesRead = 0;
@@ -126,6 +344,12 @@ std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<voi
     {
         inotify_event& evt = reinterpret_cast<inotify_event&>(buf[bytePos]);
 
+        if (evt.mask & IN_Q_OVERFLOW) //events were lost => report base folder as changed
+            output.push_back({ChangeType::update, baseDirPath_});
+
+        if (evt.mask & IN_IGNORED) //watch was removed: folder deleted, unmounted, or inotify_rm_watch()
+            pimpl_->watchedPaths.erase(evt.wd);
+
         if (evt.len != 0) //exclude case: deletion of "self", already reported by parent directory watch
         {
             auto it = pimpl_->watchedPaths.find(evt.wd);
@@ -137,7 +361,24 @@ std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<voi
 
                 if ((evt.mask & IN_CREATE) ||
                     (evt.mask & IN_MOVED_TO))
+                {
                     output.push_back({ChangeType::create, itemPath});
+
+                    if (evt.mask & IN_ISDIR) //watch new subfolders incrementally: no need to reset DirWatcher
+                        try
+                        {
+                            pimpl_->addWatches(itemPath); //throw FileError
+                        }
+                        catch (FileError&)
+                        {
+                            bool folderGone = false;
+                            try { getItemType(itemPath); } //throw FileError
+                            catch (FileError&) { folderGone = true; } //deletion is reported by parent folder
+
+                            if (!folderGone)
+                                throw;
+                        }
+                }
                 else if ((evt.mask & IN_MODIFY) ||
                          (evt.mask & IN_CLOSE_WRITE))
                     output.push_back({ChangeType::update, itemPath});
@@ -145,7 +386,12 @@ std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<voi
                          (evt.mask & IN_DELETE_SELF) ||
                          (evt.mask & IN_MOVE_SELF  ) ||
                          (evt.mask & IN_MOVED_FROM))
+                {
                     output.push_back({ChangeType::remove, itemPath});
+
+                    if ((evt.mask & IN_ISDIR) && (evt.mask & IN_MOVED_FROM)) //folder paths of watches are outdated (or not part of the hierarchy anymore)
+                        pimpl_->removeWatches(itemPath);
+                }
             }
         }
         bytePos += sizeof(inotify_event) + evt.len;
@@ -16,7 +16,8 @@
 namespace zen
 {
 //Windows: ReadDirectoryChangesW https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-readdirectorychangesw
-//Linux:   inotify               https://linux.die.net/man/7/inotify
+//Linux:   fanotify              https://man7.org/linux/man-pages/man7/fanotify.7.html (if permitted, see dir_watcher.cpp)
+//         inotify               https://linux.die.net/man/7/inotify
 //macOS:   kqueue                https://developer.apple.com/library/mac/documentation/Darwin/Reference/ManPages/man2/kqueue.2.html
 
 //watch directory including subdirectories
@@ -28,12 +29,14 @@ namespace zen
              Renaming of top watched directory handled incorrectly: Not notified(!) + additional changes in subfolders
              now do report FILE_ACTION_MODIFIED for directory (check that should prevent this fails!)
 
-    Linux: newly added subdirectories are reported but not automatically added for watching! -> reset Dirwatcher!
+    Linux: inotify: newly added subdirectories are not watched automatically: DirWatcher adds them incrementally
+                    (changes inside the new folder before its watch was installed are missed => treat the folder as changed)
            removal of base directory is NOT notified!
+           fanotify: file-system-wide mark => notify descriptor also signals for unrelated changes; fetchChanges() then returns empty
 
     macOS: everything works as expected; renaming of base directory is also detected
 
-    Overcome all issues portably: check existence of top watched directory externally + reinstall watch after changes in directory structure (added directories) are detected
+    Overcome all issues portably: check existence of top watched directory externally
 */
 class DirWatcher
 {
@@ -58,6 +61,9 @@ public:
     //extract accumulated changes since last call
     std::vector<Change> fetchChanges(const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval); //throw FileError
 
+    //Linux: readable via poll()/epoll() while changes are pending => wait for changes without polling
+    int getNotifyDescriptor() const;
+
 private:
     DirWatcher           (const DirWatcher&) = delete;
     DirWatcher& operator=(const DirWatcher&) = delete;
@@ -0,0 +1,267 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "error_log.h"
+#include "file_access.h"
+#include "serialize.h"
+
+    #include <unistd.h>
+    #include <fcntl.h>
+
+using namespace zen;
+
+
+namespace
+{
+const size_t ENTRIES_UNSPILLED_MAX = 100'000; //spill older half when exceeded; should be large enough so that "normal" runs never touch the disk
+}
+
+
+struct ErrorLog::SpillFile
+{
+    SpillFile() //throw FileError
+    {
+        Zstring tempPath = appendPath(getTempFolderPath(), Zstr("FFS-Log-XXXXXX")); //throw FileError
+
+        fd = ::mkostemp(tempPath.begin(), O_CLOEXEC);
+        if (fd == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(tempPath)), "mkostemp");
+
+        //anonymous file: no clean up needed, not even after a crash
+        if (::unlink(tempPath.c_str()) != 0)
+        {
+            const ErrorCode ec = getLastError(); //copy before making other system calls!
+            ::close(fd);
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(tempPath)), formatSystemError("unlink", ec));
+        }
+    }
+
+    ~SpillFile() { ::close(fd); }
+
+    void write(const std::string& buf) //throw SysError
+    {
+        for (size_t bytesWritten = 0; bytesWritten < buf.size();)
+        {
+            const ssize_t bytesDelta = ::write(fd, buf.data() + bytesWritten, buf.size() - bytesWritten);
+            if (bytesDelta < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                THROW_LAST_SYS_ERROR("write");
+            }
+            bytesWritten += bytesDelta;
+        }
+        sizeWritten += buf.size();
+    }
+
+    std::string read(uint64_t offset, uint64_t size) const //throw SysError
+    {
+        std::string buf(size, '\0');
+        for (size_t bytesRead = 0; bytesRead < buf.size();) //pread(): no shared file position => thread-safe
+        {
+            const ssize_t bytesDelta = ::pread(fd, buf.data() + bytesRead, buf.size() - bytesRead, offset + bytesRead);
+            if (bytesDelta < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                THROW_LAST_SYS_ERROR("pread");
+            }
+            if (bytesDelta == 0)
+                throw SysErrorUnexpectedEos();
+            bytesRead += bytesDelta;
+        }
+        return buf;
+    }
+
+    int fd = -1;
+    uint64_t sizeWritten = 0;
+
+private:
+    SpillFile           (const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+};
+
+
+ErrorLog::ErrorLog(const ErrorLog& other) :
+    entries_        (other.entries_),
+    spilledInMemory_(other.spilledInMemory_),
+    spillBlocks_    (other.spillBlocks_),
+    stats_          (other.stats_) {} //spillFileOut_: don't share!
+
+
+void ErrorLog::swap(ErrorLog& other) noexcept
+{
+    entries_        .swap(other.entries_);
+    std::swap(spilledInMemory_, other.spilledInMemory_);
+    spillBlocks_    .swap(other.spillBlocks_);
+    spillFileOut_   .swap(other.spillFileOut_);
+    std::swap(spillFailed_, other.spillFailed_);
+    std::swap(stats_,       other.stats_);
+}
+
+
+void ErrorLog::push_back(LogEntry&& entry)
+{
+    assert(!entry.spilled);
+    switch (entry.type)
+    {
+        case MSG_TYPE_INFO:
+            ++stats_.infos;
+            break;
+        case MSG_TYPE_WARNING:
+            ++stats_.warnings;
+            break;
+        case MSG_TYPE_ERROR:
+            ++stats_.errors;
+            break;
+    }
+    entries_.push_back(std::move(entry));
+
+    if (const size_t unspilledCount = entries_.size() - spilledInMemory_;
+        unspilledCount > ENTRIES_UNSPILLED_MAX && !spillFailed_)
+        spillUnspilled(unspilledCount / 2); //keep most recent half in memory
+}
+
+
+void ErrorLog::append(const ErrorLog& other)
+{
+    if (other.spillBlocks_.empty())
+    {
+        assert(other.spilledInMemory_ == 0);
+        entries_.reserve(entries_.size() + other.entries_.size());
+        for (const LogEntry& entry : other.entries_)
+            push_back(LogEntry(entry));
+        return;
+    }
+
+    //keep order: our unspilled entries must be written before other's spill blocks
+    if (spillUnspilled(entries_.size() - spilledInMemory_))
+    {
+        spillBlocks_.insert(spillBlocks_.end(), other.spillBlocks_.begin(), other.spillBlocks_.end());
+        entries_    .insert(entries_    .end(), other.entries_    .begin(), other.entries_    .end()); //including spilled warnings/errors
+        spilledInMemory_ += other.spilledInMemory_;
+
+        stats_.infos    += other.stats_.infos;
+        stats_.warnings += other.stats_.warnings;
+        stats_.errors   += other.stats_.errors;
+    }
+    else //no spill file available: load everything into memory
+        try
+        {
+            other.visitEntries([&](const LogEntry& entry) { push_back({.time = entry.time, .type = entry.type, .message = entry.message}); }); //throw SysError
+        }
+        catch (const SysError& e) { push_back({.time = std::time(nullptr), .type = MSG_TYPE_ERROR, .message = utfTo<Zstringc>(e.toString())}); }
+}
+
+
+bool ErrorLog::spillUnspilled(size_t count) //nothrow!
+{
+    if (count == 0)
+        return true;
+    try
+    {
+        if (!spillFileOut_)
+        {
+            if (spillFailed_)
+                return false;
+            spillFileOut_ = std::make_shared<SpillFile>(); //throw FileError
+        }
+
+        MemoryStreamOut streamOut;
+        size_t spillCount = 0;
+        for (const LogEntry& entry : entries_)
+            if (!entry.spilled)
+            {
+                if (spillCount++ == count)
+                    break;
+                writeNumber<int64_t>(streamOut, entry.time);
+                writeNumber<int32_t>(streamOut, entry.type);
+                writeContainer      (streamOut, entry.message);
+            }
+
+        const uint64_t blockOffset = spillFileOut_->sizeWritten;
+        spillFileOut_->write(streamOut.ref()); //throw SysError
+
+        if (!spillBlocks_.empty() &&
+            spillBlocks_.back().file == spillFileOut_ &&
+            spillBlocks_.back().offset + spillBlocks_.back().size == blockOffset)
+            spillBlocks_.back().size += streamOut.ref().size();
+        else
+            spillBlocks_.push_back({spillFileOut_, blockOffset, streamOut.ref().size()});
+    }
+    catch (const FileError&) { spillFailed_ = true; return false; } //=> keep entries in memory, no need to bother user
+    catch (const SysError& ) { spillFailed_ = true; return false; } //(shouldn't logExtraError(): might be extra log!)
+
+    //infos are only needed in spill file; warnings/errors are kept in memory, too
+    size_t spillCount = 0;
+    for (LogEntry& entry : entries_)
+        if (!entry.spilled)
+        {
+            if (spillCount++ == count)
+                break;
+            entry.spilled = true;
+            if (entry.type != MSG_TYPE_INFO)
+                ++spilledInMemory_;
+        }
+    std::erase_if(entries_, [](const LogEntry& entry) { return entry.spilled && entry.type == MSG_TYPE_INFO; });
+    return true;
+}
+
+
+void ErrorLog::visitEntries(const std::function<void(const LogEntry& entry)>& onEntry /*throw X*/) const //throw SysError, X
+{
+    const size_t BLOCK_SIZE_READ = 1024 * 1024; //bounded memory: spill blocks can get large
+
+    for (const SpillBlock& block : spillBlocks_)
+    {
+        std::string buf;
+        size_t bufPos = 0;
+
+        auto readMore = [&, blockPos = block.offset](size_t bytesMin) mutable //throw SysError
+        {
+            buf.erase(0, bufPos);
+            bufPos = 0;
+
+            const uint64_t bytesToRead = std::min<uint64_t>(std::max(bytesMin, BLOCK_SIZE_READ), block.offset + block.size - blockPos);
+            buf += block.file->read(blockPos, bytesToRead); //throw SysError
+            blockPos += bytesToRead;
+        };
+
+        for (uint64_t blockBytesLeft = block.size; blockBytesLeft > 0;)
+        {
+            //entry size: int64 + int32 + int32 + message
+            const size_t headerSize = sizeof(int64_t) + sizeof(int32_t) + sizeof(int32_t);
+            if (buf.size() - bufPos < headerSize)
+                readMore(headerSize); //throw SysError
+
+            MemoryStreamIn headerIn(std::string_view(buf).substr(bufPos));
+            /**/                 readNumber<int64_t >(headerIn); //
+            /**/                 readNumber<int32_t >(headerIn); //throw SysErrorUnexpectedEos
+            const int32_t msgLen = readNumber<int32_t>(headerIn); //
+            if (msgLen < 0)
+                throw SysErrorUnexpectedEos();
+
+            if (buf.size() - bufPos < headerSize + static_cast<size_t>(msgLen))
+                readMore(headerSize + msgLen); //throw SysError
+
+            MemoryStreamIn streamIn(std::string_view(buf).substr(bufPos));
+            LogEntry entry;
+            entry.time    =                          readNumber<int64_t>(streamIn);       //
+            entry.type    = static_cast<MessageType>(readNumber<int32_t>(streamIn));      //throw SysErrorUnexpectedEos
+            entry.message =                          readContainer<Zstringc>(streamIn);   //
+            entry.spilled = true;
+
+            bufPos         += streamIn.pos();
+            blockBytesLeft -= streamIn.pos();
+
+            onEntry(entry); //throw X
+        }
+    }
+
+    for (const LogEntry& entry : entries_)
+        if (!entry.spilled)
+            onEntry(entry); //throw X
+}
@@ -9,6 +9,8 @@
 
 #include <cassert>
 #include <vector>
+#include <memory>
+#include <functional>
 #include "time.h"
 #include "i18n.h"
 #include "zstring.h"
@@ -27,23 +29,80 @@ struct LogEntry
 {
     time_t      time = 0;
     MessageType type = MSG_TYPE_ERROR;
+    bool spilled = false; //entry is already part of ErrorLog's spill file (fits into padding bytes)
     Zstringc message; //conserve memory (=> avoid std::string SSO overhead!)
 };
 
 std::string formatMessage(const LogEntry& entry);
 
-using ErrorLog = std::vector<LogEntry>;
-
-void logMsg(ErrorLog& log, const std::wstring& msg, MessageType type, time_t time = std::time(nullptr));
-
 struct ErrorLogStats
 {
     int infos    = 0;
     int warnings = 0;
     int errors   = 0;
 };
+
+
+/* append-only log with bounded memory consumption: think 2 million "file copied" infos
+   - begin()/end() iterate over in-memory entries: all warnings and errors + the most recent infos (=> sufficient for display)
+   - older entries are moved to an anonymous spill file in blocks
+   - visitEntries() streams all entries in order, getStats() counts all entries
+   - copies share the (immutable) spill file blocks                                        */
+class ErrorLog
+{
+public:
+    using iterator       = std::vector<LogEntry>::iterator;
+    using const_iterator = std::vector<LogEntry>::const_iterator;
+
+    ErrorLog() {}
+    ErrorLog           (const ErrorLog& other);
+    ErrorLog& operator=(const ErrorLog& other) { return *this = ErrorLog(other); }
+    ErrorLog           (ErrorLog&& tmp) noexcept { swap(tmp); }
+    ErrorLog& operator=(ErrorLog&& tmp) noexcept { swap(tmp); return *this; }
+
+    void push_back(LogEntry&& entry);
+    void append(const ErrorLog& other);
+
+    iterator       begin()       { return entries_.begin(); }
+    iterator       end  ()       { return entries_.end  (); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end  () const { return entries_.end  (); }
+
+    size_t size() const { return entries_.size(); } //in-memory entries only!
+    bool  empty() const { return entries_.empty(); }
+
+    const ErrorLogStats& getStats() const { return stats_; }
+
+    void visitEntries(const std::function<void(const LogEntry& entry)>& onEntry /*throw X*/) const; //throw SysError, X
+
+private:
+    struct SpillFile;
+    struct SpillBlock
+    {
+        std::shared_ptr<const SpillFile> file;
+        uint64_t offset = 0;
+        uint64_t size   = 0;
+    };
+
+    void swap(ErrorLog& other) noexcept;
+    bool spillUnspilled(size_t count); //nothrow! false if spill file is not available
+
+    std::vector<LogEntry> entries_;
+    size_t spilledInMemory_ = 0; //number of entries_ with "spilled == true"
+
+    std::vector<SpillBlock> spillBlocks_;
+    std::shared_ptr<SpillFile> spillFileOut_; //not shared with copies: every log appends to its own file
+    bool spillFailed_ = false;
+
+    ErrorLogStats stats_;
+};
+
+void logMsg(ErrorLog& log, const std::wstring& msg, MessageType type, time_t time = std::time(nullptr));
+
 ErrorLogStats getStats(const ErrorLog& log);
 
+void append(ErrorLog& log, const ErrorLog& other);
+
 
 
 
@@ -54,30 +113,16 @@ ErrorLogStats getStats(const ErrorLog& log);
 inline
 void logMsg(ErrorLog& log, const std::wstring& msg, MessageType type, time_t time)
 {
-    log.push_back({time, type, utfTo<Zstringc>(msg)});
+    log.push_back({.time = time, .type = type, .message = utfTo<Zstringc>(msg)});
 }
 
 
 inline
-ErrorLogStats getStats(const ErrorLog& log)
-{
-    ErrorLogStats count;
-    for (const LogEntry& entry : log)
-        switch (entry.type)
-        {
-            case MSG_TYPE_INFO:
-                ++count.infos;
-                break;
-            case MSG_TYPE_WARNING:
-                ++count.warnings;
-                break;
-            case MSG_TYPE_ERROR:
-                ++count.errors;
-                break;
-        }
-    assert(std::ssize(log) == count.infos + count.warnings + count.errors);
-    return count;
-}
+ErrorLogStats getStats(const ErrorLog& log) { return log.getStats(); }
+
+
+inline
+void append(ErrorLog& log, const ErrorLog& other) { log.append(other); }
 
 
 inline
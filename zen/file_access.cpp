@@ -7,13 +7,16 @@
 #include "file_access.h"
 #include <algorithm>
 #include <variant>
+#include <map>
 #include "file_traverser.h"
 #include "scope_guard.h"
 #include "symlink_target.h"
 #include "file_io.h"
 #include "crc.h"
+#include "xxhash.h"
 #include "guid.h"
 #include "ring_buffer.h"
+#include "thread.h"
 
     #include <sys/vfs.h> //statfs
     #ifdef HAVE_SELINUX
@@ -23,6 +26,7 @@
 
     #include <fcntl.h> //open, close, AT_SYMLINK_NOFOLLOW, UTIME_OMIT
     #include <sys/stat.h>
+    #include <sys/sysmacros.h> //major, minor
 
 using namespace zen;
 
@@ -669,7 +673,190 @@ void zen::copySymlink(const Zstring& sourcePath, const Zstring& targetPath) //th
 }
 
 
+namespace
+{
+/* single-threaded read/write leaves most of the bandwidth of RAID/NVMe unused: copy large files as chunks by multiple threads
+   => only for SSDs: parallel access on rotational disks just adds seek time    */
+constexpr uint64_t PARALLEL_COPY_SIZE_MIN = 256 * 1024 * 1024;
+constexpr size_t PARALLEL_COPY_CHUNK_SIZE = 8 * 1024 * 1024;
+constexpr size_t PARALLEL_COPY_THREADS_MAX = 4;
+
+
+bool isSolidStateDevice(dev_t deviceId)
+{
+    //network shares, tmpfs, FUSE: no block device => unknown
+    if (::major(deviceId) == 0)
+        return false;
+
+    const Zstring devPath = Zstr("/sys/dev/block/") + numberTo<Zstring>(::major(deviceId)) + Zstr(':') + numberTo<Zstring>(::minor(deviceId));
+
+    for (const Zstring& queuePath : {devPath + Zstr("/queue/rotational"), //whole disk
+                                     devPath + Zstr("/../queue/rotational")}) //partition
+        try
+        {
+            return trimCpy(getFileContent(queuePath, nullptr /*notifyUnbufferedIO*/)) == "0"; //throw FileError
+        }
+        catch (FileError&) {}
+
+    return false;
+}
+
+
+//returns XXH64 of the file content: chunks are hashed in order on the calling thread while the next ones are still copied
+uint64_t copyFileChunksParallel(FileInputPlain& fileIn, FileOutputPlain& fileOut, uint64_t fileSize, size_t threadCount, //throw FileError, X
+                                const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    //sparse preallocation: avoid growing the file size concurrently from multiple threads
+    if (::ftruncate(fileOut.getHandle(), fileSize) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(fileOut.getFilePath())), "ftruncate");
+
+    const uint64_t chunkCount = (fileSize + PARALLEL_COPY_CHUNK_SIZE - 1) / PARALLEL_COPY_CHUNK_SIZE;
+
+    //allocate on calling thread: std::bad_alloc can't leave worker threads
+    //twice the number of threads: chunks completing out of order wait for hashing without stalling the workers
+    std::vector<std::unique_ptr<std::byte[]>> buffers;
+    for (size_t i = 0; i < 2 * threadCount; ++i)
+        buffers.emplace_back(new std::byte[PARALLEL_COPY_CHUNK_SIZE]);
+
+    struct
+    {
+        std::mutex lock;
+        std::condition_variable conditionUpdate;
+        std::vector<std::byte*> freeBuffers;
+        uint64_t nextChunk = 0;
+        std::map<uint64_t, std::pair<std::byte*, size_t>> chunksCopied; //chunk index => buffer, chunk size; not yet hashed
+        size_t threadsDone = 0;
+        std::optional<FileError> error;
+    } status;
+
+    for (const std::unique_ptr<std::byte[]>& buf : buffers)
+        status.freeBuffers.push_back(buf.get());
+
+    auto copyChunk = [&](std::byte* buf, uint64_t offset, size_t chunkSize) //throw FileError
+    {
+        for (size_t pos = 0; pos < chunkSize;)
+        {
+            const ssize_t bytesRead = ::pread(fileIn.getHandle(), buf + pos, chunkSize - pos, offset + pos);
+            if (bytesRead < 0 && errno == EINTR)
+                continue;
+            if (bytesRead < 0)
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())), "pread");
+            if (bytesRead == 0) //file was truncated meanwhile
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())),
+                                _("Unexpected size of data stream:") + L' ' + formatNumber(offset + pos) + L'\n' +
+                                _("Expected:") + L' ' + formatNumber(fileSize));
+            pos += bytesRead;
+        }
+
+        for (size_t pos = 0; pos < chunkSize;)
+        {
+            const ssize_t bytesWritten = ::pwrite(fileOut.getHandle(), buf + pos, chunkSize - pos, offset + pos);
+            if (bytesWritten < 0 && errno == EINTR)
+                continue;
+            if (bytesWritten <= 0)
+            {
+                if (bytesWritten == 0) //comment in safe-read.c suggests to treat this as an error due to buggy drivers
+                    errno = ENOSPC;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(fileOut.getFilePath())), "pwrite");
+            }
+            pos += bytesWritten;
+        }
+    };
+
+    std::vector<InterruptibleThread> worker;
+    ZEN_ON_SCOPE_EXIT(for (InterruptibleThread& wt : worker) wt.requestStop()); //stop *all* at the same time before join!
+
+    for (size_t i = 0; i < threadCount; ++i)
+        worker.emplace_back([&, threadIdx = i]
+    {
+        setCurrentThreadName(Zstr("Copy Chunks[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(threadCount) + Zstr("] ") + fileIn.getFilePath());
+
+        ZEN_ON_SCOPE_EXIT(
+        {
+            std::lock_guard dummy(status.lock);
+            ++status.threadsDone;
+        }
+        status.conditionUpdate.notify_all());
+
+        try
+        {
+            for (;;)
+            {
+                std::byte* buf = nullptr;
+                uint64_t chunkIdx = 0;
+                {
+                    std::unique_lock dummy(status.lock);
+                    //get buffer *before* chunk index: chunks waiting to be hashed must not hold up the one they're waiting for!
+                    interruptibleWait(status.conditionUpdate, dummy, [&] { return !status.freeBuffers.empty(); }); //throw ThreadStopRequest
+
+                    if (status.nextChunk >= chunkCount)
+                        return;
+
+                    buf = status.freeBuffers.back();
+                    status.freeBuffers.pop_back();
+                    chunkIdx = status.nextChunk++;
+                }
+
+                const uint64_t offset = chunkIdx * PARALLEL_COPY_CHUNK_SIZE;
+                const size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(PARALLEL_COPY_CHUNK_SIZE, fileSize - offset));
+
+                copyChunk(buf, offset, chunkSize); //throw FileError
+                {
+                    std::lock_guard dummy(status.lock);
+                    status.chunksCopied.emplace(chunkIdx, std::pair(buf, chunkSize));
+                }
+                status.conditionUpdate.notify_all();
+            }
+        }
+        catch (const FileError& e)
+        {
+            std::lock_guard dummy(status.lock);
+            status.nextChunk = chunkCount; //let the other threads finish early
+            if (!status.error)
+                status.error = e;
+        }
+    });
+
+    //hash and report progress on calling thread: IoCallback is not thread-safe, and may throw
+    XXHash64 contentHash;
+    for (uint64_t chunkIdxHash = 0;;)
+    {
+        std::unique_lock dummy(status.lock);
+        status.conditionUpdate.wait(dummy, [&] { return status.chunksCopied.contains(chunkIdxHash) || status.error || status.threadsDone == threadCount; });
+
+        if (status.error)
+            throw *status.error;
+
+        const auto it = status.chunksCopied.find(chunkIdxHash);
+        if (it == status.chunksCopied.end())
+        {
+            assert(chunkIdxHash == chunkCount);
+            return contentHash.get();
+        }
+        const auto [buf, chunkSize] = it->second;
+        status.chunksCopied.erase(it);
+        dummy.unlock();
+
+        contentHash.add(buf, chunkSize); //buffer is owned by calling thread until returned to freeBuffers
+        ++chunkIdxHash;
+        {
+            std::lock_guard dummy2(status.lock);
+            status.freeBuffers.push_back(buf);
+        }
+        status.conditionUpdate.notify_all();
+
+        if (notifyUnbufferedIO)
+        {
+            notifyUnbufferedIO(chunkSize); //read  throw X
+            notifyUnbufferedIO(chunkSize); //write
+        }
+    }
+}
+}
+
+
 FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
+                                size_t blockSizeFactorIn, size_t blockSizeFactorOut,
                                 const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
     int64_t totalBytesNotified = 0;
@@ -710,21 +897,51 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     //preallocate disk space + reduce fragmentation
     fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
 
-    unbufferedStreamCopy([&](void* buffer, size_t bytesToRead)
-    {
-        const size_t bytesRead = fileIn.tryRead(buffer, bytesToRead); //throw FileError, (ErrorFileLocked)
-        notifyIoDiv(bytesRead); //throw X
-        return bytesRead;
-    },
-    fileIn.getBlockSize() /*throw FileError*/,
+    uint64_t contentHash = 0;
+    bool copiedInChunks = false;
+    std::chrono::nanoseconds readTime {};
+    std::chrono::nanoseconds writeTime{};
 
-          [&](const void* buffer, size_t bytesToWrite)
+    if (const size_t threadCount = std::min<size_t>(PARALLEL_COPY_THREADS_MAX, std::thread::hardware_concurrency());
+        makeUnsigned(sourceInfo.st_size) >= PARALLEL_COPY_SIZE_MIN && threadCount > 1 &&
+        isSolidStateDevice(sourceInfo.st_dev) &&
+        isSolidStateDevice(fileOut.getStatBuffered().st_dev)) //throw FileError
+    {
+        contentHash = copyFileChunksParallel(fileIn, fileOut, sourceInfo.st_size, threadCount, [&](int64_t bytesDelta) { notifyIoDiv(bytesDelta); }); //throw FileError, X
+        copiedInChunks = true;
+    }
+    else
     {
-        const size_t bytesWritten = fileOut.tryWrite(buffer, bytesToWrite); //throw FileError
-        notifyIoDiv(bytesWritten); //throw X
-        return bytesWritten;
-    },
-    fileOut.getBlockSize() /*throw FileError*/); //throw FileError, X
+        XXHash64 streamHash; //data is in the CPU cache anyway => hashing is (almost) free
+
+        unbufferedStreamCopy([&](void* buffer, size_t bytesToRead)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            const size_t bytesRead = fileIn.tryRead(buffer, bytesToRead); //throw FileError, (ErrorFileLocked)
+            readTime += std::chrono::steady_clock::now() - startTime;
+
+            streamHash.add(buffer, bytesRead);
+            notifyIoDiv(bytesRead); //throw X
+            return bytesRead;
+        },
+        fileIn.getBlockSize() /*throw FileError*/ * blockSizeFactorIn,
+
+              [&](const void* buffer, size_t bytesToWrite)
+        {
+            if (bytesToWrite > fileOut.getBlockSize()) //after short write: remaining data at end of stream may not be a block size multiple
+                bytesToWrite -= bytesToWrite % fileOut.getBlockSize(); //throw FileError
+
+            const auto startTime = std::chrono::steady_clock::now();
+            const size_t bytesWritten = fileOut.tryWrite(buffer, bytesToWrite); //throw FileError
+            writeTime += std::chrono::steady_clock::now() - startTime;
+
+            notifyIoDiv(bytesWritten); //throw X
+            return bytesWritten;
+        },
+        fileOut.getBlockSize() /*throw FileError*/ * blockSizeFactorOut); //throw FileError, X
+
+        contentHash = streamHash.get();
+    }
 
     //possible improvement: copy_file_range() performs an in-kernel copy: https://github.com/coreutils/coreutils/blob/17479ef60c8edbd2fe8664e31a7f69704f0cd221/src/copy.c#L342
 
@@ -770,11 +987,15 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
 
     return
     {
-        .fileSize      = makeUnsigned(sourceInfo.st_size),
-        .sourceModTime = sourceInfo.st_mtim,
-        .sourceFileIdx = sourceInfo.st_ino,
-        .targetFileIdx = targetFileIdx,
-        .errorModTime  = errorModTime,
+        .fileSize       = makeUnsigned(sourceInfo.st_size),
+        .sourceModTime  = sourceInfo.st_mtim,
+        .sourceFileIdx  = sourceInfo.st_ino,
+        .targetFileIdx  = targetFileIdx,
+        .contentHash    = contentHash,
+        .copiedInChunks = copiedInChunks,
+        .readTime       = readTime,
+        .writeTime      = writeTime,
+        .errorModTime   = errorModTime,
     };
 }
 
@@ -10,6 +10,7 @@
 #include "file_path.h" //we'll need this later anyway!
 #include "file_error.h"
 #include "serialize.h" //IoCallback
+#include <chrono>
     #include <sys/stat.h>
 
 namespace zen
@@ -88,10 +89,15 @@ struct FileCopyResult
     FileTimeNative sourceModTime = {};
     FileIndex sourceFileIdx = 0;
     FileIndex targetFileIdx = 0;
+    uint64_t contentHash = 0; //XXH64 of the copied data
+    bool copiedInChunks = false; //parallel chunk copy: "blockSizeFactorIn/Out" not used
+    std::chrono::nanoseconds readTime {}; //time spent in read/write calls:
+    std::chrono::nanoseconds writeTime{}; //not measured for parallel chunk copy
     std::optional<FileError> errorModTime; //failure to set modification time
 };
 
 FileCopyResult copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                           size_t blockSizeFactorIn, size_t blockSizeFactorOut, //I/O buffer: multiple of file system block size
                            //accummulated delta != file size! consider ADS, sparse, compressed files
                            const IoCallback& notifyUnbufferedIO /*throw X*/);
 }
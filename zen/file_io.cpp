@@ -343,3 +343,38 @@ void zen::setFileContent(const Zstring& filePath, const std::string_view byteStr
     //operation finished: move temp file transactionally
     moveAndRenameItem(tmpFilePath, filePath, true /*replaceExisting*/); //throw FileError, (ErrorMoveUnsupported), (ErrorTargetExisting)
 }
+
+
+void zen::appendFileContent(const Zstring& filePath, const std::string_view byteStream) //throw FileError
+{
+    try
+    {
+        const mode_t lockFileMode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH; //0666 => umask will be applied implicitly!
+
+        const int fdFile = ::open(filePath.c_str(), //const char* pathname
+                                  O_CREAT | O_WRONLY | O_APPEND | O_CLOEXEC, //int flags
+                                  lockFileMode);    //mode_t mode
+        if (fdFile == -1)
+            THROW_LAST_SYS_ERROR("open");
+        ZEN_ON_SCOPE_EXIT(::close(fdFile)); //errors are reported by fsync() below
+
+        for (size_t bytesWritten = 0; bytesWritten < byteStream.size();)
+        {
+            const ssize_t rv = ::write(fdFile, byteStream.data() + bytesWritten, byteStream.size() - bytesWritten);
+            if (rv <= 0)
+            {
+                if (rv < 0 && errno == EINTR)
+                    continue;
+                if (rv == 0) //see FileOutputPlain::tryWrite()
+                    errno = ENOSPC;
+
+                THROW_LAST_SYS_ERROR("write");
+            }
+            bytesWritten += rv;
+        }
+
+        if (::fsync(fdFile) != 0)
+            THROW_LAST_SYS_ERROR("fsync");
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), e.toString()); }
+}
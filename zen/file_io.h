@@ -176,6 +176,9 @@ Zstring getPathWithTempName(const Zstring& filePath) //generate (hopefully) uniq
 
 //overwrites if existing + transactional! :)
 void setFileContent(const Zstring& filePath, const std::string_view bytes, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
+
+//creates file if not existing + data is flushed to disk before returning (e.g. for write-ahead journals)
+void appendFileContent(const Zstring& filePath, const std::string_view bytes); //throw FileError
 }
 
 #endif //FILE_IO_H_89578342758342572345
@@ -51,7 +51,8 @@ Zstring zen::escapeCommandArg(const Zstring& arg)
 namespace
 {
 std::pair<int /*exit code*/, std::string> processExecuteImpl(const Zstring& filePath, const std::vector<Zstring>& arguments,
-                                                             std::optional<int> timeoutMs) //throw SysError, SysErrorTimeOut
+                                                             std::optional<int> timeoutMs,
+                                                             const std::vector<std::pair<Zstring, Zstring>>& envVars) //throw SysError, SysErrorTimeOut
 {
     const Zstring tempFilePath = appendPath(getTempFolderPath(), //throw FileError
                                             Zstr("FFS-") + utfTo<Zstring>(formatAsHexString(generateGUID())));
@@ -95,6 +96,22 @@ std::pair<int /*exit code*/, std::string> processExecuteImpl(const Zstring& file
     ZEN_ON_SCOPE_EXIT(::close(fdLifeSignR));
     auto guardFdLifeSignW = makeGuard<ScopeGuardRunMode::onExit>([&] { ::close(fdLifeSignW ); });
 
+    //--------------------------------------------------------------
+    //child environment: build *before* fork() => no allocations in the child process
+    std::vector<Zstring> envBuf;
+    std::vector<const char*> envp;
+    if (!envVars.empty())
+    {
+        for (char** it = environ; *it; ++it)
+            if (std::none_of(envVars.begin(), envVars.end(), [&](const auto& item) { return startsWith(*it, item.first + Zstr('=')); }))
+                envp.push_back(*it);
+
+        for (const auto& [name, value] : envVars)
+            envBuf.push_back(name + Zstr('=') + value);
+        for (const Zstring& nameVal : envBuf)
+            envp.push_back(nameVal.c_str());
+        envp.push_back(nullptr);
+    }
     //--------------------------------------------------------------
 
     //follow implemenation of ::system(): https://github.com/lattera/glibc/blob/master/sysdeps/posix/system.c
@@ -122,7 +139,7 @@ std::pair<int /*exit code*/, std::string> processExecuteImpl(const Zstring& file
             if (::dup2(fdDevNull, STDIN_FILENO) != STDIN_FILENO) //O_CLOEXEC does NOT propagate with dup2()
                 THROW_LAST_SYS_ERROR("dup2(STDIN)");
 
-            //*leak* the fd and have it closed automatically on child process exit after execv()
+            //*leak* the fd and have it closed automatically on child process exit after execve()
             if (::dup(fdLifeSignW) == -1) //O_CLOEXEC does NOT propagate with dup()
                 THROW_LAST_SYS_ERROR("dup(fdLifeSignW)");
 
@@ -131,12 +148,13 @@ std::pair<int /*exit code*/, std::string> processExecuteImpl(const Zstring& file
                 argv.push_back(arg.c_str());
             argv.push_back(nullptr);
 
-            /*int rv =*/::execv(argv[0], const_cast<char**>(argv.data())); //only returns if an error occurred
+            /*int rv =*/::execve(argv[0], const_cast<char**>(argv.data()), //only returns if an error occurred
+                                 envp.empty() ? environ : const_cast<char**>(envp.data()));
             //safe to cast away const: https://pubs.opengroup.org/onlinepubs/9699919799/functions/exec.html
             //  "The statement about argv[] and envp[] being constants is included to make explicit to future
             //   writers of language bindings that these objects are completely constant. Due to a limitation of
             //   the ISO C standard, it is not possible to state that idea in standard C."
-            THROW_LAST_SYS_ERROR("execv");
+            THROW_LAST_SYS_ERROR("execve");
         }
         catch (const SysError& e)
         {
@@ -239,9 +257,10 @@ std::pair<int /*exit code*/, std::string> processExecuteImpl(const Zstring& file
 }
 
 
-std::pair<int /*exit code*/, Zstring> zen::consoleExecute(const Zstring& cmdLine, std::optional<int> timeoutMs) //throw SysError, SysErrorTimeOut
+std::pair<int /*exit code*/, Zstring> zen::consoleExecute(const Zstring& cmdLine, std::optional<int> timeoutMs,
+                                                            const std::vector<std::pair<Zstring, Zstring>>& envVars) //throw SysError, SysErrorTimeOut
 {
-    const auto& [exitCode, output] = processExecuteImpl("/bin/sh", {"-c", cmdLine.c_str()}, timeoutMs); //throw SysError, SysErrorTimeOut
+    const auto& [exitCode, output] = processExecuteImpl("/bin/sh", {"-c", cmdLine.c_str()}, timeoutMs, envVars); //throw SysError, SysErrorTimeOut
     return {exitCode, copyStringTo<Zstring>(output)};
 }
 
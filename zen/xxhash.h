@@ -0,0 +1,140 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef XXHASH_H_3847502983475029834
+#define XXHASH_H_3847502983475029834
+
+#include <bit>
+#include <cstring>
+#include <algorithm>
+#include "type_traits.h"
+
+
+namespace zen
+{
+/* XXH64: fast non-cryptographic hash, streaming variant: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+   => several GB/s per core: cheap enough to hash data inline while copying it
+
+   XXHash64 hash;
+   hash.add(buffer, bytesRead);
+   ...
+   const uint64_t digest = hash.get(); */
+class XXHash64
+{
+public:
+    void add(const void* buffer, size_t bytes);
+    uint64_t get() const;
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4F;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5;
+
+    static uint64_t round(uint64_t acc, uint64_t input) { return std::rotl(acc + input * PRIME2, 31) * PRIME1; }
+    static uint64_t mergeRound(uint64_t acc, uint64_t val) { return (acc ^ round(0, val)) * PRIME1 + PRIME4; }
+
+    static uint64_t read64(const std::byte* ptr) { uint64_t val = 0; std::memcpy(&val, ptr, sizeof(val)); return val; }
+    static uint32_t read32(const std::byte* ptr) { uint32_t val = 0; std::memcpy(&val, ptr, sizeof(val)); return val; }
+
+    void consumeStripe(const std::byte* ptr)
+    {
+        acc_[0] = round(acc_[0], read64(ptr));
+        acc_[1] = round(acc_[1], read64(ptr + 8));
+        acc_[2] = round(acc_[2], read64(ptr + 16));
+        acc_[3] = round(acc_[3], read64(ptr + 24));
+    }
+
+    static constexpr size_t STRIPE_SIZE = 32;
+    static_assert(std::endian::native == std::endian::little); //read64()/read32() must return little-endian values
+
+    uint64_t acc_[4] = {PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1}; //seed = 0
+    std::byte buf_[STRIPE_SIZE] = {}; //incomplete stripe
+    size_t bufSize_ = 0;
+    uint64_t totalBytes_ = 0;
+};
+
+
+
+
+
+
+
+
+//------------------------- implementation -------------------------------
+inline
+void XXHash64::add(const void* buffer, size_t bytes)
+{
+    const std::byte* it  = static_cast<const std::byte*>(buffer);
+    const std::byte* end = it + bytes;
+    totalBytes_ += bytes;
+
+    if (bufSize_ > 0)
+    {
+        const size_t bytesToCopy = std::min(STRIPE_SIZE - bufSize_, bytes);
+        std::memcpy(buf_ + bufSize_, it, bytesToCopy);
+        bufSize_ += bytesToCopy;
+        it       += bytesToCopy;
+
+        if (bufSize_ < STRIPE_SIZE)
+            return;
+
+        consumeStripe(buf_);
+        bufSize_ = 0;
+    }
+
+    for (; static_cast<size_t>(end - it) >= STRIPE_SIZE; it += STRIPE_SIZE)
+        consumeStripe(it);
+
+    bufSize_ = end - it;
+    std::memcpy(buf_, it, bufSize_);
+}
+
+
+inline
+uint64_t XXHash64::get() const
+{
+    uint64_t h = 0;
+    if (totalBytes_ >= STRIPE_SIZE)
+    {
+        h = std::rotl(acc_[0], 1) + std::rotl(acc_[1], 7) + std::rotl(acc_[2], 12) + std::rotl(acc_[3], 18);
+        h = mergeRound(h, acc_[0]);
+        h = mergeRound(h, acc_[1]);
+        h = mergeRound(h, acc_[2]);
+        h = mergeRound(h, acc_[3]);
+    }
+    else
+        h = PRIME5; //seed = 0
+
+    h += totalBytes_;
+
+    const std::byte* it  = buf_;
+    const std::byte* end = buf_ + bufSize_;
+
+    for (; end - it >= 8; it += 8)
+        h = std::rotl(h ^ round(0, read64(it)), 27) * PRIME1 + PRIME4;
+
+    if (end - it >= 4)
+    {
+        h = std::rotl(h ^ (read32(it) * PRIME1), 23) * PRIME2 + PRIME3;
+        it += 4;
+    }
+
+    for (; it != end; ++it)
+        h = std::rotl(h ^ (static_cast<uint8_t>(*it) * PRIME5), 11) * PRIME1;
+
+    //avalanche:
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+}
+
+#endif //XXHASH_H_3847502983475029834
@@ -253,6 +253,64 @@ std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs)
 }
 
 
+std::string getNaturalSortKey(const Zstring& str)
+{
+    try
+    {
+        /* encode the blocks as seen by compareNatural():
+            whitespace: '\1'                   => all whitespace sequences are equivalent
+            number:     '\2' + digit count (4 bytes, big endian) + digits without leading zeros
+            text:       '\3' + upper-case code points as UTF-8 + '\0' => UTF-8 byte order == code point order; shorter text first
+           => "nothing" before "something": shorter key is a prefix    */
+        const Zstring& strNorm = getUnicodeNormalForm(str, UnicodeNormalForm::nfd);
+
+        std::string output;
+        output.reserve(strNorm.size() + 8);
+
+        const char*       it    = strNorm.c_str();
+        const char* const itEnd = it + strNorm.size();
+
+        while (it != itEnd)
+            if (isWhiteSpace(*it))
+            {
+                output += '\1';
+                while (it != itEnd && isWhiteSpace(*it)) ++it;
+            }
+            else if (isDigit(*it))
+            {
+                while (it != itEnd && *it == '0') ++it;
+
+                const char* const digitsBegin = it;
+                while (it != itEnd && isDigit(*it)) ++it;
+
+                const uint32_t digitCount = static_cast<uint32_t>(it - digitsBegin);
+                output += '\2';
+                for (int shift = 24; shift >= 0; shift -= 8)
+                    output += static_cast<char>(digitCount >> shift);
+                output.append(digitsBegin, it);
+            }
+            else
+            {
+                const char* const textBegin = it++;
+                while (it != itEnd && !isWhiteSpace(*it) && !isDigit(*it)) ++it;
+
+                output += '\3';
+                UtfDecoder<char> decoder(textBegin, it - textBegin);
+                while (const std::optional<impl::CodePoint> cp = decoder.getNext())
+                    codePointToUtf<char>(::g_unichar_toupper(*cp), [&](const char c) { output += c; }); //same as compareNoCaseUtf8()
+                output += '\0';
+            }
+
+        return output;
+    }
+    catch (const SysError& e)
+    {
+        throw std::runtime_error(std::string(__FILE__) + '[' + numberTo<std::string>(__LINE__) + "] Error creating sort key:" + '\n' +
+                                 utfTo<std::string>(str) + "\n\n" + utfTo<std::string>(e.toString()));
+    }
+}
+
+
 std::weak_ordering compareNoCase(const Zstring& lhs, const Zstring& rhs)
 {
     const bool isAsciiL = isAsciiString(lhs);
@@ -76,6 +76,10 @@ std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs);
 
 struct LessNaturalSort { bool operator()(const Zstring& lhs, const Zstring& rhs) const { return compareNatural(lhs, rhs) < 0; } };
 
+/* binary collation key: sign of compareNatural(lhs, rhs) == sign of getNaturalSortKey(lhs).compare(getNaturalSortKey(rhs))
+   => sort large lists: normalize Unicode once per string instead of once per comparison */
+std::string getNaturalSortKey(const Zstring& str);
+
 
 //------------------------------------------------------------------------------------------
 //common Unicode characters